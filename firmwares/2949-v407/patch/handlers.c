@@ -10,31 +10,42 @@
  *   return non-0 = intercepted (original handler skipped)
  */
 
+#include <stddef.h>
 #include <stdint.h>
-#include "fw_v407.h"
+#include "patch_target.h"   /* fw_v40x.h + feature switches, per build dir */
+#include "patch_core.h"
 #include "hid_desc.h"
 
-/* ── Linker-provided BSS boundaries (from patch.ld) ──────────────────── */
-
-extern uint8_t __patch_bss_start[];
-extern uint8_t __patch_bss_end[];
-
-static void zero_patch_bss(void) {
-    for (uint8_t *p = __patch_bss_start; p < __patch_bss_end; p++)
-        *p = 0;
+/* ── SRAM-resident code (.ramfunc in patch.ld) ───────────────────────────
+ * Functions marked RAMFUNC link into PATCH_SRAM, with their load image in
+ * the PATCH flash zone, so their inner loops fetch without flash wait
+ * states.  load_ramfuncs() copies the image at boot (config_load_all runs
+ * in every connection mode, unlike handle_usb_connect) and again on USB
+ * connect; both copies are idempotent.  long_call because SRAM is out of
+ * BL range of flash: callers branch through a register, and calls out of
+ * a RAMFUNC go through linker veneers.  Reserve it for the per-frame and
+ * per-scan loops — every byte comes out of the PATCH_SRAM budget. */
+#ifndef PATCH_HOST
+#define RAMFUNC        __attribute__((section(".ramfunc"), long_call, noinline))
+#define RAMFUNC_RODATA __attribute__((section(".ramfunc.rodata")))   /* tables they read */
+#endif
+
+extern uint32_t __ramfunc_start[];
+extern uint32_t __ramfunc_end[];
+extern const uint32_t __ramfunc_load[];
+
+void load_ramfuncs(void) {
+    const uint32_t *src = __ramfunc_load;
+    for (uint32_t *p = __ramfunc_start; p < __ramfunc_end; p++)
+        *p = *src++;
+    SYNC_DSB_ISB();
 }
 
 /* ── SRAM addresses (via linker symbols where available) ──────────────── */
 
 #define ADC_BATTERY_AVG   (*(volatile uint32_t *)&g_battery_avg_buf)   /* averaged battery ADC reading */
 #define ADC_SCAN_COUNTER  (*(volatile uint32_t *)&g_adc_accumulator)   /* magnetism engine ADC scan counter */
-#define ADC_RAW_SAMPLE    (*(volatile uint32_t *)0x20003C88)           /* raw ADC sample 0 (battery channel, no symbol) */
-
-/* ── USB HID request constants ───────────────────────────────────────── */
-
-#define USB_BMREQ_CLASS_IN         0xA1   /* bmRequestType: class, device-to-host, interface */
-#define HID_GET_REPORT             0x01   /* bRequest: GET_REPORT */
-#define WVALUE_FEATURE_REPORT(id)  ((3 << 8) | (id))  /* wValue for Feature report by ID */
+#define ADC_RAW_SAMPLE    MMIO32(0x20003C88)                           /* raw ADC sample 0 (battery channel, no symbol) */
 
 /* ── Derived addresses from exported symbols ─────────────────────────── */
 
@@ -65,11 +76,17 @@ extern volatile uint8_t g_if1_hid_desc[];  /* standalone IF1 HID descriptor @ SR
 
 /* ── On-device animation engine ─────────────────────────────────────── */
 
-#define ANIM_MAX_KF   8
-#define ANIM_MAX_DEFS 8
+#define ANIM_MAX_KF   16
+#define ANIM_MAX_DEFS 32    /* ≤ 32: zombie cleanup tracks defs in a u32 mask */
+#define ANIM_POOL_KF  96    /* keyframes shared by all defs, live and staged */
 
 #define ANIM_FLAG_ONE_SHOT  0x01
 #define ANIM_FLAG_RAINBOW   0x04
+#define ANIM_FLAG_TRIGGER   0x08  /* plays one-shot per key on key-down (no ASSIGN) */
+#define ANIM_FLAG_SPATIAL   0x30  /* bits 4-5: phase from matrix position, not TRIGGER */
+#define ANIM_SPATIAL_LINEAR 0x10  /* reach = direction in 256ths of a turn (0 →, 64 ↓) */
+#define ANIM_SPATIAL_RADIAL 0x20  /* reach = origin matrix pos (row*16+col) */
+#define ANIM_SPATIAL_SWEEP  0x30  /* reach = 0 →, 1 ←, 2 ↓, 3 ↑ by whole columns/rows */
 
 /* Easing IDs (wire format) */
 #define EASE_HOLD           0
@@ -80,26 +97,40 @@ extern volatile uint8_t g_if1_hid_desc[];  /* standalone IF1 HID descriptor @ SR
 #define EASE_IN_EXPO        5
 #define EASE_OUT_EXPO       6
 
+/* Keyframes live in one pool, each def owning a contiguous run of it.
+ * Times are delta-encoded in units of the def's tick quantum, so a byte
+ * covers any segment of a def shorter than 256 quanta. */
 typedef struct {
-    uint16_t t_ticks;   /* absolute time in 5ms ticks (200Hz) */
-    uint8_t  r, g, b;   /* RGB888 (unpacked from RGB565 on receive) */
+    uint16_t c565;      /* RGB565 as received, unpacked at evaluation */
+    uint8_t  dt;        /* quanta since previous keyframe (kf 0: since t = 0) */
     uint8_t  easing;
-} anim_keyframe_t;      /* 6 bytes */
+} anim_keyframe_t;      /* 4 bytes */
 
 typedef struct {
-    anim_keyframe_t kf[ANIM_MAX_KF];   /* 48B */
     uint16_t duration_ticks;            /* total cycle length */
-    uint16_t elapsed_ticks;             /* current playback position */
-    uint8_t  num_kf;                    /* 0 = def unused */
+    uint8_t  kf_base;                   /* first keyframe in anim_kf_pool */
+    uint8_t  kf_count;                  /* pool slots held, 0 = none */
+    uint8_t  num_kf;                    /* 0 = def unused (or waiting on DEF_EXT) */
     uint8_t  flags;                     /* bit0: one-shot, bit2: rainbow */
     int8_t   priority;                  /* higher wins key conflicts */
-    uint8_t  _pad;
-} anim_def_t;                           /* 56 bytes */
+    uint8_t  t_shift;                   /* keyframe tick quantum = 1 << t_shift */
+    uint8_t  reach;                     /* TRIGGER: Chebyshev radius in cells; spatial: mode arg */
+    uint8_t  spread;                    /* ticks of delay/phase per cell of distance */
+} anim_def_t;                           /* 10 bytes */
+
+/* Playback state of a live def, seeded by anim_prepare_def() so that
+ * anim_evaluate() runs without a single UDIV.  Kept apart from the def so
+ * the staging copy only carries the 10-byte wire state; the segment
+ * cursor sits in anim_seg_cursor[] to keep this at 8 bytes. */
+typedef struct {
+    uint32_t dur_recip;                 /* floor((2^32-1)/duration) for modulo and hue */
+    uint16_t seg_t0;                    /* start tick of the cursor's keyframe */
+    uint16_t elapsed_ticks;             /* current playback position */
+} anim_def_rt_t;                        /* 8 bytes */
 
 typedef struct {
-    uint8_t anim_id;        /* 0xFF = no animation, 0-7 = def index */
-    uint8_t phase_offset;   /* stagger: value × 8 ticks (40ms granularity) */
-} key_anim_t;               /* 2 bytes */
+    uint8_t anim_id;        /* 0xFF = no animation, else def index */
+} key_anim_t;               /* 1 byte; timing lives in key_t0[] */
 
 typedef struct {
     uint32_t frame_count;     /* total blend calls (monotonic, for sync) */
@@ -107,18 +138,94 @@ typedef struct {
     uint8_t  _pad[3];
 } anim_engine_t;              /* 8 bytes */
 
-static anim_def_t   anim_defs[ANIM_MAX_DEFS];   /* 56×8 = 448B */
-static key_anim_t   key_table[LED_COUNT];        /* 82×2 = 164B */
+static anim_keyframe_t anim_kf_pool[ANIM_POOL_KF]; /* 4×96 = 384B */
+static uint8_t       anim_pool_top;              /* bump pointer into anim_kf_pool */
+static anim_def_t    anim_defs[ANIM_MAX_DEFS];   /* 10×32 = 320B */
+static anim_def_rt_t anim_rt[ANIM_MAX_DEFS];     /* 8×32 = 256B */
+static uint8_t       anim_seg_cursor[ANIM_MAX_DEFS]; /* last segment found; walked ± from here */
+static key_anim_t    key_table[LED_COUNT];       /* 82B */
 static anim_engine_t anim_engine;                /* 8B */
-/* Total new BSS: 620B */
+
+/* Per-key timing, read as the key's def requires: phase_offset × 8 ticks
+ * for looping and one-shot defs; for TRIGGER defs the low 16 bits of the
+ * frame_count the key starts on (press frame plus ripple delay), set by
+ * the key-press hook, from which anim_tick plays the def on that key. */
+static uint16_t      key_t0[LED_COUNT];          /* 82×2 = 164B */
+
+/* Assignment a TRIGGER one-shot displaced, handed back when it ends.  Only
+ * meaningful while the key plays a TRIGGER def: every start goes through
+ * anim_trigger_start(), which saves the key's def and phase_offset unless
+ * it is already playing a trigger (a re-press keeps the original).  The
+ * phase rebuilds key_t0 exactly, so it is all that needs keeping. */
+typedef struct {
+    uint8_t id;             /* 0xFF = none */
+    uint8_t phase;
+} key_bg_t;
+static key_bg_t      key_bg[LED_COUNT];          /* 82×2 = 164B */
+
+/* Staged scene for atomic uploads (0xEA STAGE/COMMIT).  While a stage is
+ * open, DEF/DEF_EXT/ASSIGN/CANCEL/CLEAR edit this copy instead of the live
+ * tables, so anim_tick() never sees a half-built def and zombie cleanup
+ * can't reap a def whose keys haven't arrived yet.  COMMIT arms a swap
+ * that anim_tick() performs on a host-chosen frame_count.  Staged defs
+ * take their keyframes from the same pool; a def seeded from the live
+ * scene shares the live run until it is redefined. */
+#define ANIM_STAGE_IDLE   0
+#define ANIM_STAGE_OPEN   1   /* edits go to anim_stage */
+#define ANIM_STAGE_ARMED  2   /* closed; swap in at commit_frame */
+
+static struct {
+    anim_def_t defs[ANIM_MAX_DEFS];
+    key_anim_t keys[LED_COUNT];
+    uint8_t    phase[LED_COUNT];  /* ASSIGN phase_offset, applied to key_t0 on swap */
+    uint32_t   commit_frame;
+    uint8_t    state;
+    uint8_t    _pad[3];
+} anim_stage;                                    /* 492B */
+/* Total new BSS: 1903B */
 
 /* Per-LED RGB overlay: additive, saturating. 0 = no overlay for that channel.
  * Shared by both anim_tick() and led_overlay_memcpy_and_blend(). */
 static uint8_t overlay_buf[LED_COUNT * 3];  /* 82×3 = 246 bytes */
-static uint8_t overlay_active;              /* non-zero if any overlay pixel set */
 
-/* Forward declaration for power state reporting (defined after ep2_send_if_ready) */
+/* Occupancy mask: bit i set ⇔ overlay_buf[i*3..i*3+2] is non-zero.  The blend
+ * walks set bits with CTZ, so its cost scales with lit keys, not LED_COUNT.
+ * Only touch overlay_buf through overlay_set()/overlay_clear_all(). */
+#define OVERLAY_MASK_WORDS  ((LED_COUNT + 31) / 32)   /* 3 words = 96 bits */
+static uint32_t overlay_mask[OVERLAY_MASK_WORDS];
+
+static inline void overlay_set(uint8_t strip_idx, uint8_t r, uint8_t g, uint8_t b) {
+    overlay_buf[strip_idx * 3 + 0] = r;
+    overlay_buf[strip_idx * 3 + 1] = g;
+    overlay_buf[strip_idx * 3 + 2] = b;
+    uint32_t bit = 1u << (strip_idx & 31);
+    if (r | g | b)
+        overlay_mask[strip_idx >> 5] |= bit;
+    else
+        overlay_mask[strip_idx >> 5] &= ~bit;
+}
+
+static void overlay_clear_all(void) {
+    for (int i = 0; i < LED_COUNT * 3; i++)
+        overlay_buf[i] = 0;
+    for (int w = 0; w < OVERLAY_MASK_WORDS; w++)
+        overlay_mask[w] = 0;
+}
+
+/* Non-zero if any overlay pixel is set */
+static inline uint8_t overlay_active(void) {
+    uint32_t any = 0;
+    for (int w = 0; w < OVERLAY_MASK_WORDS; w++)
+        any |= overlay_mask[w];
+    return any != 0;
+}
+
+/* Forward declarations for the EP2 mailbox (defined after ep2_send_if_ready) */
+static void mbox_reset(void);
 static void send_power_state(uint8_t state);
+static void telem_poll(void);
+static int telem_holds_slot(void);
+static void telem_settle(void);
 
 /* ── Power state reporting via EP2 ────────────────────────────────────── */
 
@@ -129,73 +236,84 @@ static void send_power_state(uint8_t state);
 #define PWR_STATE_WAKE  0x00   /* [00,00,...] = wake (backward-compatible all-zeros) */
 #define PWR_STATE_IDLE  0x01   /* [00,01,...] = entering idle sleep */
 #define PWR_STATE_DEEP  0x02   /* [00,02,...] = entering deep sleep */
-#define PWR_STATE_NONE  0xFF   /* no pending event */
 
-/* Queued power state event.  Set by the blend hook (runs every scan cycle),
- * sent by ep2_send_if_ready on USB, or drained by handle_vendor_cmd for
- * wireless (where EP2 doesn't exist and events travel via RF response). */
-static uint8_t pending_power_event;   /* PWR_STATE_NONE when empty */
+/* Power events queue in the EP2 mailbox below and drain from the blend hook
+ * (every scan cycle) and handle_vendor_cmd, so none is lost to a busy EP2. */
 
 /* Set to 1 by wireless_sleep_before_hook / usb_suspend_before_hook when
  * the firmware is about to enter a blocking sleep loop.  Cleared by the
  * blend hook on the first scan cycle after wake. */
 static uint8_t sleeping_flag;
 
+/* Last power transition passed to send_power_state (PWR_STATE_*), also
+ * reported through push telemetry (0xEE). */
+static uint8_t power_state;
+
 
 /* ── Battery HID report descriptor (appended to IF1) ─────────────────── */
 
-/* 46 bytes: Battery Strength + Charging status, Feature + Input reports.
- *
- * Feature reports (polled via GET_REPORT):
- *   - Usage Page 0x06 / Usage 0x20 (HID_DC_BATTERYSTRENGTH): triggers
- *     power_supply creation via kernel's report_features().
- *   - Usage Page 0x85 / Usage 0x44 (HID_BAT_CHARGING): charge status.
+/* Report ID 7, Feature (polled via GET_REPORT) + Input (pushed on EP 0x82
+ * when charge state changes); see HID_BATTERY_RDESC. */
+static const uint8_t battery_rdesc[] = {
+    HID_BATTERY_RDESC(7),
+};
+
+#define BATTERY_RDESC_LEN  (sizeof(battery_rdesc))     /* 46 */
+
+/* ── Gamepad HID report descriptor (appended after battery) ──────────────
+ * Six 12-bit axes (X, Y, Z, Rx, Ry, Rz) filled straight from
+ * adc_filtered_value for host-assigned keys (0xED), so analog input reaches
+ * games through the kernel's HID joystick path without a host daemon.
+ * Input report: [0x09] [6 × u16 LE].  Always declared; reports only flow
+ * once the host assigns at least one axis, and on USB only.
  *
- * Input reports (pushed on EP 0x82 when charge state changes):
- *   Duplicate usages allow the kernel's hidinput_hid_event() →
- *   hidinput_update_battery() → hidinput_update_battery_charge_status()
- *   chain to fire, which correctly sets POWER_SUPPLY_STATUS_CHARGING
- *   or DISCHARGING.  The Feature-only path (hid_hw_raw_request) bypasses
- *   event processing, so charge status never updates without Input reports.
+ * The same collection declares the patch event report: 63 constant bytes
+ * that hid-input never maps.  The stock vendor report (ID 5) holds only 31,
+ * and hosts size the EP2 interrupt transfer to the largest declared input
+ * report, so packed depth frames and tagged completions need their own ID.
  *
- * Both share Report ID 7; HID spec allows same ID across report types.
- * Input report data: [0x07, battery_level, charging] — same as Feature. */
-static const uint8_t battery_rdesc[] = {
+ * The stock length cap at 0x080147fc is an 8-bit immediate, so the whole
+ * extended descriptor must stay ≤ 255 bytes (currently 249). */
+#define GAMEPAD_REPORT_ID  9
+#define GAMEPAD_AXES       6
+#define GAMEPAD_AXIS_MAX   4095     /* 12-bit ADC */
+#define PATCH_EVENT_REPORT_ID  10
+#define PATCH_EVENT_LEN        63   /* payload after the ID: 64-byte transfers */
+
+static const uint8_t gamepad_rdesc[] = {
     HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
-    HID_USAGE(HID_USAGE_DESKTOP_KEYBOARD),
+    HID_USAGE(HID_USAGE_DESKTOP_GAMEPAD),
     HID_COLLECTION(HID_COLLECTION_APPLICATION),
-      HID_REPORT_ID(7)
-      /* ── Battery capacity (0-100%) ── */
-      HID_USAGE_PAGE(HID_USAGE_PAGE_GENERIC_DEVICE),
-      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),
+      HID_REPORT_ID(GAMEPAD_REPORT_ID)
+      HID_USAGE_MIN(HID_USAGE_DESKTOP_X),
+      HID_USAGE_MAX(HID_USAGE_DESKTOP_RZ),
       HID_LOGICAL_MIN(0),
-      HID_LOGICAL_MAX_N(100, 2),
-      HID_REPORT_SIZE(8),
-      HID_REPORT_COUNT(1),
-      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),
+      HID_LOGICAL_MAX_N(GAMEPAD_AXIS_MAX, 2),
+      HID_REPORT_SIZE(16),
+      HID_REPORT_COUNT(GAMEPAD_AXES),
       HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      /* ── Charging status (0/1) ── */
-      HID_USAGE_PAGE(HID_USAGE_PAGE_BATTERY_SYSTEM),
-      HID_USAGE(HID_USAGE_BATTERY_CHARGING),
-      HID_LOGICAL_MIN(0),
-      HID_LOGICAL_MAX(1),
+      HID_REPORT_ID(PATCH_EVENT_REPORT_ID)
       HID_REPORT_SIZE(8),
-      HID_REPORT_COUNT(1),
-      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      HID_USAGE(HID_USAGE_BATTERY_CHARGING),
-      HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+      HID_REPORT_COUNT(PATCH_EVENT_LEN),
+      HID_INPUT(HID_CONSTANT),
     HID_COLLECTION_END,
 };
 
-#define BATTERY_RDESC_LEN  (sizeof(battery_rdesc))     /* 46 */
-#define EXTENDED_RDESC_LEN (IF1_RDESC_LEN + BATTERY_RDESC_LEN)  /* 217 */
+#define GAMEPAD_RDESC_LEN  (sizeof(gamepad_rdesc))     /* 32 */
+#define EXTENDED_RDESC_LEN (IF1_RDESC_LEN + BATTERY_RDESC_LEN + GAMEPAD_RDESC_LEN)  /* 249 */
+_Static_assert(EXTENDED_RDESC_LEN <= 255, "IF1 rdesc length cap is an 8-bit immediate");
 
-/* Buffer for extended IF1 descriptor (original 171B + battery 46B).
+/* Buffer for extended IF1 descriptor (original 171B + battery 46B + gamepad 32B).
  * Non-static: address must be visible in ELF for build-time literal pool patch.
  * Placed in .bss → PATCH_SRAM (0x20009800+). */
 uint8_t extended_rdesc[EXTENDED_RDESC_LEN];
 
+static void extended_rdesc_fill(void) {
+    memcpy(extended_rdesc, (void *)&g_if1_report_desc, IF1_RDESC_LEN);
+    uint32_t n = rdesc_append(extended_rdesc, IF1_RDESC_LEN, battery_rdesc, BATTERY_RDESC_LEN);
+    rdesc_append(extended_rdesc, n, gamepad_rdesc, GAMEPAD_RDESC_LEN);
+}
+
 /* ── Safe EP2 send (follows stock busy-flag contract) ────────────────── */
 /* Check ep2_tx_ready → clear → flush+xfer.  Returns 1 if sent, 0 if busy.
  * Stock usb_ep_report_send uses the same protocol; if we grab the flag
@@ -211,12 +329,102 @@ static inline int ep2_send_if_ready(void *buf, uint32_t len) {
     return 1;
 }
 
+/* ── EP2 notification mailbox ────────────────────────────────────────────
+ * ep2_send_if_ready gives up when the endpoint is busy, so notifications
+ * are posted here and sent by mbox_drain, one per call, whenever EP2 is
+ * free.  Power transitions queue in order (power first — the host acts on
+ * them); battery state coalesces, the newest replacing anything unsent.
+ * A full power queue folds the newest event into the last slot, so the
+ * host always ends on the current state. */
+#define MBOX_PWR_DEPTH  4
+
+static struct {
+    uint8_t tx[4];                     /* wire buffer; only written while EP2 is idle */
+    uint8_t pwr[MBOX_PWR_DEPTH];       /* pending power sub-codes, oldest first */
+    uint8_t npwr;
+    uint8_t bat_pending;
+    uint8_t bat_level;                 /* last state posted */
+    uint8_t bat_charging;
+} ep2_mbox __attribute__((aligned(4)));   /* 12 bytes */
+
+/* Tagged command completions (0xEF sub 0xFF, see handle_tagged) queue as
+ * whole frames behind power events.  A slot is only reused once the ring
+ * has moved past it, so the frame in flight is never overwritten: at most
+ * MBOX_TAG_SLOTS - 1 wait, and a completion that finds the ring full is
+ * dropped and counted (the host falls back to GET_REPORT). */
+#define MBOX_TAG_SLOTS  4
+#define MBOX_TAG_FRAME  (1 + PATCH_EVENT_LEN)
+
+static struct {
+    uint8_t  frame[MBOX_TAG_SLOTS][MBOX_TAG_FRAME];
+    uint8_t  len[MBOX_TAG_SLOTS];
+    uint8_t  head;
+    uint8_t  count;
+    uint16_t drops;
+} tag_mbox __attribute__((aligned(4)));   /* 264 bytes */
+
+static void mbox_reset(void) {
+    ep2_mbox.npwr = 0;
+    ep2_mbox.bat_pending = 0;
+    tag_mbox.count = 0;
+}
+
+/* Send the highest-priority pending notification if EP2 is free.
+ * usb_ep2_in_transmit keeps the pointer, and tx is shared by the power
+ * and battery frames, so nothing is written until the endpoint is idle. */
+static void mbox_drain(void) {
+    uint8_t *t = ep2_mbox.tx;
+    if (!((volatile hid_report_state_t *)&g_hid_report_pending_flags)->ep2_tx_ready)
+        return;
+    if (ep2_mbox.npwr) {
+        t[0] = 0x00;                   /* notification type: WAKE namespace */
+        t[1] = ep2_mbox.pwr[0];        /* sub-code: wake/idle/deep */
+        t[2] = 0; t[3] = 0;
+        if (!ep2_send_if_ready(t, 4))
+            return;
+        ep2_mbox.npwr--;
+        for (uint8_t i = 0; i < ep2_mbox.npwr; i++)
+            ep2_mbox.pwr[i] = ep2_mbox.pwr[i + 1];
+    } else if (tag_mbox.count) {
+        uint8_t h = tag_mbox.head;
+        if (!ep2_send_if_ready(tag_mbox.frame[h], tag_mbox.len[h]))
+            return;
+        tag_mbox.head = (h + 1) % MBOX_TAG_SLOTS;
+        tag_mbox.count--;
+    } else if (ep2_mbox.bat_pending) {
+        t[0] = 0x07;                   /* battery Input report (ID 7) */
+        t[1] = ep2_mbox.bat_level;
+        t[2] = ep2_mbox.bat_charging;
+        if (ep2_send_if_ready(t, 3))
+            ep2_mbox.bat_pending = 0;
+    }
+}
+
+/* Queue a power transition and try to send it right away. */
 static void send_power_state(uint8_t state) {
-    static uint8_t pkt[4] __attribute__((aligned(4)));
-    pkt[0] = 0x00;    /* notification type: WAKE namespace */
-    pkt[1] = state;   /* sub-code: wake/idle/deep */
-    pkt[2] = 0; pkt[3] = 0;
-    ep2_send_if_ready(pkt, 4);
+    power_state = state;
+    uint8_t n = ep2_mbox.npwr;
+    if (n && ep2_mbox.pwr[n - 1] == state) {
+        /* already the newest queued state */
+    } else if (n == MBOX_PWR_DEPTH) {
+        ep2_mbox.pwr[n - 1] = state;
+    } else {
+        ep2_mbox.pwr[n] = state;
+        ep2_mbox.npwr = n + 1;
+    }
+    mbox_drain();
+    telem_poll();
+}
+
+/* Post the battery state if it changed since the last post. */
+static void mbox_post_battery(void) {
+    volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
+    uint8_t level = kbd->battery_level, charging = kbd->charger_connected;
+    if (level != ep2_mbox.bat_level || charging != ep2_mbox.bat_charging) {
+        ep2_mbox.bat_level = level;
+        ep2_mbox.bat_charging = charging;
+        ep2_mbox.bat_pending = 1;
+    }
 }
 
 /* ── Diagnostics (readable via 0xE7 patch info) ──────────────────────── */
@@ -232,15 +440,45 @@ static struct {
     uint8_t  last_result;           /* 0=passthrough, 1=intercepted */
 } diag;
 
-/* ── Debug ring buffer (readable via 0xE9) ───────────────────────────── */
-
-#define LOG_BUF_SIZE 512
+/* ── Compact full-frame streaming (0xE8 pages 0xFB / 0xFC) ─────────────
+ * Strip-indexed spans instead of 18-key row-major pages, so a full 82-LED
+ * frame fits in three packets:
+ *   0xFB RGB565: buf[4]=seq, buf[5]=start strip, buf[6..61]=28 × u16 LE
+ *   0xFC delta:  buf[4]=seq, buf[5]=start strip, buf[6]=shift (0-3),
+ *                buf[7..62]=37 × 3 signed nibbles (R,G,B; low nibble first),
+ *                each added to the current overlay as (d << shift), clamped
+ * All pages of one frame share a sequence byte.  Pages older than the
+ * newest seen are dropped.  Each LED remembers the seq it was last written
+ * at; a delta applies only on top of seq-1, so a lost or reordered base
+ * page can't corrupt the frame — the LED is skipped and counted, and the
+ * host resyncs with an RGB565 page. */
+#define LED_STREAM_565_PER_PKT    28
+#define LED_STREAM_DELTA_PER_PKT  37
+
+/* Dirty-LED frames (0xE8 page 0xF8), for 2.4 GHz: the dongle patch merges
+ * the host's pages and forwards the LEDs changed since its last packet.
+ *   buf[4] = n (bit 7 = built by the dongle, ignored here; 0 = probe),
+ *   buf[5..64] = n × [gap][RGB565 LE] (max 20), strip = previous + gap,
+ *                the first gap being the strip itself
+ * Colours are absolute and there is no sequence: a dropped packet leaves
+ * stale LEDs, never a corrupt frame.  The keyboard still answers each
+ * forwarded command over RF, so the command and page bytes are cleared
+ * and the reply reads as empty; a probe keeps the echo and answers
+ * buf[4] = entries per packet. */
+#define LED_STREAM_RF_PAGE        0xF8
+#define LED_STREAM_RF_PER_PKT     20
 
 static struct {
-    uint16_t head;          /* next write position (wraps at LOG_BUF_SIZE) */
-    uint16_t count;         /* total bytes written (saturates at LOG_BUF_SIZE) */
-    uint8_t  data[LOG_BUF_SIZE];
-} log_buf;                  /* 516B in .bss → PATCH_SRAM */
+    uint8_t  seq;                   /* newest frame sequence accepted */
+    uint8_t  synced;                /* 0 until the first compact page */
+    uint16_t stale_drops;           /* pages older than seq */
+    uint16_t delta_misses;          /* delta LEDs whose base frame was missing */
+    uint8_t  led_seq[LED_COUNT];    /* seq each LED was last written at */
+} led_stream;                       /* 88 bytes */
+
+/* ── Debug ring buffer (readable via 0xE9, patch/patch_log.h) ────────── */
+
+#include "patch_log.h"
 
 /* Log entry types */
 #define LOG_HID_SETUP_ENTRY   0x01  /* 8B payload: setup packet */
@@ -248,33 +486,21 @@ static struct {
 #define LOG_VENDOR_CMD_ENTRY  0x03  /* 2B payload: cmd_buf[0], cmd_buf[2] */
 #define LOG_USB_CONNECT       0x04  /* 0B payload */
 #define LOG_EP0_XFER_START    0x05  /* 6B payload: buf_lo/hi, len, udev_lo/hi, 0 */
+#define LOG_SCENE             0x06  /* 2B payload: 0xEA sub (save/load), result */
 
 /* ── SEGGER RTT (ring buffer in SRAM, read by BMP via SWD) ─────────── */
 
-#define RTT_BUF_SIZE 256
-
-/* RTT Up-Buffer descriptor */
-typedef struct {
-    const char *name;
-    uint8_t    *buf;
-    uint32_t    size;
-    volatile uint32_t wr_off;   /* firmware advances */
-    volatile uint32_t rd_off;   /* BMP advances via SWD */
-    uint32_t    flags;          /* 0 = skip if full (non-blocking) */
-} rtt_up_buf_t;
-
-/* RTT Control Block — pinned at PATCH_SRAM origin (0x20009800) via .rtt section.
+/* Control block pinned at PATCH_SRAM origin (0x20009800) via .rtt section.
  * BMP finds it without scanning: monitor rtt ram 0x20009800 0x20009C00 */
-typedef struct {
-    char         id[16];        /* "SEGGER RTT\0\0\0\0\0\0" */
-    int32_t      max_up;        /* 1 */
-    int32_t      max_down;      /* 0 */
-    rtt_up_buf_t up[1];
-} rtt_cb_t;
+#define RTT_NUM_UP          2
+#define RTT_CH_TELEMETRY    0
+#define RTT_CH_STREAM       1
+#define RTT_UP0_NAME        "monsmod"          /* 5-byte tagged telemetry */
+#define RTT_UP0_SIZE        256
+#define RTT_UP1_NAME        "monsmod-stream"   /* 8-byte timestamped stream records */
+#define RTT_UP1_SIZE        256
 
-static rtt_cb_t  __attribute__((section(".rtt"),used)) rtt_cb;
-static uint8_t   __attribute__((section(".rtt"),used)) rtt_buf[RTT_BUF_SIZE];
-static const char rtt_channel_name[] = "monsmod";
+#include "patch_rtt.h"
 
 /* RTT tag definitions for battery monitor */
 #define RTT_TAG_ADC_AVG       0x01  /* u16: averaged battery ADC reading */
@@ -284,88 +510,544 @@ static const char rtt_channel_name[] = "monsmod";
 #define RTT_TAG_DEBOUNCE_CTR  0x05  /* u8:  battery_update_ctr */
 #define RTT_TAG_ADC_COUNTER   0x10  /* u32: magnetism engine ADC scan counter */
 
-static void rtt_init(void) {
-    /* Already initialized?  max_up is set to 1 as the last step below.
-     * After zero_patch_bss(), max_up == 0 so this runs once. */
-    if (rtt_cb.max_up == 1)
+static void rtt_emit(uint8_t tag, uint32_t val) {
+    /* 5-byte record: [tag:u8] [value:u32 LE] */
+    uint8_t rec[5] = { tag, (uint8_t)val, (uint8_t)(val >> 8),
+                       (uint8_t)(val >> 16), (uint8_t)(val >> 24) };
+    rtt_write(RTT_CH_TELEMETRY, rec, sizeof(rec));
+}
+
+/* ── Hook profiling (DWT cycle counter, readable via 0xEB) ───────────────
+ * Every patch entry point is wrapped in prof_begin()/prof_end(), which keep
+ * per-hook call count, min/max/total cycles and a log2 histogram.  Times
+ * are inclusive (the blend slot contains anim_tick).  Optionally emitted
+ * as RTT records every N LED frames; the records carry cumulative values,
+ * so the host diffs consecutive ones for per-period averages. */
+#define PROF_BLEND          0   /* led_overlay_memcpy_and_blend */
+#define PROF_ANIM_TICK      1
+#define PROF_VENDOR_CMD     2   /* handle_vendor_cmd */
+#define PROF_HID_SETUP      3   /* handle_hid_setup */
+#define PROF_DONGLE_REPORTS 4   /* dongle_reports_before_hook */
+#define PROF_BATTERY        5   /* battery_monitor_before_hook */
+#define PROF_NUM_HOOKS      6
+
+#define PROF_HIST_BINS      8   /* [0] <512 cycles, [k] <512<<k, [7] ≥ 32768 */
+#define PROF_HIST_SHIFT     9
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_cyc;
+    uint32_t max_cyc;
+    uint32_t total_lo;                  /* u64 total, split for LE packing */
+    uint32_t total_hi;
+    uint16_t hist[PROF_HIST_BINS];      /* saturating */
+} prof_slot_t;                          /* 36 bytes */
+
+static prof_slot_t prof_slots[PROF_NUM_HOOKS];  /* 216B */
+static uint16_t    prof_rtt_period;             /* LED frames between RTT dumps, 0 = off */
+static uint16_t    prof_rtt_ctr;
+
+#define RTT_TAG_PROF_BASE   0x40  /* 0x40 | hook<<2 | field (0 count, 1 total_lo, 2 max) */
+
+static inline uint32_t prof_begin(void) {
+    return dwt_now();
+}
+
+static void prof_account(prof_slot_t *p, uint32_t cyc, uint8_t shift) {
+    if (p->count == 0 || cyc < p->min_cyc) p->min_cyc = cyc;
+    if (cyc > p->max_cyc) p->max_cyc = cyc;
+    p->count++;
+    uint32_t lo = p->total_lo + cyc;
+    p->total_hi += (lo < cyc);
+    p->total_lo = lo;
+
+    uint32_t bin = (cyc >> shift) ? 32 - __builtin_clz(cyc >> shift) : 0;
+    if (bin >= PROF_HIST_BINS) bin = PROF_HIST_BINS - 1;
+    if (p->hist[bin] != 0xFFFF) p->hist[bin]++;
+}
+
+static void prof_end(uint8_t hook, uint32_t t0) {
+    prof_account(&prof_slots[hook], DWT_CYCCNT - t0, PROF_HIST_SHIFT);
+}
+
+/* ── Scan-to-report latency (readable via 0xEB 0x04) ─────────────────────
+ * key_event_process calls keymap_lookup for every debounced key edge, so
+ * key_press_hook stamps the oldest edge not yet reported.  The stamp is
+ * closed when a keyboard report leaves: usb_ep_report_send on USB (6KRO
+ * on EP1, NKRO on EP2, each needing its ready flag), build_dongle_reports
+ * in both wireless modes.  Only the first edge of a burst is timed; edges
+ * that produce no report (Fn, layer keys) go stale and are counted apart.
+ * This is press-to-endpoint: USB polling and RF/BT air time come on top. */
+#define LAT_USB           0     /* g_connection_mode 6 */
+#define LAT_24G           1     /* 5: 2.4 GHz dongle */
+#define LAT_BT            2     /* anything else */
+#define LAT_NUM_MODES     3
+#define LAT_HIST_SHIFT    15    /* [0] <152 µs, [k] <152 µs << k, [7] ≥ 9.7 ms */
+#define LAT_STALE_CYCLES  (1u << 24)   /* ~78 ms: edge that never got a report */
+#define LAT_KEY_BITS      0x60  /* pending_reports_bitmap: 6KRO | NKRO */
+
+static prof_slot_t lat_slots[LAT_NUM_MODES];   /* 108B */
+static uint32_t    lat_t0;                     /* CYCCNT of the oldest unreported edge */
+static uint8_t     lat_armed;
+static uint16_t    lat_stale;                  /* saturating */
+
+static void lat_mark(void) {
+    uint32_t now = prof_begin();
+    if (lat_armed && now - lat_t0 <= LAT_STALE_CYCLES)
         return;
+    if (lat_armed && lat_stale != 0xFFFF)
+        lat_stale++;
+    lat_t0 = now;
+    lat_armed = 1;
+}
 
-    /* .bss is zeroed by zero_patch_bss() — no manual zeroing needed. */
+static void lat_report_sent(void) {
+    if (!lat_armed)
+        return;
+    lat_armed = 0;
+    uint32_t cyc = DWT_CYCCNT - lat_t0;
+    if (cyc > LAT_STALE_CYCLES) {
+        if (lat_stale != 0xFFFF) lat_stale++;
+        return;
+    }
+    uint8_t mode = *(volatile uint8_t *)&g_connection_mode;
+    prof_account(&lat_slots[mode == 6 ? LAT_USB : mode == 5 ? LAT_24G : LAT_BT],
+                 cyc, LAT_HIST_SHIFT);
+}
 
-    /* Set up channel 0 (up only) */
-    rtt_cb.up[0].name  = rtt_channel_name;
-    rtt_cb.up[0].buf   = rtt_buf;
-    rtt_cb.up[0].size  = RTT_BUF_SIZE;
-    rtt_cb.up[0].wr_off = 0;
-    rtt_cb.up[0].rd_off = 0;
-    rtt_cb.up[0].flags  = 0;  /* SEGGER_RTT_MODE_NO_BLOCK_SKIP */
-    rtt_cb.max_down = 0;
+/* ── Frame-budget governor (configured via 0xEB 0x05) ────────────────────
+ * The blend hook runs once per main-loop pass, in the same loop as
+ * key_matrix_scan, adc_sensor_process and report sending, so a heavy
+ * scene stretches the loop that sets the polling rate.  The CYCCNT delta
+ * between consecutive blend calls is the loop period; while it runs over
+ * the budget, LED work is shed and input work never is:
+ *   level 1  anim_tick evaluates 1/div of the keys per frame, so each key
+ *            refreshes every div frames but the cost spreads evenly (time
+ *            still advances every frame: animations keep their speed);
+ *   level 2  as 1, and a frame that breaches the budget skips the
+ *            frame→DMA copy, so the LEDs hold the previous frame.
+ * Each breach raises the level by one; GOV_CALM_FRAMES frames in a row
+ * under 3/4 of the budget lower it by one.  Periods over GOV_GAP_CYCLES
+ * (sleep, USB suspend, a debugger halt) are not loop time and are ignored. */
+#define GOV_CALM_FRAMES   32
+#define GOV_GAP_CYCLES    (1u << 24)   /* ~78 ms */
+#define GOV_DIV_DEFAULT   4
+#define GOV_LEVEL_SLICE   1
+#define GOV_LEVEL_SKIP    2
 
-    /* Write magic + max_up LAST — prevents BMP finding half-initialized CB
-     * and serves as the initialization guard for rtt_emit(). */
-    __asm__ volatile ("dsb" ::: "memory");
-    const char magic[] = "SEGGER RTT\0\0\0\0\0";
-    for (int i = 0; i < 16; i++)
-        ((volatile char *)rtt_cb.id)[i] = magic[i];
-    rtt_cb.max_up = 1;
+static struct {
+    uint32_t budget;                /* cycles, 0 = off */
+    uint32_t last;                  /* CYCCNT at the previous blend call */
+    uint32_t period;                /* last loop period */
+    uint32_t max_period;
+    uint32_t over;                  /* loop periods over budget */
+    uint32_t shed_ticks;            /* frames with a sliced anim_tick */
+    uint32_t shed_blends;           /* frames whose copy+blend was skipped */
+    uint8_t  div;                   /* level-1 slices, >= 2 */
+    uint8_t  level;
+    uint8_t  calm;                  /* frames in a row under 3/4 budget */
+    uint8_t  skip;                  /* shed this frame's copy+blend */
+} gov;                              /* 32 bytes */
+
+static void gov_update(uint32_t now) {
+    uint32_t p = now - gov.last;
+    gov.last = now;
+    gov.skip = 0;
+    if (gov.budget == 0 || p > GOV_GAP_CYCLES)
+        return;
+    gov.period = p;
+    if (p > gov.max_period)
+        gov.max_period = p;
+    if (p > gov.budget) {
+        gov.over++;
+        gov.calm = 0;
+        if (gov.level < GOV_LEVEL_SKIP)
+            gov.level++;
+        gov.skip = gov.level == GOV_LEVEL_SKIP;
+    } else if (p >= gov.budget - gov.budget / 4) {
+        gov.calm = 0;
+    } else if (gov.level && ++gov.calm >= GOV_CALM_FRAMES) {
+        gov.level--;
+        gov.calm = 0;
+    }
 }
 
-static void rtt_emit(uint8_t tag, uint32_t val) {
-    /* Guard: RTT control block is in PATCH_SRAM which is NOT zero-initialized.
-     * In dongle mode, rtt_init() never runs (handle_usb_connect doesn't fire),
-     * so wr_off/rd_off contain garbage.  Using garbage as an index into rtt_buf
-     * would corrupt random SRAM.  max_up is set to 1 only by rtt_init(). */
-    if (rtt_cb.max_up != 1)
+/* Called once per LED frame from the blend hook */
+static void prof_rtt_tick(void) {
+    if (prof_rtt_period == 0 || ++prof_rtt_ctr < prof_rtt_period)
         return;
+    prof_rtt_ctr = 0;
+    for (uint8_t h = 0; h < PROF_NUM_HOOKS; h++) {
+        uint8_t tag = RTT_TAG_PROF_BASE | (h << 2);
+        rtt_emit(tag | 0, prof_slots[h].count);
+        rtt_emit(tag | 1, prof_slots[h].total_lo);
+        rtt_emit(tag | 2, prof_slots[h].max_cyc);
+    }
+}
 
-    /* Write 5-byte record: [tag:u8] [value:u32 LE] non-blocking. */
-    uint32_t wr = rtt_cb.up[0].wr_off;
-    uint32_t rd = rtt_cb.up[0].rd_off;
+/* ── RTT stream channel (scan timing / ADC sampling) ─────────────────────
+ * Records on channel 1 are 8 bytes: [tag:u8] [t:u24 LE] [value:u32 LE],
+ * t = CYCCNT >> 8 (~1.19 µs at 216 MHz, wraps every ~19.9 s).  Stream tags
+ * are ≥ 0x80 and channel 0 tags < 0x80, so a capture that merges both
+ * channels can still be split by tag.  Emitted from the adc_sensor_process
+ * hook, i.e. once per main-loop scan; configured with 0xEB sub 0x03. */
+#define RTT_SREC_SCAN_PERIOD  0x80  /* u32: cycles since previous scan */
+#define RTT_SREC_ADC_FILTERED 0x81  /* u32: key << 16 | adc_filtered_value[key] */
 
-    /* Check available space (circular buffer) */
-    uint32_t avail;
-    if (wr >= rd)
-        avail = RTT_BUF_SIZE - 1 - wr + rd;
-    else
-        avail = rd - wr - 1;
+#define STREAM_SCAN_PERIOD    0x01
+#define STREAM_ADC_FILTERED   0x02
+#define STREAM_MAX_KEYS       4
+#define MAG_KEY_COUNT         126   /* mag_engine_state_t per-key arrays */
+
+static struct {
+    uint8_t  flags;                 /* STREAM_*, 0 = off */
+    uint8_t  decim;                 /* emit every Nth scan (0/1 = every scan) */
+    uint8_t  ctr;
+    uint8_t  keys[STREAM_MAX_KEYS]; /* mag key index, 0xFF = unused */
+    uint16_t drops;                 /* records lost to a full ring (saturating) */
+    uint32_t last_scan;             /* CYCCNT at previous scan */
+} rtt_stream;
+
+static void rtt_stream_emit(uint8_t tag, uint32_t t, uint32_t val) {
+    uint8_t rec[8] = { tag, (uint8_t)(t >> 8), (uint8_t)(t >> 16), (uint8_t)(t >> 24),
+                       (uint8_t)val, (uint8_t)(val >> 8),
+                       (uint8_t)(val >> 16), (uint8_t)(val >> 24) };
+    if (!rtt_write(RTT_CH_STREAM, rec, sizeof(rec)) && rtt_stream.drops != 0xFFFF)
+        rtt_stream.drops++;
+}
+
+/* ── Packed depth frames (send_depth_monitor_report filter) ──────────────
+ * Stock send_depth_monitor_report writes one [05 1B lo hi key] report into a
+ * single buffer and flags it for the next USB poll, so keys moving in the
+ * same interval overwrite each other and the host sees a trickle.  With
+ * packing on (0xEC, USB only) the filter hook records each key's latest
+ * depth instead, and adc_scan_before_hook flushes everything pending as one
+ * EP2 frame whenever the endpoint is free:
+ *
+ *   [0A] [1C] [seq] [enc] [bitmap × 16] [values …]      ≤ 64 bytes
+ *
+ * Frames use the patch event report (ID 10): the stock vendor report 5 is
+ * declared with 31 bytes, and a longer transfer overflows the host's URB.
+ *
+ * Bitmap bit k = key k present; values follow in key order, encoded against
+ * the last value sent for that key: ABS16 (u16 LE, ≤ 22 keys), DELTA8 (i8)
+ * or DELTA4 (i4, low nibble first).  Every DEPTH_KEYFRAME_PERIOD-th frame is
+ * ABS16, and after DEPTH_REFRESH_SCANS quiet scans an ABS16 frame re-sends
+ * the next 22 keys, so a host that saw a seq gap converges on its own.
+ * Stock 0x1B reports still appear when the pending list is full; decoders
+ * treat them as absolute updates of the same per-key base.
+ *
+ * The host filter (0xEC sub 0x02) applies in both modes — subscription
+ * mask, a global deadband against the last value sent, and a rate cap.
+ * Capped stock reports queue in the same pending list and go out one key
+ * per interval through the stock report buffer, so wireless benefits too. */
+#define DEPTH_NOTIF_FRAME      0x1C
+#define DEPTH_FRAME_HDR        20
+#define DEPTH_FRAME_SIZE       (1 + PATCH_EVENT_LEN)
+#define DEPTH_ABS16_MAX        ((DEPTH_FRAME_SIZE - DEPTH_FRAME_HDR) / 2)  /* 22 */
+#define DEPTH_ENC_ABS16        0
+#define DEPTH_ENC_DELTA8       1
+#define DEPTH_ENC_DELTA4       2
+#define DEPTH_PEND_MAX         32   /* ≤ 44, so DELTA8/DELTA4 always fit */
+#define DEPTH_KEYFRAME_PERIOD  32
+#define DEPTH_REFRESH_SCANS    256
+#define DEPTH_MODE_PACKED      0x01
+#define DEPTH_CYCLES_PER_SEC   216000000u   /* DWT CYCCNT rate */
+#define DEPTH_PENDING_BIT      0x10         /* pending_reports_bitmap: depth report */
+
+static struct {
+    uint8_t  mode;                       /* DEPTH_MODE_*, 0 = stock reports */
+    uint8_t  seq;
+    uint8_t  npend;
+    uint8_t  since_abs;                  /* frames since the last ABS16 frame */
+    uint8_t  refresh_key;                /* next key for the idle refresh */
+    uint16_t idle_scans;
+    uint16_t overflow;                   /* reports left to stock: pending full */
+    uint32_t frames;
+    uint8_t  pend_key[DEPTH_PEND_MAX];   /* ascending key order */
+    uint16_t pend_val[DEPTH_PEND_MAX];
+    uint16_t sent[MAG_KEY_COUNT];        /* last value the host was sent */
+} depth_pack;                            /* 364 bytes */
+
+/* Kept apart from depth_pack so a MODE write leaves the filter alone. */
+static struct {
+    uint8_t  active;                     /* any of the below set */
+    uint8_t  last_key;                   /* round-robin cursor, capped stock path */
+    uint8_t  skip[16];                   /* bit k set = key k not subscribed */
+    uint16_t deadband;                   /* min |Δ| to report; releases to 0 always go */
+    uint32_t min_cycles;                 /* CYCCNT between reports/frames, 0 = uncapped */
+    uint32_t last_t;
+} depth_filter;                          /* 28 bytes */
+
+static uint8_t depth_frame[DEPTH_FRAME_SIZE] __attribute__((aligned(4)));
+
+static inline int depth_packed(void) {
+    return (depth_pack.mode & DEPTH_MODE_PACKED) &&
+           *(volatile uint8_t *)&g_connection_mode == 6;
+}
+
+/* True if v is within the deadband of the value the host last got. */
+static int depth_in_deadband(uint8_t k, uint16_t v) {
+    int32_t d = (int32_t)v - depth_pack.sent[k];
+    if (d < 0) d = -d;
+    return v ? d <= depth_filter.deadband : d == 0;
+}
 
-    if (avail < 5)
-        return;  /* drop if buffer full */
+static void depth_pend_remove(uint8_t i, uint8_t n) {
+    for (uint8_t j = i + n; j < depth_pack.npend; j++) {
+        depth_pack.pend_key[j - n] = depth_pack.pend_key[j];
+        depth_pack.pend_val[j - n] = depth_pack.pend_val[j];
+    }
+    depth_pack.npend -= n;
+}
+
+static void depth_pack_reset(uint8_t mode) {
+    for (uint8_t *b = (uint8_t *)&depth_pack; b < (uint8_t *)(&depth_pack + 1); b++)
+        *b = 0;
+    depth_pack.since_abs = DEPTH_KEYFRAME_PERIOD;   /* first frame is ABS16 */
+    depth_pack.mode = mode;
+}
 
-    rtt_buf[wr] = tag;
-    wr = (wr + 1) % RTT_BUF_SIZE;
-    rtt_buf[wr] = (uint8_t)(val & 0xFF);
-    wr = (wr + 1) % RTT_BUF_SIZE;
-    rtt_buf[wr] = (uint8_t)((val >> 8) & 0xFF);
-    wr = (wr + 1) % RTT_BUF_SIZE;
-    rtt_buf[wr] = (uint8_t)((val >> 16) & 0xFF);
-    wr = (wr + 1) % RTT_BUF_SIZE;
-    rtt_buf[wr] = (uint8_t)((val >> 24) & 0xFF);
-    wr = (wr + 1) % RTT_BUF_SIZE;
+/* Filter hook on send_depth_monitor_report(0x1B, depth_lo, depth_hi, key).
+ * The stock sender rewrites the report buffer without checking the pending
+ * bit, so while a telemetry record holds it the key is queued instead. */
+int depth_report_hook(uint32_t type, uint32_t lo, uint32_t hi, uint32_t key) {
+    (void)type;
+    int packed = depth_packed();
+    int hold = !packed && telem_holds_slot();
+    if (key >= MAG_KEY_COUNT || !(packed || depth_filter.active || hold))
+        return 0;   /* stock single-key report */
+    if (depth_filter.skip[key >> 3] & (1u << (key & 7)))
+        return 1;   /* not subscribed */
+
+    uint16_t v = (uint16_t)((lo & 0xFF) | ((hi & 0xFF) << 8));
+    uint8_t i = 0, n = depth_pack.npend;
+    while (i < n && depth_pack.pend_key[i] < key)
+        i++;
+    if (i < n && depth_pack.pend_key[i] == key) {
+        depth_pack.pend_val[i] = v;
+        return 1;
+    }
+    if ((packed || depth_filter.active) && depth_in_deadband((uint8_t)key, v))
+        return 1;   /* host already has it, near enough */
+    if (!packed && !depth_filter.min_cycles && !hold) {
+        depth_pack.sent[key] = v;
+        return 0;   /* filtered but uncapped: stock report goes out now */
+    }
+    if (n == DEPTH_PEND_MAX) {
+        /* Let the stock 0x1B report carry it; the host decoder takes those
+         * as the new base too, and refresh/keyframes mend any it misses. */
+        depth_pack.sent[key] = v;
+        if (depth_pack.overflow != 0xFFFF) depth_pack.overflow++;
+        return 0;
+    }
+    for (uint8_t j = n; j > i; j--) {
+        depth_pack.pend_key[j] = depth_pack.pend_key[j - 1];
+        depth_pack.pend_val[j] = depth_pack.pend_val[j - 1];
+    }
+    depth_pack.pend_key[i] = (uint8_t)key;
+    depth_pack.pend_val[i] = v;
+    depth_pack.npend = n + 1;
+    return 1;
+}
 
-    /* Atomic u32 store — ISR-safe on Cortex-M4 */
-    rtt_cb.up[0].wr_off = wr;
+/* Queue the next DEPTH_ABS16_MAX subscribed keys' last-sent values. */
+static void depth_queue_refresh(void) {
+    uint8_t k = depth_pack.refresh_key, n = 0;
+    for (; n < DEPTH_ABS16_MAX && k < MAG_KEY_COUNT; k++) {
+        if (depth_filter.skip[k >> 3] & (1u << (k & 7)))
+            continue;
+        depth_pack.pend_key[n] = k;
+        depth_pack.pend_val[n] = depth_pack.sent[k];
+        n++;
+    }
+    depth_pack.refresh_key = k < MAG_KEY_COUNT ? k : 0;
+    depth_pack.npend = n;
+    depth_pack.since_abs = DEPTH_KEYFRAME_PERIOD;
 }
 
-static void log_entry(uint8_t type, const uint8_t *payload, uint8_t len) {
-    /* Write [type] [payload...] into ring buffer */
-    uint16_t total = 1 + len;
+/* Capped stock path: hand one pending key per interval to the stock report
+ * buffer, as send_depth_monitor_report itself would, round-robin by key. */
+static void depth_flush_stock(uint32_t now) {
+    volatile hid_report_state_t *rpt =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    if (!depth_pack.npend || now - depth_filter.last_t < depth_filter.min_cycles ||
+        (rpt->pending_reports_bitmap & DEPTH_PENDING_BIT))
+        return;
 
-    /* Write type byte */
-    log_buf.data[log_buf.head] = type;
-    log_buf.head = (log_buf.head + 1) % LOG_BUF_SIZE;
+    uint8_t i = 0;
+    while (i < depth_pack.npend && depth_pack.pend_key[i] <= depth_filter.last_key)
+        i++;
+    if (i == depth_pack.npend)
+        i = 0;
+    uint8_t k = depth_pack.pend_key[i];
+    uint16_t v = depth_pack.pend_val[i];
+
+    telem_settle();     /* a sent telemetry record must not read as lost */
+    volatile uint8_t *b = (volatile uint8_t *)&g_conn_state_buf;
+    b[0] = 0x05;
+    b[1] = 0x1B;
+    b[2] = (uint8_t)v;
+    b[3] = (uint8_t)(v >> 8);
+    b[4] = k;
+    rpt->pending_reports_bitmap |= DEPTH_PENDING_BIT;
+
+    depth_pack.sent[k] = v;
+    depth_pend_remove(i, 1);
+    depth_filter.last_key = k;
+    depth_filter.last_t = now;
+}
 
-    /* Write payload */
-    for (uint8_t i = 0; i < len; i++) {
-        log_buf.data[log_buf.head] = payload[i];
-        log_buf.head = (log_buf.head + 1) % LOG_BUF_SIZE;
+/* Called once per scan: send pending keys as one frame if EP2 is free. */
+static void depth_flush(void) {
+    uint32_t now = prof_begin();
+    if (!depth_packed()) {
+        depth_flush_stock(now);
+        return;
+    }
+    if (!depth_pack.npend) {
+        /* depth monitor on (g_depth_monitor_enable) gates the refresh */
+        if (++depth_pack.idle_scans < DEPTH_REFRESH_SCANS ||
+            !g_mag_engine_state->cal_mode_1b)
+            return;
+        depth_queue_refresh();
     }
+    volatile hid_report_state_t *rpt =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    if (now - depth_filter.last_t < depth_filter.min_cycles)
+        return;     /* rate cap — keep accumulating */
+    if (rpt->pending_reports_bitmap & LAT_KEY_BITS)
+        return;     /* EP2 is shared with 6KRO/NKRO: key reports go first */
+    if (!rpt->ep2_tx_ready)
+        return;     /* previous frame still in flight — keep accumulating */
+
+    uint8_t n = depth_pack.npend, enc = DEPTH_ENC_ABS16;
+    if (depth_pack.since_abs < DEPTH_KEYFRAME_PERIOD - 1) {
+        int32_t span = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            int32_t d = (int32_t)depth_pack.pend_val[i] - depth_pack.sent[depth_pack.pend_key[i]];
+            if (d < 0) d = ~d;   /* magnitude, so [-8, 7] → < 8 */
+            if (d > span) span = d;
+        }
+        enc = span < 8 ? DEPTH_ENC_DELTA4 : span < 128 ? DEPTH_ENC_DELTA8 : DEPTH_ENC_ABS16;
+    }
+    if (enc == DEPTH_ENC_ABS16 && n > DEPTH_ABS16_MAX)
+        n = DEPTH_ABS16_MAX;
+
+    uint8_t *f = depth_frame;
+    f[0] = PATCH_EVENT_REPORT_ID;
+    f[1] = DEPTH_NOTIF_FRAME;
+    f[2] = depth_pack.seq;
+    f[3] = enc;
+    for (uint8_t i = 4; i < DEPTH_FRAME_HDR; i++)
+        f[i] = 0;
+    uint8_t *v = f + DEPTH_FRAME_HDR;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t k = depth_pack.pend_key[i];
+        uint16_t val = depth_pack.pend_val[i];
+        uint8_t d = (uint8_t)(val - depth_pack.sent[k]);
+        f[4 + (k >> 3)] |= 1u << (k & 7);
+        if (enc == DEPTH_ENC_ABS16) {
+            *v++ = (uint8_t)val;
+            *v++ = (uint8_t)(val >> 8);
+        } else if (enc == DEPTH_ENC_DELTA8) {
+            *v++ = d;
+        } else if (i & 1) {
+            *v++ |= (uint8_t)(d << 4);
+        } else {
+            *v = d & 0x0F;
+        }
+        depth_pack.sent[k] = val;
+    }
+    if (enc == DEPTH_ENC_DELTA4 && (n & 1))
+        v++;
+    ep2_send_if_ready(f, (uint32_t)(v - f));
+
+    /* Drop the sent entries; any ABS16 overflow goes out next scan. */
+    depth_pend_remove(0, n);
+    depth_filter.last_t = now;
+    depth_pack.seq++;
+    depth_pack.frames++;
+    depth_pack.idle_scans = 0;
+    depth_pack.since_abs = enc == DEPTH_ENC_ABS16 ? 0 : depth_pack.since_abs + 1;
+}
 
-    /* Saturating count */
-    if (log_buf.count <= LOG_BUF_SIZE - total)
-        log_buf.count += total;
-    else
-        log_buf.count = LOG_BUF_SIZE;
+/* ── Gamepad axes (report ID 9, descriptor above) ────────────────────────
+ * adc_scan_before_hook samples the assigned keys every scan and sends a
+ * report when any axis moved by more than GAMEPAD_JITTER counts, USB only.
+ * It yields to stock reports (anything in pending_reports_bitmap) so
+ * keyboard input on the shared endpoint never waits behind axis traffic,
+ * and runs after depth_flush — the axes are resampled every scan, so losing
+ * the endpoint for one scan costs nothing. */
+#define GAMEPAD_JITTER     2
+
+static struct {
+    uint8_t  report[1 + GAMEPAD_AXES * 2];   /* [ID] [u16 LE × 6]; also the last values sent */
+    uint8_t  key[GAMEPAD_AXES];          /* mag key index, 0xFF = axis unused */
+    uint8_t  invert;                     /* bit a: axis a = MAX - adc */
+    uint8_t  active;                     /* any axis assigned */
+} gamepad __attribute__((aligned(4)));  /* 21 bytes */
+
+static void gamepad_flush(void) {
+    volatile hid_report_state_t *rpt =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    if (!gamepad.active || *(volatile uint8_t *)&g_connection_mode != 6 ||
+        rpt->pending_reports_bitmap || !rpt->ep2_tx_ready)
+        return;
+
+    uint16_t v[GAMEPAD_AXES];
+    int moved = 0;
+    for (uint8_t a = 0; a < GAMEPAD_AXES; a++) {
+        uint8_t k = gamepad.key[a];
+        v[a] = 0;
+        if (k < MAG_KEY_COUNT) {
+            v[a] = g_mag_engine_state->adc_filtered_value[k] & GAMEPAD_AXIS_MAX;
+            if (gamepad.invert & (1u << a))
+                v[a] = GAMEPAD_AXIS_MAX - v[a];
+        }
+        uint8_t *p = &gamepad.report[1 + a * 2];
+        int32_t d = (int32_t)v[a] - (p[0] | (p[1] << 8));
+        if (d > GAMEPAD_JITTER || d < -GAMEPAD_JITTER)
+            moved = 1;
+    }
+    if (!moved)
+        return;
+    gamepad.report[0] = GAMEPAD_REPORT_ID;
+    for (uint8_t a = 0; a < GAMEPAD_AXES; a++) {
+        gamepad.report[1 + a * 2] = (uint8_t)v[a];
+        gamepad.report[2 + a * 2] = (uint8_t)(v[a] >> 8);
+    }
+    ep2_send_if_ready(gamepad.report, sizeof(gamepad.report));
+}
+
+/* Called BEFORE adc_sensor_process (main loop, once per scan). */
+void adc_scan_before_hook(void) {
+    depth_flush();
+    gamepad_flush();
+
+    if (!rtt_stream.flags)
+        return;
+
+    uint32_t now = prof_begin();    /* also enables DWT on first use */
+    uint32_t period = now - rtt_stream.last_scan;
+    rtt_stream.last_scan = now;
+
+    if (++rtt_stream.ctr < rtt_stream.decim)
+        return;
+    rtt_stream.ctr = 0;
+
+    if (rtt_stream.flags & STREAM_SCAN_PERIOD)
+        rtt_stream_emit(RTT_SREC_SCAN_PERIOD, now, period);
+
+    if (rtt_stream.flags & STREAM_ADC_FILTERED) {
+        for (uint8_t i = 0; i < STREAM_MAX_KEYS; i++) {
+            uint8_t k = rtt_stream.keys[i];
+            if (k >= MAG_KEY_COUNT)
+                continue;
+            rtt_stream_emit(RTT_SREC_ADC_FILTERED, now,
+                            ((uint32_t)k << 16) | g_mag_engine_state->adc_filtered_value[k]);
+        }
+    }
 }
 
 /* ── Dongle reports "before" hook ──────────────────────────────────── */
@@ -390,7 +1072,7 @@ static void log_entry(uint8_t type, const uint8_t *payload, uint8_t len) {
 
 #define RTT_TAG_DONGLE_BITMAP  0x20  /* u8: pending_reports_bitmap snapshot */
 
-void dongle_reports_before_hook(void) {
+static void dongle_reports_process(void) {
     rtt_init();  /* idempotent; ensures RTT works in dongle mode */
 
     if (*(volatile uint8_t *)&g_connection_mode != 5)
@@ -425,12 +1107,35 @@ void dongle_reports_before_hook(void) {
         rtt_emit(RTT_TAG_DONGLE_BITMAP, bitmap);
 }
 
+void dongle_reports_before_hook(void) {
+    uint32_t t0 = prof_begin();
+    if (((volatile hid_report_state_t *)&g_hid_report_pending_flags)->pending_reports_bitmap &
+        LAT_KEY_BITS)
+        lat_report_sent();
+    dongle_reports_process();
+    prof_end(PROF_DONGLE_REPORTS, t0);
+}
+
+/* ── USB report send "before" hook ─────────────────────────────────── */
+/* Called BEFORE usb_ep_report_send, which sends at most one pending report
+ * per call: 6KRO (bit 0x20) needs ep1_tx_ready, NKRO (bit 0x40)
+ * ep2_tx_ready.  Only used to close the latency stamp. */
+void report_send_before_hook(void) {
+    volatile hid_report_state_t *reports =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    uint8_t bitmap = reports->pending_reports_bitmap;
+
+    if (((bitmap & 0x20) && reports->ep1_tx_ready) ||
+        ((bitmap & 0x40) && reports->ep2_tx_ready))
+        lat_report_sent();
+}
+
 /* ── Battery monitor "before" hook ─────────────────────────────────── */
 /* Called BEFORE battery_level_monitor runs. Emits RTT records with
  * current battery ADC, level, charger state etc. for live observation.
  * battery_level_monitor fires when adc_counter == 2000 (~every few seconds). */
 
-void battery_monitor_before_hook(void) {
+static void battery_monitor_process(void) {
     rtt_init();  /* idempotent; ensures RTT works in all modes */
 
     volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
@@ -445,9 +1150,23 @@ void battery_monitor_before_hook(void) {
     rtt_emit(RTT_TAG_ADC_COUNTER, ADC_SCAN_COUNTER);
 }
 
+void battery_monitor_before_hook(void) {
+    uint32_t t0 = prof_begin();
+    battery_monitor_process();
+    prof_end(PROF_BATTERY, t0);
+}
+
 /* Forward declaration for USB path (GET_REPORT IF2) and handle_patch_info. */
 static void fill_patch_info_response(volatile uint8_t *buf);
 
+/* 0xE7 sub-commands for the register map; sub 0x00 is the legacy blob. */
+#define REGMAP_DIR   0x01
+#define REGMAP_READ  0x02
+static int handle_regmap(volatile uint8_t *buf);
+#ifdef PATCH_BENCH
+static int handle_bench_cmd(volatile uint8_t *buf);
+#endif
+
 /* ── HID class setup handler (battery reporting) ─────────────────────── */
 /* The stub saves {r0-r3,r12,lr} then does `bl handle_hid_setup`.
  * At the bl, r0 still holds the original first argument (udev) from
@@ -455,7 +1174,7 @@ static void fill_patch_info_response(volatile uint8_t *buf);
  * NOTE: udev = g_usb_device + 4 (the core_handler passes udev+4 down),
  * i.e. it points to g_usb_device_handle (otg_dev_handle_t). */
 
-int handle_hid_setup(otg_dev_handle_t *udev) {
+static int hid_setup_process(otg_dev_handle_t *udev) {
     uint8_t  bmReqType = udev->setup.bmRequestType;
     uint8_t  bRequest  = udev->setup.bRequest;
     uint16_t wValue    = udev->setup.wValue;
@@ -472,27 +1191,18 @@ int handle_hid_setup(otg_dev_handle_t *udev) {
     /* Log full setup packet */
     log_entry(LOG_HID_SETUP_ENTRY, (const uint8_t *)&udev->setup, 8);
 
-    /* Populate extended_rdesc: original IF1 descriptor + battery descriptor.
+    /* Populate extended_rdesc: original IF1 descriptor + battery + gamepad.
      * Runs on every call (idempotent) so the buffer is ready before the
      * original handler reads from it.  The literal pool at 0x0801485c has
      * been patched at build time to point to extended_rdesc, and the length
-     * cap at 0x080147fc/08014800 patched from 0xAB to 0xD9, so the original
+     * cap at 0x080147fc/08014800 patched from 0xAB to 0xF9, so the original
      * hid_class_setup_handler naturally serves our extended descriptor. */
-    memcpy(extended_rdesc, (void *)&g_if1_report_desc, IF1_RDESC_LEN);
-    for (int i = 0; i < (int)BATTERY_RDESC_LEN; i++)
-        extended_rdesc[IF1_RDESC_LEN + i] = battery_rdesc[i];
+    extended_rdesc_fill();
 
     /* Patch wDescriptorLength in all SRAM descriptor copies (idempotent).
      * Must run on EVERY hid_class_setup call — not just IF1 — so that config
      * descriptor copies are patched before the next USB re-enumeration. */
-    WDESCLEN_STANDALONE[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_STANDALONE[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_FS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_FS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_HS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_HS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_OS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_OS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
+    PATCH_WDESCLEN(EXTENDED_RDESC_LEN);
 
     /* Only intercept GET_REPORT for IF1 battery Feature report.
      * All other requests (GET_DESCRIPTOR, SET_IDLE, etc.) pass through to
@@ -534,6 +1244,13 @@ int handle_hid_setup(otg_dev_handle_t *udev) {
     return 0;   /* passthrough to original handler */
 }
 
+int handle_hid_setup(otg_dev_handle_t *udev) {
+    uint32_t t0 = prof_begin();
+    int r = hid_setup_process(udev);
+    prof_end(PROF_HID_SETUP, t0);
+    return r;
+}
+
 /* ── Animation engine math helpers ────────────────────────────────────── */
 
 /* Integer easing: t is 0-255 fixed-point, returns 0-255.
@@ -575,10 +1292,12 @@ static inline uint8_t lerp8(uint8_t a, uint8_t b, uint8_t t) {
     return (uint8_t)((int16_t)a + ((((int16_t)b - (int16_t)a) * (int16_t)t) >> 8));
 }
 
-/* HSV→RGB (h,s,v all 0-255) */
+/* HSV→RGB (h,s,v all 0-255).  h/43 and h%43 via reciprocal multiply:
+ * (h × 1525) >> 16 == h / 43 for every h in 0..255. */
 static void hsv_to_rgb(uint8_t h, uint8_t s, uint8_t v,
                         uint8_t *r, uint8_t *g, uint8_t *b) {
-    uint8_t region = h / 43, remainder = (h % 43) * 6;
+    uint8_t region = (uint8_t)(((uint32_t)h * 1525) >> 16);
+    uint8_t remainder = (uint8_t)((h - region * 43) * 6);
     uint8_t p = (uint8_t)((v * (255 - s)) >> 8);
     uint8_t q = (uint8_t)((v * (255 - ((s * remainder) >> 8))) >> 8);
     uint8_t t = (uint8_t)((v * (255 - ((s * (255 - remainder)) >> 8))) >> 8);
@@ -592,161 +1311,746 @@ static void hsv_to_rgb(uint8_t h, uint8_t s, uint8_t v,
     }
 }
 
-/* Evaluate a definition at local time t_local (in ticks).
- * Writes RGB result to *out_r, *out_g, *out_b. */
-static void anim_evaluate(const anim_def_t *def, uint16_t t_local,
-                           uint8_t *out_r, uint8_t *out_g, uint8_t *out_b) {
-    /* Rainbow mode: hue from time, brightness from keyframes */
-    if (def->flags & ANIM_FLAG_RAINBOW) {
-        /* Compute brightness from keyframes */
-        uint8_t bri = 255;
-        if (def->num_kf >= 2) {
-            /* Find segment */
-            uint8_t seg = 0;
-            for (uint8_t i = 0; i < def->num_kf - 1; i++) {
-                if (t_local < def->kf[i + 1].t_ticks) { seg = i; goto found_bri; }
-            }
-            seg = def->num_kf - 1;
-found_bri:
-            if (seg < def->num_kf - 1) {
-                uint16_t dt = def->kf[seg + 1].t_ticks - def->kf[seg].t_ticks;
-                if (dt > 0 && t_local >= def->kf[seg].t_ticks) {
-                    uint8_t frac = (uint8_t)(((uint32_t)(t_local - def->kf[seg].t_ticks) * 255) / dt);
-                    uint8_t eased = ease_apply(def->kf[seg].easing, frac);
-                    bri = lerp8(def->kf[seg].r, def->kf[seg + 1].r, eased); /* r = brightness in rainbow */
-                } else {
-                    bri = def->kf[seg].r;
-                }
-            } else {
-                bri = def->kf[seg].r;
+/* Unpack RGB565 to RGB888 */
+static inline void unpack_rgb565(uint16_t c565, uint8_t *r, uint8_t *g, uint8_t *b) {
+    *r = (uint8_t)(((c565 >> 8) & 0xF8) | ((c565 >> 13) & 0x07));
+    *g = (uint8_t)(((c565 >> 3) & 0xFC) | ((c565 >> 9)  & 0x03));
+    *b = (uint8_t)(((c565 << 3) & 0xF8) | ((c565 >> 2)  & 0x07));
+}
+
+/* floor(65535 / dt) for every byte-sized segment length.  (y × (r + 1)) >> 16
+ * overshoots y / dt by at most one for y < 2^16, so one fix-up makes the
+ * segment fraction exact without a UDIV.  512B of flash instead of a Q16
+ * reciprocal per segment in SRAM. */
+#define DT_RECIP1(d)   (uint16_t)((d) ? 65535u / (d) : 0)
+#define DT_RECIP4(d)   DT_RECIP1(d), DT_RECIP1(d + 1), DT_RECIP1(d + 2), DT_RECIP1(d + 3)
+#define DT_RECIP16(d)  DT_RECIP4(d), DT_RECIP4(d + 4), DT_RECIP4(d + 8), DT_RECIP4(d + 12)
+#define DT_RECIP64(d)  DT_RECIP16(d), DT_RECIP16(d + 16), DT_RECIP16(d + 32), DT_RECIP16(d + 48)
+
+static const uint16_t anim_dt_recip[256] = {
+    DT_RECIP64(0), DT_RECIP64(64), DT_RECIP64(128), DT_RECIP64(192),
+};
+
+/* Live defs first, then the staged ones while a stage is open or armed. */
+static anim_def_t *anim_def_slot(uint8_t i) {
+    return i < ANIM_MAX_DEFS ? &anim_defs[i] : &anim_stage.defs[i - ANIM_MAX_DEFS];
+}
+
+static inline void anim_def_release(anim_def_t *def) {
+    def->num_kf = 0;
+    def->kf_count = 0;   /* slots are reclaimed by the next compaction */
+}
+
+/* Slide every held run down over the gaps left by released or redefined
+ * defs.  Runs are disjoint or, for a staged def seeded from the live
+ * scene, identical, so moving them in base order keeps both tables
+ * consistent.  Only runs when a DEF finds the free tail too short. */
+static void anim_pool_compact(void) {
+    uint8_t ndefs = anim_stage.state == ANIM_STAGE_IDLE ? ANIM_MAX_DEFS : 2 * ANIM_MAX_DEFS;
+    uint8_t top = 0;
+    for (;;) {
+        uint8_t base = ANIM_POOL_KF, n = 0;
+        for (uint8_t i = 0; i < ndefs; i++) {
+            const anim_def_t *d = anim_def_slot(i);
+            if (d->kf_count && d->kf_base >= top && d->kf_base < base) {
+                base = d->kf_base;
+                n = d->kf_count;
             }
-        } else if (def->num_kf == 1) {
-            bri = def->kf[0].r;
         }
-        /* Hue sweeps 0-255 over duration */
-        uint8_t hue = (def->duration_ticks > 0)
-            ? (uint8_t)(((uint32_t)t_local * 255) / def->duration_ticks)
-            : 0;
-        hsv_to_rgb(hue, 255, bri, out_r, out_g, out_b);
-        return;
-    }
-
-    /* Normal keyframe mode: find segment, interpolate RGB */
-    if (def->num_kf == 0) { *out_r = *out_g = *out_b = 0; return; }
-    if (def->num_kf == 1) {
-        *out_r = def->kf[0].r; *out_g = def->kf[0].g; *out_b = def->kf[0].b;
-        return;
+        if (n == 0)
+            break;
+        for (uint8_t j = 0; j < n; j++)
+            anim_kf_pool[top + j] = anim_kf_pool[base + j];
+        for (uint8_t i = 0; i < ndefs; i++) {
+            anim_def_t *d = anim_def_slot(i);
+            if (d->kf_count && d->kf_base == base)
+                d->kf_base = top;
+        }
+        top += n;
     }
+    anim_pool_top = top;
+}
 
-    /* Find surrounding keyframes */
-    uint8_t seg = 0;
-    for (uint8_t i = 0; i < def->num_kf - 1; i++) {
-        if (t_local < def->kf[i + 1].t_ticks) { seg = i; goto found_seg; }
-    }
-    seg = def->num_kf - 1;
-found_seg:
-    if (seg >= def->num_kf - 1) {
-        /* At or past last keyframe */
-        *out_r = def->kf[seg].r; *out_g = def->kf[seg].g; *out_b = def->kf[seg].b;
-        return;
-    }
+/* Give def a run of n pool keyframes in place of any it held, leaving it
+ * unused until its keyframes are in.  0 if the pool is full even after
+ * compaction. */
+static int anim_pool_alloc(anim_def_t *def, uint8_t n) {
+    anim_def_release(def);
+    if (ANIM_POOL_KF - anim_pool_top < n)
+        anim_pool_compact();
+    if (ANIM_POOL_KF - anim_pool_top < n)
+        return 0;
+    def->kf_base = anim_pool_top;
+    def->kf_count = n;
+    anim_pool_top += n;
+    return 1;
+}
 
-    uint16_t dt = def->kf[seg + 1].t_ticks - def->kf[seg].t_ticks;
-    if (dt == 0 || t_local < def->kf[seg].t_ticks) {
-        *out_r = def->kf[seg].r; *out_g = def->kf[seg].g; *out_b = def->kf[seg].b;
-        return;
+/* Store wire keyframes [first, first + n) of def, 5 bytes each from p:
+ * t_ticks (u16 LE, absolute), RGB565 (u16 LE), easing.  Times go in as
+ * deltas in the def's tick quantum, saturating at a byte if a segment is
+ * longer than the duration that picked the quantum. */
+static void anim_store_kf(const anim_def_t *def, uint8_t first, uint8_t n,
+                          const volatile uint8_t *p) {
+    anim_keyframe_t *kf = &anim_kf_pool[def->kf_base];
+    uint16_t prev = 0;
+    for (uint8_t i = 0; i < first; i++)
+        prev += kf[i].dt;
+    for (uint8_t i = first; i < first + n; i++, p += 5) {
+        uint16_t t = (uint16_t)(p[0] | ((uint16_t)p[1] << 8)) >> def->t_shift;
+        uint16_t dt = t > prev ? t - prev : 0;
+        if (dt > 255)
+            dt = 255;
+        prev += dt;
+        kf[i].dt = (uint8_t)dt;
+        kf[i].c565 = (uint16_t)(p[2] | ((uint16_t)p[3] << 8));
+        kf[i].easing = p[4];
     }
+}
 
-    /* Compute fractional position 0-255 */
-    uint8_t frac = (uint8_t)(((uint32_t)(t_local - def->kf[seg].t_ticks) * 255) / dt);
-    uint8_t eased = ease_apply(def->kf[seg].easing, frac);
+/* Precompute the modulo constant and reset the cursor of a live def.
+ * Called whenever a def's keyframes become complete (DEF, DEF_EXT, or a
+ * staged scene being swapped in) — the only division the engine performs. */
+static void anim_prepare_def(uint8_t def_id) {
+    const anim_def_t *def = &anim_defs[def_id];
+    anim_def_rt_t *rt = &anim_rt[def_id];
+    rt->dur_recip = 0xFFFFFFFFu / def->duration_ticks;   /* duration ≥ 1 */
+    rt->seg_t0 = (uint16_t)(anim_kf_pool[def->kf_base].dt << def->t_shift);
+    anim_seg_cursor[def_id] = 0;
+}
 
-    *out_r = lerp8(def->kf[seg].r, def->kf[seg + 1].r, eased);
-    *out_g = lerp8(def->kf[seg].g, def->kf[seg + 1].g, eased);
-    *out_b = lerp8(def->kf[seg].b, def->kf[seg + 1].b, eased);
+/* x / duration_ticks without UDIV: the reciprocal underestimates the
+ * quotient by at most one for any 32-bit x, so one fix-up suffices. */
+static inline uint32_t anim_div_duration(const anim_def_t *def,
+                                         const anim_def_rt_t *rt, uint32_t x) {
+    uint32_t q = (uint32_t)(((uint64_t)x * rt->dur_recip) >> 32);
+    if (x - q * def->duration_ticks >= def->duration_ticks)
+        q++;
+    return q;
 }
 
-/* Tick the animation engine. Called from led_overlay_memcpy_and_blend
- * which runs at ~100Hz (LED DMA refresh rate, measured). Each call = 1 tick.
- * The daemon converts ms→ticks at 10ms/tick to match this rate. */
-static void anim_tick(void) {
-    if (anim_engine.active_count == 0)
-        return;
+static inline uint16_t anim_mod_duration(const anim_def_t *def,
+                                         const anim_def_rt_t *rt, uint32_t x) {
+    return (uint16_t)(x - anim_div_duration(def, rt, x) * def->duration_ticks);
+}
 
-    /* Advance elapsed for active defs */
-    for (int d = 0; d < ANIM_MAX_DEFS; d++) {
-        if (anim_defs[d].num_kf == 0)
-            continue;
-        anim_defs[d].elapsed_ticks++;
+/* Find the segment containing t_local and its eased 0-255 position.
+ * The search starts from the def's cursor and walks in either direction,
+ * accumulating keyframe deltas, so steady playback costs O(1) regardless
+ * of num_kf.  Sets *a and *b to the keyframes to interpolate between
+ * (*b == *a when holding). */
+static uint8_t anim_segment(uint8_t def_id, uint16_t t_local,
+                            const anim_keyframe_t **a, const anim_keyframe_t **b) {
+    const anim_def_t *def = &anim_defs[def_id];
+    anim_def_rt_t *rt = &anim_rt[def_id];
+    const anim_keyframe_t *kf = &anim_kf_pool[def->kf_base];
+    uint8_t sh = def->t_shift;
+    uint8_t last = def->num_kf - 1;
+    uint8_t seg = anim_seg_cursor[def_id];
+    uint32_t t0 = rt->seg_t0;
+    if (seg > last) {
+        seg = 0;
+        t0 = (uint32_t)kf[0].dt << sh;
     }
 
-    /* Evaluate each assigned key */
-    uint8_t any_active = 0;
-    for (int i = 0; i < LED_COUNT; i++) {
-        if (key_table[i].anim_id >= ANIM_MAX_DEFS)
-            continue;
-
-        anim_def_t *def = &anim_defs[key_table[i].anim_id];
-        if (def->num_kf == 0) {
-            key_table[i].anim_id = 0xFF; /* def was cancelled */
-            continue;
-        }
-        any_active = 1;
+    while (seg > 0 && t_local < t0)
+        t0 -= (uint32_t)kf[seg--].dt << sh;
+    while (seg < last && t_local >= t0 + ((uint32_t)kf[seg + 1].dt << sh))
+        t0 += (uint32_t)kf[++seg].dt << sh;
+    anim_seg_cursor[def_id] = seg;
+    rt->seg_t0 = (uint16_t)t0;   /* ≤ t_local, or kf[0]'s start: always a u16 */
+
+    *a = &kf[seg];
+    uint8_t dt = seg < last ? kf[seg + 1].dt : 0;
+    if (dt == 0 || t_local < t0) {
+        *b = *a;   /* at/past last keyframe, zero-length segment, or before kf[0] */
+        return 0;
+    }
+    *b = &kf[seg + 1];
+
+    /* floor(255·x / (dt << sh)) == floor(((255·x) >> sh) / dt), y < 255·dt */
+    uint32_t y = ((t_local - t0) * 255u) >> sh;
+    uint32_t frac = (y * (anim_dt_recip[dt] + 1u)) >> 16;
+    if (frac * dt > y)
+        frac--;
+    return ease_apply(kf[seg].easing, (uint8_t)frac);
+}
 
-        uint16_t phase = (uint16_t)key_table[i].phase_offset * 8;
-        uint8_t r, g, b;
+/* Evaluate a definition at local time t_local (in ticks).
+ * Writes RGB result to *out_r, *out_g, *out_b. */
+static void anim_evaluate(uint8_t def_id, uint16_t t_local,
+                           uint8_t *out_r, uint8_t *out_g, uint8_t *out_b) {
+    const anim_def_t *def = &anim_defs[def_id];
+    anim_def_rt_t *rt = &anim_rt[def_id];
+    if (def->num_kf == 0) { *out_r = *out_g = *out_b = 0; return; }
 
-        if (def->flags & ANIM_FLAG_ONE_SHOT) {
-            int32_t local_t = (int32_t)def->elapsed_ticks - (int32_t)phase;
-            if (local_t < 0) {
-                r = 0; g = 0; b = 0;  /* not started yet — black */
-            } else if (local_t >= (int32_t)def->duration_ticks) {
-                uint8_t last = def->num_kf - 1;
-                r = def->kf[last].r; g = def->kf[last].g; b = def->kf[last].b;
-            } else {
-                anim_evaluate(def, (uint16_t)local_t, &r, &g, &b);
-            }
-        } else {
-            /* Looping */
-            if (def->duration_ticks == 0) {
-                r = def->kf[0].r; g = def->kf[0].g; b = def->kf[0].b;
-            } else {
-                uint16_t t = (uint16_t)((def->elapsed_ticks + phase) % def->duration_ticks);
-                anim_evaluate(def, t, &r, &g, &b);
-            }
-        }
+    const anim_keyframe_t *a, *b;
+    uint8_t eased = anim_segment(def_id, t_local, &a, &b);
+    uint8_t r0, g0, b0, r1, g1, b1;
+    unpack_rgb565(a->c565, &r0, &g0, &b0);
+    unpack_rgb565(b->c565, &r1, &g1, &b1);
 
-        overlay_buf[i * 3 + 0] = r;
-        overlay_buf[i * 3 + 1] = g;
-        overlay_buf[i * 3 + 2] = b;
+    /* Rainbow mode: hue from time, brightness from keyframes (r channel) */
+    if (def->flags & ANIM_FLAG_RAINBOW) {
+        uint8_t bri = lerp8(r0, r1, eased);
+        /* Hue sweeps 0-255 over duration */
+        uint8_t hue = (uint8_t)anim_div_duration(def, rt, (uint32_t)t_local * 255);
+        hsv_to_rgb(hue, 255, bri, out_r, out_g, out_b);
+        return;
     }
 
-    if (any_active)
-        overlay_active = 1;
+    /* Normal keyframe mode: interpolate RGB */
+    *out_r = lerp8(r0, r1, eased);
+    *out_g = lerp8(g0, g1, eased);
+    *out_b = lerp8(b0, b1, eased);
 }
 
-/* ── WS2812 encoding for SPI scanout ─────────────────────────────────────
- * Matches firmware ws2812_set_pixel(): each byte expands to 8 SPI bytes;
- * 1 bit → 0xF0 (long high), 0 bit → 0xC0 (short high). MSB first (byte 0 =
- * bit 7). Assumes SPI sends MSB of each byte first. Buffer layout per LED:
- * bytes 0–7 G, 8–15 R, 16–23 B (GRB order for WS2812). */
+/* Per-frame evaluation cache for anim_tick().  Keys sharing a definition
+ * and local time (whole-board breathe, or a handful of phase groups) get
+ * one anim_evaluate() per frame instead of one per key.  Direct-mapped,
+ * indexed by a multiplicative hash of the (def, local_t) tag; a collision
+ * just costs a re-evaluation.  Lives on the stack — valid for one tick. */
+#define ANIM_EVAL_CACHE_SIZE  16                /* power of two */
+#define ANIM_EVAL_TAG_NONE    0xFFFFFFFFu
 
-static void encode_ws2812_byte(volatile uint8_t *p, uint8_t val) {
-    p[0] = (val & 0x80) ? 0xF0 : 0xC0;
-    p[1] = (val & 0x40) ? 0xF0 : 0xC0;
-    p[2] = (val & 0x20) ? 0xF0 : 0xC0;
-    p[3] = (val & 0x10) ? 0xF0 : 0xC0;
-    p[4] = (val & 0x08) ? 0xF0 : 0xC0;
-    p[5] = (val & 0x04) ? 0xF0 : 0xC0;
-    p[6] = (val & 0x02) ? 0xF0 : 0xC0;
-    p[7] = (val & 0x01) ? 0xF0 : 0xC0;
+typedef struct {
+    uint32_t tag;           /* (def_id << 16) | local_t, TAG_NONE = empty */
+    uint8_t  r, g, b;
+    uint8_t  _pad;
+} anim_eval_slot_t;         /* 8 bytes */
+
+static void anim_evaluate_cached(anim_eval_slot_t *cache, uint8_t def_id,
+                                 uint16_t t_local,
+                                 uint8_t *out_r, uint8_t *out_g, uint8_t *out_b) {
+    uint32_t tag = ((uint32_t)def_id << 16) | t_local;
+    anim_eval_slot_t *slot =
+        &cache[(tag * 2654435761u) >> (32 - 4)];   /* 4 = log2(ANIM_EVAL_CACHE_SIZE) */
+
+    if (slot->tag != tag) {
+        anim_evaluate(def_id, t_local, &slot->r, &slot->g, &slot->b);
+        slot->tag = tag;
+    }
+    *out_r = slot->r; *out_g = slot->g; *out_b = slot->b;
 }
 
-/* ── Patch discovery (0xE7) ──────────────────────────────────────────────
- * Response layout in g_vendor_cmd_buffer (buf = cmd_buf):
- *   buf[3..4] = magic 0xCA 0xFE    → host sees resp[1..2]
- *   buf[5]    = patch version       → resp[3]
- *   buf[6..7] = capabilities LE16   → resp[4..5]
+static void anim_recount_active(void) {
+    uint8_t count = 0;
+    for (int i = 0; i < ANIM_MAX_DEFS; i++) {
+        if (anim_defs[i].num_kf > 0) count++;
+    }
+    anim_engine.active_count = count;
+}
+
+static inline int anim_is_trigger(uint8_t id) {
+    return id < ANIM_MAX_DEFS && (anim_defs[id].flags & ANIM_FLAG_TRIGGER);
+}
+
+/* Auto-clean zombie defs: num_kf > 0 but no keys assigned (TRIGGER defs exempt).
+ * A def waiting under a trigger on some key still owns it.
+ * Call ONLY after ASSIGN (when key ownership may have changed),
+ * NOT after DEF (which creates defs before keys are assigned). */
+static void anim_cleanup_zombies(void) {
+    uint32_t owned = 0;
+    for (int k = 0; k < LED_COUNT; k++) {
+        uint8_t id = key_table[k].anim_id;
+        if (anim_is_trigger(id))
+            id = key_bg[k].id;
+        if (id < ANIM_MAX_DEFS)
+            owned |= 1u << id;
+    }
+    for (int d = 0; d < ANIM_MAX_DEFS; d++) {
+        if (anim_defs[d].num_kf == 0 || (anim_defs[d].flags & ANIM_FLAG_TRIGGER))
+            continue;  /* trigger defs own keys only while playing */
+        if (!(owned & (1u << d))) {
+            anim_def_release(&anim_defs[d]);
+            anim_rt[d].elapsed_ticks = 0;
+        }
+    }
+    anim_recount_active();
+}
+
+/* sin(i·π/32) in Q7 for i = 0..16: one quadrant at 1/64-turn steps */
+static const uint8_t anim_sin_q7[17] = {
+    0, 13, 25, 37, 49, 60, 71, 81, 91, 99, 106, 113, 118, 122, 126, 127, 128,
+};
+
+/* sin of a in 256ths of a turn, Q7, to the nearest 1/64 turn */
+static int32_t anim_sin(uint8_t a) {
+    uint8_t i = (uint8_t)(((a & 63) + 2) >> 2);
+    int32_t v = (a & 64) ? anim_sin_q7[16 - i] : anim_sin_q7[i];
+    return (a & 128) ? -v : v;
+}
+
+/* Matrix position of a strip LED (inverse of static_led_pos_tbl) */
+static uint8_t anim_strip_pos(uint8_t strip_idx) {
+    for (uint8_t pos = 0; pos < MATRIX_LEN; pos++)
+        if (static_led_pos_tbl[pos] == strip_idx)
+            return pos;
+    return 0;
+}
+
+/* Phase a spatial def gives the key at matrix pos, in ticks: the key's
+ * distance along the pattern in cells, times spread.  LINEAR measures from
+ * the board corner the wave enters at, so every key gets a phase >= 0. */
+static uint16_t anim_spatial_t0(const anim_def_t *def, uint8_t pos) {
+    int32_t row = pos >> 4, col = pos & 15, d;  /* d: distance in 1/128 cells */
+    switch (def->flags & ANIM_FLAG_SPATIAL) {
+    case ANIM_SPATIAL_LINEAR: {
+        int32_t c = anim_sin((uint8_t)(def->reach + 64)), s = anim_sin(def->reach);
+        d = col * c + row * s;
+        if (c < 0) d -= 15 * c;
+        if (s < 0) d -= (MATRIX_LEN / 16 - 1) * s;
+        break;
+    }
+    case ANIM_SPATIAL_RADIAL: {
+        int32_t dr = row - (def->reach >> 4), dc = col - (def->reach & 15);
+        if (dr < 0) dr = -dr;
+        if (dc < 0) dc = -dc;
+        int32_t hi = dr > dc ? dr : dc, lo = dr + dc - hi;
+        d = hi * 128 + lo * 48;  /* max + 3/8·min: within 7% of Euclidean */
+        break;
+    }
+    case ANIM_SPATIAL_SWEEP: {
+        uint8_t dir = def->reach & 3;
+        int32_t cell = (dir & 2) ? row : col;
+        int32_t last = (dir & 2) ? MATRIX_LEN / 16 - 1 : 15;
+        d = ((dir & 1) ? last - cell : cell) * 128;
+        break;
+    }
+    default:
+        return 0;
+    }
+    return (uint16_t)((d * def->spread + 64) >> 7);
+}
+
+/* key_t0[] value for the key at matrix pos assigned to def with the given
+ * phase_offset: a phase for looping/one-shot defs (plus the def's spatial
+ * phase, baked in here so playback never sees it), a start frame for
+ * TRIGGER defs. */
+static uint16_t anim_key_t0(const anim_def_t *def, uint8_t pos, uint8_t phase) {
+    if (def->flags & ANIM_FLAG_TRIGGER)
+        return (uint16_t)((uint16_t)anim_engine.frame_count + phase);
+    return (uint16_t)((uint16_t)phase * 8 + anim_spatial_t0(def, pos));
+}
+
+/* phase_offset that key_t0[k] was assigned with (0 for TRIGGER keys, whose
+ * key_t0 is a start frame, and for unassigned keys) */
+static uint8_t anim_key_phase(uint8_t k) {
+    uint8_t id = key_table[k].anim_id;
+    if (id >= ANIM_MAX_DEFS || (anim_defs[id].flags & ANIM_FLAG_TRIGGER))
+        return 0;
+    uint16_t t0 = (uint16_t)(key_t0[k] - anim_spatial_t0(&anim_defs[id], anim_strip_pos(k)));
+    return (uint8_t)(t0 >> 3);
+}
+
+/* Start def_id (a TRIGGER def) on strip LED k from frame t0 */
+static void anim_trigger_start(uint8_t k, uint8_t def_id, uint16_t t0) {
+    if (!anim_is_trigger(key_table[k].anim_id)) {
+        key_bg[k].id = key_table[k].anim_id;
+        key_bg[k].phase = anim_key_phase(k);
+    }
+    key_table[k].anim_id = def_id;
+    key_t0[k] = t0;
+}
+
+/* The TRIGGER one-shot on strip LED k is over: give the key back to the
+ * def it displaced, if that is still live.  0 if the key is left idle. */
+static int anim_trigger_end(uint8_t k) {
+    uint8_t bg = key_bg[k].id;
+    key_bg[k].id = 0xFF;
+    if (bg < ANIM_MAX_DEFS && anim_defs[bg].num_kf > 0 && !anim_is_trigger(bg)) {
+        key_table[k].anim_id = bg;
+        key_t0[k] = anim_key_t0(&anim_defs[bg], anim_strip_pos(k), key_bg[k].phase);
+        return 1;
+    }
+    key_table[k].anim_id = 0xFF;
+    return 0;
+}
+
+/* Swap the staged scene in.  Every def restarts at elapsed 0 on this frame,
+ * so a multi-def scene starts in lockstep; keys not in the new scene go
+ * dark (the overlay is rebuilt by this same tick). */
+static void anim_stage_apply(void) {
+    memcpy(anim_defs, anim_stage.defs, sizeof(anim_defs));
+    for (uint8_t k = 0; k < LED_COUNT; k++) {
+        uint8_t id = anim_stage.keys[k].anim_id;
+        key_table[k].anim_id = id;
+        key_bg[k].id = 0xFF;
+        if (id < ANIM_MAX_DEFS)
+            key_t0[k] = anim_key_t0(&anim_defs[id], anim_strip_pos(k), anim_stage.phase[k]);
+    }
+    for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++) {
+        anim_rt[d].elapsed_ticks = 0;
+        if (anim_defs[d].num_kf > 0)
+            anim_prepare_def(d);
+    }
+    anim_stage.state = ANIM_STAGE_IDLE;
+    overlay_clear_all();
+    anim_cleanup_zombies();
+}
+
+/* ── Flash scene store ──────────────────────────────────────────────────
+ * One copy of the live scene in the spare 2KB sector between the macros
+ * (ends 0x0802EFFF) and userpics (0x0802F800) regions, so a wake or USB
+ * re-plug can restore it without the host replaying DEF/ASSIGN packets.
+ * Stock firmware never writes this sector: flash_save_macro derives its
+ * page from macro_id, and the vendor guard keeps macro_id < 50 (page ≤ 6).
+ *
+ * The record is the live tables verbatim, so the sector is read in place
+ * and saving needs no SRAM buffer.  The header goes in last: an erase or
+ * program cut short by power loss leaves no magic and the store reads as
+ * empty.  `layout` is the record size, which changes whenever the engine
+ * tables do, so a store written by another patch build is ignored. */
+#ifndef PATCH_HOST
+#define SCENE_FLASH_ADDR  0x0802F000u
+#endif
+#define SCENE_MAGIC       0x31435341u   /* "ASC1" */
+#define SCENE_F_WAKE      0x01          /* restore on wake and USB connect */
+
+typedef struct {
+    uint32_t magic;
+    uint16_t layout;                        /* sizeof(anim_scene_t) */
+    uint8_t  flags;                         /* SCENE_F_* */
+    uint8_t  pool_top;
+    uint32_t sum;                           /* FNV-1a of the tables below */
+} anim_scene_hdr_t;                         /* 12 bytes */
+
+typedef struct {
+    anim_scene_hdr_t hdr;
+    anim_def_t       defs[ANIM_MAX_DEFS];
+    anim_keyframe_t  pool[ANIM_POOL_KF];
+    key_anim_t       keys[LED_COUNT];
+    uint16_t         t0[LED_COUNT];         /* key_t0 of non-TRIGGER keys */
+} anim_scene_t;                             /* 964 bytes */
+_Static_assert(sizeof(anim_scene_t) <= 2048, "scene record exceeds its flash sector");
+
+#define SCENE_STORE  ((const anim_scene_t *)SCENE_FLASH_ADDR)
+#define SCENE_BODY   sizeof(anim_scene_hdr_t)
+
+static uint8_t scene_restores;   /* scenes restored from flash since boot */
+
+static uint32_t scene_fnv(uint32_t h, const void *p, uint32_t n) {
+    const uint8_t *b = (const uint8_t *)p;
+    while (n--)
+        h = (h ^ *b++) * 16777619u;
+    return h;
+}
+
+/* Checksum of the live tables in record order */
+static uint32_t scene_live_sum(void) {
+    uint32_t h = scene_fnv(2166136261u, anim_defs, sizeof(anim_defs));
+    h = scene_fnv(h, anim_kf_pool, sizeof(anim_kf_pool));
+    h = scene_fnv(h, key_table, sizeof(key_table));
+    return scene_fnv(h, key_t0, sizeof(key_t0));
+}
+
+static int scene_stored(void) {
+    const anim_scene_hdr_t *h = &SCENE_STORE->hdr;
+    return h->magic == SCENE_MAGIC && h->layout == sizeof(anim_scene_t) &&
+           h->sum == scene_fnv(2166136261u, (const uint8_t *)SCENE_STORE + SCENE_BODY,
+                               offsetof(anim_scene_t, t0) + sizeof(key_t0) - SCENE_BODY);
+}
+
+/* Write the live scene to flash.  Defs still waiting on DEF_EXT and keys'
+ * TRIGGER one-shots are transient, so they are dropped from the live scene
+ * first (a key goes back to the def its one-shot displaced), and the pool
+ * is compacted so the record holds only the runs in use.  Returns 1 if written, 0 if flash already held this scene
+ * (a repeated SAVE costs no erase cycle).  Blocks for the sector erase,
+ * like the stock config saves. */
+static int anim_scene_save(uint8_t flags) {
+    for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++)
+        if (anim_defs[d].num_kf == 0)
+            anim_def_release(&anim_defs[d]);
+    for (uint8_t k = 0; k < LED_COUNT; k++) {
+        if (anim_is_trigger(key_table[k].anim_id) && !anim_trigger_end(k))
+            overlay_set(k, 0, 0, 0);
+        if (key_table[k].anim_id >= ANIM_MAX_DEFS)
+            key_t0[k] = 0;
+    }
+    anim_pool_compact();
+
+    anim_scene_hdr_t hdr;
+    hdr.magic = SCENE_MAGIC;
+    hdr.layout = sizeof(anim_scene_t);
+    hdr.flags = flags;
+    hdr.pool_top = anim_pool_top;
+    hdr.sum = scene_live_sum();
+    const anim_scene_hdr_t *old = &SCENE_STORE->hdr;
+    if (scene_stored() && old->sum == hdr.sum && old->flags == flags &&
+        old->pool_top == hdr.pool_top)
+        return 0;
+
+    flash_unlock();
+    flash_erase_sector(SCENE_FLASH_ADDR);
+    flash_program_bytes(SCENE_FLASH_ADDR + offsetof(anim_scene_t, defs),
+                        anim_defs, sizeof(anim_defs));
+    flash_program_bytes(SCENE_FLASH_ADDR + offsetof(anim_scene_t, pool),
+                        anim_kf_pool, sizeof(anim_kf_pool));
+    flash_program_bytes(SCENE_FLASH_ADDR + offsetof(anim_scene_t, keys),
+                        key_table, sizeof(key_table));
+    flash_program_bytes(SCENE_FLASH_ADDR + offsetof(anim_scene_t, t0),
+                        key_t0, sizeof(key_t0));
+    flash_program_bytes(SCENE_FLASH_ADDR, &hdr, SCENE_BODY);
+    flash_lock();
+    return 1;
+}
+
+/* Replace the live scene with the stored one, restarting every def on
+ * this frame as a COMMIT does.  An open or armed stage shares the pool
+ * being overwritten, so it is dropped.  0 if nothing valid is stored. */
+static int anim_scene_load(void) {
+    const anim_scene_t *s = SCENE_STORE;
+    if (!scene_stored())
+        return 0;
+    anim_stage.state = ANIM_STAGE_IDLE;
+    memcpy(anim_defs, (void *)s->defs, sizeof(anim_defs));
+    memcpy(anim_kf_pool, (void *)s->pool, sizeof(anim_kf_pool));
+    anim_pool_top = s->hdr.pool_top;
+    for (uint8_t k = 0; k < LED_COUNT; k++) {
+        key_table[k].anim_id = s->keys[k].anim_id;
+        key_t0[k] = s->t0[k];
+    }
+    for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++) {
+        anim_rt[d].elapsed_ticks = 0;
+        if (anim_defs[d].num_kf > 0)
+            anim_prepare_def(d);
+    }
+    overlay_clear_all();
+    anim_cleanup_zombies();
+    return 1;
+}
+
+/* Wake / connect hook: the stored scene if it asked for it. */
+static int anim_scene_restore(void) {
+    if (!(SCENE_STORE->hdr.flags & SCENE_F_WAKE) || !anim_scene_load())
+        return 0;
+    if (scene_restores < 0xFF)
+        scene_restores++;
+    return 1;
+}
+
+/* Tick the animation engine. Called from led_overlay_memcpy_and_blend
+ * which runs at ~100Hz (LED DMA refresh rate, measured). Each call = 1 tick.
+ * The daemon converts ms→ticks at 10ms/tick to match this rate. */
+static void anim_tick(void) {
+    if (anim_stage.state == ANIM_STAGE_ARMED &&
+        (int32_t)(anim_engine.frame_count - anim_stage.commit_frame) >= 0)
+        anim_stage_apply();
+
+    if (anim_engine.active_count == 0)
+        return;
+
+    /* Advance elapsed for active defs */
+    for (int d = 0; d < ANIM_MAX_DEFS; d++) {
+        if (anim_defs[d].num_kf == 0)
+            continue;
+        anim_rt[d].elapsed_ticks++;
+    }
+
+    anim_eval_slot_t cache[ANIM_EVAL_CACHE_SIZE];
+    for (int c = 0; c < ANIM_EVAL_CACHE_SIZE; c++)
+        cache[c].tag = ANIM_EVAL_TAG_NONE;
+
+    /* Evaluate each assigned key, or one slice of them when the frame
+     * governor is shedding */
+    int step = 1;
+    if (gov.level) {
+        step = gov.div;
+        gov.shed_ticks++;
+    }
+    for (int i = (int)(anim_engine.frame_count % (uint32_t)step); i < LED_COUNT; i += step) {
+        uint8_t def_id = key_table[i].anim_id;
+        if (def_id >= ANIM_MAX_DEFS)
+            continue;
+
+        const anim_def_t *def = &anim_defs[def_id];
+        anim_def_rt_t *rt = &anim_rt[def_id];
+        if (def->num_kf == 0) {
+            key_table[i].anim_id = 0xFF; /* def was cancelled */
+            continue;
+        }
+
+        uint16_t t0 = key_t0[i];
+        uint8_t r, g, b;
+
+        if ((def->flags & ANIM_FLAG_TRIGGER) &&
+            (int16_t)((uint16_t)anim_engine.frame_count - t0) >= (int32_t)def->duration_ticks) {
+            /* One-shot finished: the key resumes the def it displaced,
+             * whose clock kept running meanwhile, or goes dark. */
+            if (!anim_trigger_end((uint8_t)i)) {
+                overlay_set((uint8_t)i, 0, 0, 0);
+                continue;
+            }
+            def_id = key_table[i].anim_id;
+            def = &anim_defs[def_id];
+            rt = &anim_rt[def_id];
+            t0 = key_t0[i];
+        }
+
+        if (def->flags & ANIM_FLAG_TRIGGER) {
+            /* Per-key one-shot from its start frame (press + ripple
+             * delay) */
+            int32_t local_t = (int16_t)((uint16_t)anim_engine.frame_count - t0);
+            if (local_t < 0) {
+                r = 0; g = 0; b = 0;  /* ripple hasn't reached this key */
+            } else {
+                anim_evaluate_cached(cache, def_id, (uint16_t)local_t, &r, &g, &b);
+            }
+        } else if (def->flags & ANIM_FLAG_ONE_SHOT) {
+            int32_t local_t = (int32_t)rt->elapsed_ticks - (int32_t)t0;
+            if (local_t < 0) {
+                r = 0; g = 0; b = 0;  /* not started yet — black */
+            } else if (local_t >= (int32_t)def->duration_ticks) {
+                unpack_rgb565(anim_kf_pool[def->kf_base + def->num_kf - 1].c565, &r, &g, &b);
+            } else {
+                anim_evaluate_cached(cache, def_id, (uint16_t)local_t, &r, &g, &b);
+            }
+        } else {
+            /* Looping */
+            if (def->duration_ticks == 0) {
+                unpack_rgb565(anim_kf_pool[def->kf_base].c565, &r, &g, &b);
+            } else {
+                uint16_t t = anim_mod_duration(def, rt, (uint32_t)rt->elapsed_ticks + t0);
+                anim_evaluate_cached(cache, def_id, t, &r, &g, &b);
+            }
+        }
+
+        overlay_set((uint8_t)i, r, g, b);
+    }
+}
+
+/* ── Audio visualiser (0xE8 pages 0xF9 / 0xFA) ───────────────────────────
+ * The host sends one level per band (page 0xFA, ~20 bytes a frame) and the
+ * blend hook draws a bar per matrix column, bottom row up.  The top cell
+ * of a bar lights in proportion to the remainder, cells ramp from the low
+ * to the high colour, and a peak marker holds at the highest recent level
+ * before it sinks.  Bars rise at once and fall by `decay` per LED frame,
+ * so a 30–60 Hz feed still moves smoothly; decay 0 shows levels as sent.
+ * Unlit cells leave the overlay to anim keys and the base effect. */
+#define VIZ_COLS  16
+#define VIZ_ROWS  (MATRIX_LEN / VIZ_COLS)
+
+static struct {
+    uint8_t  level[VIZ_COLS];   /* bar height, 0-255 = empty-full */
+    uint8_t  peak[VIZ_COLS];    /* peak marker height, same scale */
+    uint8_t  hold[VIZ_COLS];    /* frames before the peak starts to sink */
+    uint16_t c_lo, c_hi;        /* RGB565 ramp, bottom row to top row */
+    uint16_t c_peak;            /* RGB565 peak marker, 0 = none */
+    uint8_t  on;
+    uint8_t  decay;             /* bar fall per frame (0: follow the host) */
+    uint8_t  peak_hold;         /* frames a new peak holds */
+    uint8_t  _pad;
+} viz;                          /* 58 bytes */
+
+static inline uint8_t viz_mix(uint8_t a, uint8_t b, uint32_t t) {
+    return (uint8_t)((int32_t)a + ((((int32_t)b - a) * (int32_t)t) >> 8));
+}
+
+/* Band value v arrived for column c */
+static void viz_set_level(uint8_t c, uint8_t v) {
+    if (v > viz.level[c] || viz.decay == 0)
+        viz.level[c] = v;
+    if (v >= viz.peak[c]) {
+        viz.peak[c] = v;
+        viz.hold[c] = viz.peak_hold;
+    }
+}
+
+/* Black out every cell the visualiser may have drawn, sparing anim keys */
+static void viz_clear(void) {
+    for (uint8_t pos = 0; pos < MATRIX_LEN; pos++) {
+        uint8_t strip_idx = static_led_pos_tbl[pos];
+        if (strip_idx < LED_COUNT && key_table[strip_idx].anim_id == 0xFF)
+            overlay_set(strip_idx, 0, 0, 0);
+    }
+}
+
+static void viz_tick(void) {
+    if (!viz.on)
+        return;
+    uint8_t lo[3], hi[3], pk[3];
+    unpack_rgb565(viz.c_lo, &lo[0], &lo[1], &lo[2]);
+    unpack_rgb565(viz.c_hi, &hi[0], &hi[1], &hi[2]);
+    unpack_rgb565(viz.c_peak, &pk[0], &pk[1], &pk[2]);
+    uint8_t sink = (uint8_t)((viz.decay >> 1) | 1);
+
+    for (uint8_t c = 0; c < VIZ_COLS; c++) {
+        /* Heights in 1/256 cells; 255 fills the column */
+        uint32_t h = (uint32_t)viz.level[c] * VIZ_ROWS;
+        h += h >> 8;
+        uint32_t pr = ((uint32_t)viz.peak[c] * VIZ_ROWS) >> 8;
+        for (uint8_t i = 0; i < VIZ_ROWS; i++) {        /* i = 0: bottom row */
+            uint8_t strip_idx = static_led_pos_tbl[(VIZ_ROWS - 1 - i) * VIZ_COLS + c];
+            if (strip_idx >= LED_COUNT)
+                continue;
+            uint32_t fill = h > i * 256u ? h - i * 256u : 0;
+            if (fill > 255) fill = 255;
+            if (viz.c_peak && viz.peak[c] && i == pr && fill < 255) {
+                overlay_set(strip_idx, pk[0], pk[1], pk[2]);
+            } else if (fill) {
+                uint32_t t = (uint32_t)i * 256 / (VIZ_ROWS - 1);
+                overlay_set(strip_idx,
+                            (uint8_t)((viz_mix(lo[0], hi[0], t) * (fill + 1)) >> 8),
+                            (uint8_t)((viz_mix(lo[1], hi[1], t) * (fill + 1)) >> 8),
+                            (uint8_t)((viz_mix(lo[2], hi[2], t) * (fill + 1)) >> 8));
+            } else if (key_table[strip_idx].anim_id == 0xFF) {
+                overlay_set(strip_idx, 0, 0, 0);
+            }
+        }
+        if (viz.decay)
+            viz.level[c] = viz.level[c] > viz.decay ? viz.level[c] - viz.decay : 0;
+        if (viz.hold[c])
+            viz.hold[c]--;
+        else
+            viz.peak[c] = viz.peak[c] > sink ? viz.peak[c] - sink : 0;
+    }
+}
+
+/* ── WS2812 encoding for SPI scanout ─────────────────────────────────────
+ * Matches firmware ws2812_set_pixel(): each byte expands to 8 SPI bytes;
+ * 1 bit → 0xF0 (long high), 0 bit → 0xC0 (short high). MSB first (byte 0 =
+ * bit 7). Assumes SPI sends MSB of each byte first. Buffer layout per LED:
+ * bytes 0–7 G, 8–15 R, 16–23 B (GRB order for WS2812).
+ *
+ * Word-wide codec: one colour byte = two little-endian u32 words, one per
+ * nibble (high nibble first).  Encode is two table loads + two word stores;
+ * decode gathers bit 4 of the four SPI bytes in a word with one multiply. */
+
+#define WS2812_WORDS_PER_LED  6   /* 24 SPI bytes = 3 colours × 2 words */
+
+/* Nibble → 4 SPI bytes (LE word: byte 0 = nibble bit 3).  64B instead of a
+ * 256 × 8B byte table; kept in SRAM next to the blend pass that reads it. */
+static const uint32_t ws2812_nibble_lut[16] RAMFUNC_RODATA = {
+    0xC0C0C0C0, 0xF0C0C0C0, 0xC0F0C0C0, 0xF0F0C0C0,
+    0xC0C0F0C0, 0xF0C0F0C0, 0xC0F0F0C0, 0xF0F0F0C0,
+    0xC0C0C0F0, 0xF0C0C0F0, 0xC0F0C0F0, 0xF0F0C0F0,
+    0xC0C0F0F0, 0xF0C0F0F0, 0xC0F0F0F0, 0xF0F0F0F0,
+};
+
+static inline __attribute__((always_inline))
+void ws2812_encode(volatile uint32_t *p, uint8_t val) {
+    p[0] = ws2812_nibble_lut[val >> 4];
+    p[1] = ws2812_nibble_lut[val & 0x0F];
+}
+
+/* Decode one SPI word (4 bits) — bit 4 of each byte carries one data bit.
+ * Mask to bits 0/8/16/24, then ×0x08040201 moves them to bits 27..24 with
+ * no carries into the result field. */
+static inline __attribute__((always_inline))
+uint32_t ws2812_decode_nibble(uint32_t w) {
+    return ((((w >> 4) & 0x01010101u) * 0x08040201u) >> 24) & 0x0F;
+}
+
+static inline __attribute__((always_inline))
+uint32_t ws2812_decode(const volatile uint32_t *p) {
+    return (ws2812_decode_nibble(p[0]) << 4) | ws2812_decode_nibble(p[1]);
+}
+
+/* ── Patch discovery (0xE7) ──────────────────────────────────────────────
+ * Response layout in g_vendor_cmd_buffer (buf = cmd_buf):
+ *   buf[3..4] = magic 0xCA 0xFE    → host sees resp[1..2]
+ *   buf[5]    = patch version       → resp[3]
+ *   buf[6..7] = capabilities LE16   → resp[4..5]
  *   buf[8..15]= name (NUL-padded)   → resp[6..13]
  *   buf[16..] = diagnostics         → resp[14..]
  *
@@ -754,13 +2058,22 @@ static void encode_ws2812_byte(volatile uint8_t *p, uint8_t val) {
  *
  * fill_patch_info_response() is used from both the wired path (handle_vendor_cmd
  * → handle_patch_info) and the USB GET_REPORT interception in handle_hid_setup.
+ *
+ * This fixed layout is frozen for existing hosts; new diagnostics go in the
+ * register map (0xE7 sub 0x01 / 0x02, see regmap below) instead.
  */
+#define PATCH_VERSION  1
+/* battery(0) + led_stream(1) + debug_log(2) + consumer_fix(3) + anim_engine(6)
+ * + led_stream_compact(7) + depth_packed(8) + gamepad(9) + telemetry(10)
+ * + regmap(11) + bundle(12) + tagged(13) + scene_store(14) + anim_spatial(15) */
+#define PATCH_CAPS     0xFFCF
+
 static void fill_patch_info_response(volatile uint8_t *buf) {
     buf[3]  = 0xCA;           /* magic hi */
     buf[4]  = 0xFE;           /* magic lo */
-    buf[5]  = 1;              /* patch version */
-    buf[6]  = 0x4F;           /* capabilities: battery(0) + led_stream(1) + debug_log(2) + consumer_fix(3) + anim_engine(6) */
-    buf[7]  = 0x00;           /* capabilities hi */
+    buf[5]  = PATCH_VERSION;
+    buf[6]  = (uint8_t)PATCH_CAPS;
+    buf[7]  = (uint8_t)(PATCH_CAPS >> 8);
     buf[8]  = 'M';
     buf[9]  = 'O';
     buf[10] = 'N';
@@ -812,19 +2125,594 @@ static void fill_patch_info_response(volatile uint8_t *buf) {
     buf[45] = (uint8_t)((*adc_s0 >> 8) & 0xFF);
 
     /* GPIOC IDR (charger detect pin 13) and GPIOB IDR (charge complete pin 10) */
-    volatile uint32_t *gpioc_idr = (volatile uint32_t *)0x40020810;
-    volatile uint32_t *gpiob_idr = (volatile uint32_t *)0x40020410;
+    volatile uint32_t *gpioc_idr = &MMIO32(0x40020810);
+    volatile uint32_t *gpiob_idr = &MMIO32(0x40020410);
     uint32_t gc = *gpioc_idr;
     uint32_t gb = *gpiob_idr;
     buf[46] = (uint8_t)(gc & 0xFF);
     buf[47] = (uint8_t)((gc >> 8) & 0xFF);
     buf[48] = (uint8_t)(gb & 0xFF);
     buf[49] = (uint8_t)((gb >> 8) & 0xFF);
+
+    /* Compact LED stream health */
+    buf[50] = (uint8_t)(led_stream.stale_drops & 0xFF);
+    buf[51] = (uint8_t)(led_stream.stale_drops >> 8);
+    buf[52] = (uint8_t)(led_stream.delta_misses & 0xFF);
+    buf[53] = (uint8_t)(led_stream.delta_misses >> 8);
+}
+
+static int handle_patch_info(volatile uint8_t *buf) {
+    if (buf[3] == REGMAP_DIR || buf[3] == REGMAP_READ)
+        return handle_regmap(buf);
+    fill_patch_info_response(buf);
+    buf[0] = 0;   /* mark consumed */
+    return 1;
+}
+
+/* 0xEB: hook profile.
+ *   sub 0x00 READ:  buf[4] = hook id → buf[3] = 0x00 (echo), buf[4] = hook id,
+ *                   buf[5] = PROF_NUM_HOOKS, buf[6..9] count, buf[10..13] min,
+ *                   buf[14..17] max, buf[18..25] total (u64), buf[26..41]
+ *                   hist (8 × u16), buf[42..45] CYCCNT now, buf[46..47]
+ *                   RTT stream drops; all LE
+ *   sub 0x01 RESET: zero all slots, latency included
+ *   sub 0x02 RTT:   buf[4..5] = LED frames between RTT dumps (0 = off)
+ *   sub 0x03 STREAM: buf[4] = STREAM_* flags (0 = off), buf[5] = decimation,
+ *                   buf[6..9] = mag key indices for ADC records (0xFF = unused)
+ *   sub 0x04 LATENCY: buf[4] = LAT_* mode → READ layout with buf[4] = mode,
+ *                   buf[5] = LAT_NUM_MODES, histogram bins LAT_HIST_SHIFT
+ *                   wide, buf[46..47] = stale edges (shared by all modes)
+ *   sub 0x05 GOVERNOR: buf[4..7] = loop budget in cycles (0 = off),
+ *                   buf[8] = anim_tick slices when shedding (< 2: default);
+ *                   restarts at level 0 with its counters zeroed
+ *   sub 0x06 BENCH: PATCH_BENCH builds only, see handle_bench_cmd */
+/* Serialise one slot as 36 bytes: count, min, max, total (u64), hist. */
+static void prof_slot_put(volatile uint8_t *dst, const prof_slot_t *p) {
+    put_le32(&dst[0],  p->count);
+    put_le32(&dst[4],  p->min_cyc);
+    put_le32(&dst[8],  p->max_cyc);
+    put_le32(&dst[12], p->total_lo);
+    put_le32(&dst[16], p->total_hi);
+    for (uint8_t i = 0; i < PROF_HIST_BINS; i++) {
+        dst[20 + i * 2] = (uint8_t)p->hist[i];
+        dst[21 + i * 2] = (uint8_t)(p->hist[i] >> 8);
+    }
+}
+
+static int handle_prof_cmd(volatile uint8_t *buf) {
+    uint8_t sub = buf[3];
+
+    if (sub == 0x00 || sub == 0x04) {
+        uint8_t id = buf[4];
+        uint16_t drops;
+        if (sub == 0x00) {
+            if (id >= PROF_NUM_HOOKS) id = 0;
+            prof_slot_put(&buf[6], &prof_slots[id]);
+            buf[5] = PROF_NUM_HOOKS;
+            drops = rtt_stream.drops;
+        } else {
+            if (id >= LAT_NUM_MODES) id = 0;
+            prof_slot_put(&buf[6], &lat_slots[id]);
+            buf[5] = LAT_NUM_MODES;
+            drops = lat_stale;
+        }
+        put_le32(&buf[42], DWT_CYCCNT);
+        buf[4] = id;
+        buf[46] = (uint8_t)drops;
+        buf[47] = (uint8_t)(drops >> 8);
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0x01) {
+        for (uint8_t *b = (uint8_t *)prof_slots; b < (uint8_t *)(prof_slots + PROF_NUM_HOOKS); b++)
+            *b = 0;
+        for (uint8_t *b = (uint8_t *)lat_slots; b < (uint8_t *)(lat_slots + LAT_NUM_MODES); b++)
+            *b = 0;
+        lat_armed = 0;
+        lat_stale = 0;
+        gov.max_period = 0;
+        gov.over = gov.shed_ticks = gov.shed_blends = 0;
+    } else if (sub == 0x02) {
+        prof_rtt_period = (uint16_t)(buf[4] | ((uint16_t)buf[5] << 8));
+        prof_rtt_ctr = 0;
+    } else if (sub == 0x03) {
+        rtt_stream.flags = 0;       /* quiesce while reconfiguring */
+        rtt_stream.decim = buf[5];
+        rtt_stream.ctr = 0;
+        for (uint8_t i = 0; i < STREAM_MAX_KEYS; i++)
+            rtt_stream.keys[i] = buf[6 + i];
+        rtt_stream.drops = 0;
+        rtt_stream.last_scan = prof_begin();
+        rtt_stream.flags = buf[4];
+    } else if (sub == 0x05) {
+        gov.budget = 0;             /* quiesce while reconfiguring */
+        gov.div = buf[8] < 2 ? GOV_DIV_DEFAULT : buf[8];
+        gov.level = gov.calm = gov.skip = 0;
+        gov.period = gov.max_period = 0;
+        gov.over = gov.shed_ticks = gov.shed_blends = 0;
+        gov.budget = buf[4] | (uint32_t)buf[5] << 8 |
+                     (uint32_t)buf[6] << 16 | (uint32_t)buf[7] << 24;
+#ifdef PATCH_BENCH
+    } else if (sub == 0x06) {
+        return handle_bench_cmd(buf);
+#endif
+    } else {
+        return 0;
+    }
+    buf[0] = 0;
+    buf[3] = 0;  /* clear sub-echo area, as in handle_anim_cmd */
+    return 1;
+}
+
+/* 0xEC: packed depth frames.
+ *   sub 0x00 READ:   buf[3] = 0x00 (echo), buf[4] = mode, buf[5] = next seq,
+ *                    buf[6] = pending keys, buf[7..8] = overflow (u16),
+ *                    buf[9..12] = frames sent (u32), buf[13] = filter active,
+ *                    buf[14..15] = deadband, buf[16..19] = min cycles
+ *                    between reports; all LE
+ *   sub 0x01 MODE:   buf[4] = DEPTH_MODE_* (0 = stock reports); any write
+ *                    restarts seq at 0 with every key's base at 0
+ *   sub 0x02 FILTER: buf[4..19] = subscription mask (bit k = key k, all
+ *                    ones = every key), buf[20..21] = deadband,
+ *                    buf[22..23] = max reports/frames per second (0 = no
+ *                    cap); all-ones mask with 0 / 0 turns the filter off */
+static int handle_depth_cmd(volatile uint8_t *buf) {
+    uint8_t sub = buf[3];
+
+    if (sub == 0x00) {
+        buf[4] = depth_pack.mode;
+        buf[5] = depth_pack.seq;
+        buf[6] = depth_pack.npend;
+        buf[7] = (uint8_t)depth_pack.overflow;
+        buf[8] = (uint8_t)(depth_pack.overflow >> 8);
+        put_le32(&buf[9], depth_pack.frames);
+        buf[13] = depth_filter.active;
+        buf[14] = (uint8_t)depth_filter.deadband;
+        buf[15] = (uint8_t)(depth_filter.deadband >> 8);
+        put_le32(&buf[16], depth_filter.min_cycles);
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0x01) {
+        depth_pack_reset(buf[4] & DEPTH_MODE_PACKED);
+    } else if (sub == 0x02) {
+        uint8_t any_skip = 0;
+        for (uint8_t i = 0; i < 16; i++) {
+            uint8_t m = buf[4 + i];
+            if (i == 15)
+                m |= 0xC0;              /* bits 126/127: no such key */
+            depth_filter.skip[i] = (uint8_t)~m;
+            any_skip |= (uint8_t)~m;
+        }
+        depth_filter.deadband = (uint16_t)(buf[20] | ((uint16_t)buf[21] << 8));
+        uint16_t hz = (uint16_t)(buf[22] | ((uint16_t)buf[23] << 8));
+        depth_filter.min_cycles = hz ? DEPTH_CYCLES_PER_SEC / hz : 0;
+        depth_filter.active = any_skip || depth_filter.deadband || hz;
+        /* Anything queued for keys just unsubscribed is dropped. */
+        for (uint8_t i = 0; i < depth_pack.npend; ) {
+            uint8_t k = depth_pack.pend_key[i];
+            if (depth_filter.skip[k >> 3] & (1u << (k & 7)))
+                depth_pend_remove(i, 1);
+            else
+                i++;
+        }
+    } else {
+        return 0;
+    }
+    buf[0] = 0;
+    buf[3] = 0;
+    return 1;
+}
+
+/* 0xED: gamepad axes.
+ *   sub 0x00 READ: buf[3] = 0x00 (echo), buf[4..9] = axis keys, buf[10] =
+ *                  invert mask, buf[11..22] = last axis values sent (u16 LE)
+ *   sub 0x01 SET:  buf[4..9] = mag key per axis X, Y, Z, Rx, Ry, Rz (0xFF =
+ *                  unused; all unused stops reports), buf[10] = invert mask */
+static int handle_gamepad_cmd(volatile uint8_t *buf) {
+    uint8_t sub = buf[3];
+
+    if (sub == 0x00) {
+        for (uint8_t a = 0; a < GAMEPAD_AXES; a++)
+            buf[4 + a] = gamepad.key[a];
+        buf[10] = gamepad.invert;
+        for (uint8_t i = 0; i < GAMEPAD_AXES * 2; i++)
+            buf[11 + i] = gamepad.report[1 + i];
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0x01) {
+        gamepad.active = 0;
+        for (uint8_t a = 0; a < GAMEPAD_AXES; a++) {
+            uint8_t k = buf[4 + a];
+            gamepad.key[a] = k < MAG_KEY_COUNT ? k : 0xFF;
+            gamepad.active |= k < MAG_KEY_COUNT;
+        }
+        gamepad.invert = buf[10] & ((1u << GAMEPAD_AXES) - 1);
+        /* Force a report on the next scan so the host sees the new layout. */
+        for (uint8_t i = 1; i < sizeof(gamepad.report); i++)
+            gamepad.report[i] = 0xFF;
+    } else {
+        return 0;
+    }
+    buf[0] = 0;
+    buf[3] = 0;
+    return 1;
+}
+
+/* ── Push telemetry (0xEE) ────────────────────────────────────────────
+ *
+ * Instead of polling 0xE7 for battery state, the host subscribes to a set of
+ * fields once and gets a record whenever one of them moves past its
+ * threshold.  Records go through the stock vendor report buffer
+ * (g_conn_state_buf + pending bit 0x10), like the capped depth path, so they
+ * reach the host on USB EP2 and through the dongle on 2.4G / BT alike:
+ *
+ *   [0x05][0x1E][seq][changed][battery][charger][charge_status]
+ *   [adc_lo][adc_hi][power]
+ *
+ * `changed` holds the TELEM_* bits that triggered the record; every record
+ * carries all four current values.  A dirty record waits in `telem` until
+ * the report slot is free, so only the newest values are ever sent.  Its
+ * bits stay queued until the slot is seen sent with the record still in it;
+ * if anything else rewrote the buffer first, they go back to dirty. */
+#define TELEM_BATTERY   0x01   /* battery level (%) */
+#define TELEM_CHARGER   0x02   /* charger_connected + charge_status */
+#define TELEM_ADC_AVG   0x04   /* averaged battery ADC reading */
+#define TELEM_POWER     0x08   /* power transition (PWR_STATE_*) */
+#define TELEM_ALL       0x0F
+
+static struct {
+    uint8_t  fields;           /* subscribed TELEM_* mask, 0 = off */
+    uint8_t  bat_thresh;       /* min battery delta (%) to report */
+    uint16_t adc_thresh;       /* min ADC average delta to report */
+    uint8_t  dirty;            /* TELEM_* bits waiting for the report slot */
+    uint8_t  queued;           /* TELEM_* bits of the record in the slot */
+    uint8_t  seq;
+    uint8_t  battery, charger, charge_status, power;  /* last reported */
+    uint16_t adc;
+} telem;
+
+/* Once the slot has gone out, drop the queued bits if the record was still
+ * in it, otherwise mark them dirty again. */
+static void telem_settle(void) {
+    volatile hid_report_state_t *rpt =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    volatile uint8_t *b = (volatile uint8_t *)&g_conn_state_buf;
+    if (!telem.queued || (rpt->pending_reports_bitmap & DEPTH_PENDING_BIT))
+        return;
+    if (b[1] != 0x1E || b[2] != telem.seq)
+        telem.dirty |= telem.queued;   /* overwritten before it went out */
+    telem.queued = 0;
+}
+
+static uint8_t telem_delta(uint32_t a, uint32_t b, uint32_t thresh) {
+    uint32_t d = a > b ? a - b : b - a;
+    return d != 0 && d >= thresh;
+}
+
+/* Called from the blend hook every frame and on each power transition. */
+static void telem_poll(void) {
+    if (!telem.fields)
+        return;
+    volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
+    uint8_t level = kbd->battery_level;
+    uint8_t chg = kbd->charger_connected, cst = kbd->charge_status;
+    uint16_t adc = (uint16_t)ADC_BATTERY_AVG;
+
+    uint8_t d = 0;
+    if (telem_delta(level, telem.battery, telem.bat_thresh))
+        d |= TELEM_BATTERY;
+    if (chg != telem.charger || cst != telem.charge_status)
+        d |= TELEM_CHARGER;
+    if (telem_delta(adc, telem.adc, telem.adc_thresh))
+        d |= TELEM_ADC_AVG;
+    if (power_state != telem.power)
+        d |= TELEM_POWER;
+    d &= telem.fields;
+    if (d & TELEM_BATTERY)
+        telem.battery = level;
+    if (d & TELEM_CHARGER) {
+        telem.charger = chg;
+        telem.charge_status = cst;
+    }
+    if (d & TELEM_ADC_AVG)
+        telem.adc = adc;
+    if (d & TELEM_POWER)
+        telem.power = power_state;
+    telem.dirty |= d;
+
+    telem_settle();
+    volatile hid_report_state_t *rpt =
+        (volatile hid_report_state_t *)&g_hid_report_pending_flags;
+    if (!telem.dirty || (rpt->pending_reports_bitmap & DEPTH_PENDING_BIT))
+        return;
+
+    volatile uint8_t *b = (volatile uint8_t *)&g_conn_state_buf;
+    b[0] = 0x05;
+    b[1] = 0x1E;
+    b[2] = ++telem.seq;
+    b[3] = telem.dirty;
+    b[4] = telem.battery;
+    b[5] = telem.charger;
+    b[6] = telem.charge_status;
+    b[7] = (uint8_t)telem.adc;
+    b[8] = (uint8_t)(telem.adc >> 8);
+    b[9] = telem.power;
+    for (uint8_t i = 10; i < 32; i++)
+        b[i] = 0;
+    rpt->pending_reports_bitmap |= DEPTH_PENDING_BIT;
+    telem.queued = telem.dirty;
+    telem.dirty = 0;
+}
+
+/* True while a telemetry record waits in the stock report buffer. */
+static int telem_holds_slot(void) {
+    return telem.queued &&
+           (((volatile hid_report_state_t *)&g_hid_report_pending_flags)
+                ->pending_reports_bitmap & DEPTH_PENDING_BIT);
+}
+
+/* 0xEE: push telemetry.
+ *   sub 0x00 READ:      buf[3] = 0x00 (echo), buf[4] = fields, buf[5] =
+ *                       battery threshold, buf[6..7] = ADC threshold (u16 LE),
+ *                       buf[8] = seq, buf[9..14] = last reported battery,
+ *                       charger, charge_status, ADC avg (u16 LE), power
+ *   sub 0x01 SUBSCRIBE: buf[4] = TELEM_* fields (0 = off), buf[5] = battery
+ *                       threshold (%), buf[6..7] = ADC threshold (u16 LE);
+ *                       0 thresholds report any change.  A full record
+ *                       follows right away as the baseline. */
+static int handle_telem_cmd(volatile uint8_t *buf) {
+    uint8_t sub = buf[3];
+
+    if (sub == 0x00) {
+        buf[4] = telem.fields;
+        buf[5] = telem.bat_thresh;
+        buf[6] = (uint8_t)telem.adc_thresh;
+        buf[7] = (uint8_t)(telem.adc_thresh >> 8);
+        buf[8] = telem.seq;
+        buf[9] = telem.battery;
+        buf[10] = telem.charger;
+        buf[11] = telem.charge_status;
+        buf[12] = (uint8_t)telem.adc;
+        buf[13] = (uint8_t)(telem.adc >> 8);
+        buf[14] = telem.power;
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0x01) {
+        volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
+        telem.fields = buf[4] & TELEM_ALL;
+        telem.bat_thresh = buf[5];
+        telem.adc_thresh = (uint16_t)(buf[6] | (buf[7] << 8));
+        telem.battery = kbd->battery_level;
+        telem.charger = kbd->charger_connected;
+        telem.charge_status = kbd->charge_status;
+        telem.adc = (uint16_t)ADC_BATTERY_AVG;
+        telem.power = power_state;
+        telem.dirty = telem.fields;
+    } else {
+        return 0;
+    }
+    buf[0] = 0;
+    buf[3] = 0;
+    return 1;
+}
+
+/* ── Register map (0xE7 sub 0x01 / 0x02) ─────────────────────────────────
+ *
+ * Versioned replacement for the fixed 0xE7 diagnostics blob.  The host reads
+ * the directory once (id + length of every register), then fetches only the
+ * registers it wants as TLV records.  Registers only ever grow at the end
+ * and new ones get new ids, so an old host keeps parsing a newer patch.
+ *
+ *   sub 0x01 DIR:  buf[4] = first index →
+ *                  buf[3] = 0x01 (echo), buf[4] = REGMAP_VERSION,
+ *                  buf[5] = patch version, buf[6..7] = capabilities,
+ *                  buf[8] = register count, buf[9] = first index,
+ *                  buf[10] = n, buf[11..] = n × [id, len]
+ *   sub 0x02 READ: buf[4..] = register ids, 0 ends the list →
+ *                  buf[3] = 0x02 (echo), buf[4] = REGMAP_VERSION,
+ *                  buf[5..] = [id][len][value × len] per register, 0 ends.
+ *                  Unknown ids come back with len 0; ids that no longer
+ *                  fit are left out, so the host asks again for the rest.
+ * All values are little-endian. */
+#define REGMAP_VERSION   1
+#define REGMAP_BUF_END   64     /* last usable response byte + 1 */
+#define REGMAP_MAX_IDS   16
+
+#define REG_DIAG         0x01   /* HID setup stats, drop counters, CYCCNT */
+#define REG_BATTERY      0x02   /* raw kbd_state battery fields + ADC */
+#define REG_LED_STREAM   0x03   /* compact stream sequencing health */
+#define REG_ANIM         0x04   /* animation engine state */
+#define REG_DEPTH        0x05   /* packed depth counters */
+#define REG_TELEM        0x06   /* push telemetry subscription */
+#define REG_TAGGED       0x07   /* tagged completion queue */
+#define REG_GOV          0x08   /* frame-budget governor */
+#define REG_PROF_BASE    0x10   /* + hook: hook profiler slot */
+#define REG_LAT_BASE     0x20   /* + LAT_* mode: scan-to-report latency */
+
+static void reg_diag(volatile uint8_t *d, uint8_t i) {
+    put_le32(&d[0], diag.hid_setup_calls);
+    put_le32(&d[4], diag.hid_setup_intercepts);
+    d[8]  = diag.last_bmReqType;
+    d[9]  = diag.last_bRequest;
+    d[10] = (uint8_t)diag.last_wValue;
+    d[11] = (uint8_t)(diag.last_wValue >> 8);
+    d[12] = (uint8_t)diag.last_wIndex;
+    d[13] = (uint8_t)(diag.last_wIndex >> 8);
+    d[14] = (uint8_t)diag.last_wLength;
+    d[15] = (uint8_t)(diag.last_wLength >> 8);
+    d[16] = diag.last_battery_level;
+    d[17] = diag.last_result;
+    d[18] = (uint8_t)rtt_stream.drops;
+    d[19] = (uint8_t)(rtt_stream.drops >> 8);
+    d[20] = (uint8_t)lat_stale;
+    d[21] = (uint8_t)(lat_stale >> 8);
+    put_le32(&d[22], DWT_CYCCNT);
+}
+
+static void reg_battery(volatile uint8_t *d, uint8_t i) {
+    volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
+    d[0] = kbd->battery_level;
+    d[1] = kbd->charger_connected;
+    d[2] = kbd->charger_debounce_ctr;
+    d[3] = kbd->battery_update_ctr;
+    d[4] = kbd->battery_raw_level;
+    d[5] = kbd->charge_status;
+    d[6] = *(volatile uint8_t *)&g_connection_mode;
+    /* bit 0: charger detect (PC13), bit 1: charge complete (PB10) */
+    d[7] = (uint8_t)(((MMIO32(0x40020810) >> 13) & 1) |
+                     ((MMIO32(0x40020410) >> 9) & 2));
+    uint32_t avg = ADC_BATTERY_AVG;
+    uint16_t raw = *(volatile uint16_t *)&ADC_RAW_SAMPLE;
+    d[8]  = (uint8_t)avg;
+    d[9]  = (uint8_t)(avg >> 8);
+    d[10] = (uint8_t)raw;
+    d[11] = (uint8_t)(raw >> 8);
+    put_le32(&d[12], ADC_SCAN_COUNTER);
+}
+
+static void reg_led_stream(volatile uint8_t *d, uint8_t i) {
+    d[0] = led_stream.seq;
+    d[1] = led_stream.synced;
+    d[2] = (uint8_t)led_stream.stale_drops;
+    d[3] = (uint8_t)(led_stream.stale_drops >> 8);
+    d[4] = (uint8_t)led_stream.delta_misses;
+    d[5] = (uint8_t)(led_stream.delta_misses >> 8);
+}
+
+static void reg_anim(volatile uint8_t *d, uint8_t i) {
+    uint8_t keys = 0;
+    for (uint8_t k = 0; k < LED_COUNT; k++)
+        keys += key_table[k].anim_id != 0xFF;
+    put_le32(&d[0], anim_engine.frame_count);
+    d[4] = anim_engine.active_count;
+    d[5] = keys;
+    d[6] = anim_stage.state;
+    put_le32(&d[7], anim_stage.commit_frame);
+}
+
+static void reg_depth(volatile uint8_t *d, uint8_t i) {
+    d[0] = depth_pack.mode;
+    d[1] = depth_pack.seq;
+    d[2] = depth_pack.npend;
+    d[3] = depth_filter.active;
+    d[4] = (uint8_t)depth_pack.overflow;
+    d[5] = (uint8_t)(depth_pack.overflow >> 8);
+    put_le32(&d[6], depth_pack.frames);
+}
+
+static void reg_telem(volatile uint8_t *d, uint8_t i) {
+    d[0] = telem.fields;
+    d[1] = telem.seq;
+    d[2] = telem.dirty | telem.queued;
+}
+
+static void reg_tagged(volatile uint8_t *d, uint8_t i) {
+    d[0] = tag_mbox.count;
+    d[1] = tag_mbox.head;
+    d[2] = (uint8_t)tag_mbox.drops;
+    d[3] = (uint8_t)(tag_mbox.drops >> 8);
+}
+
+static void reg_gov(volatile uint8_t *d, uint8_t i) {
+    put_le32(&d[0],  gov.budget);
+    put_le32(&d[4],  gov.period);
+    put_le32(&d[8],  gov.max_period);
+    put_le32(&d[12], gov.over);
+    put_le32(&d[16], gov.shed_ticks);
+    put_le32(&d[20], gov.shed_blends);
+    d[24] = gov.div;
+    d[25] = gov.level;
+}
+
+static void reg_prof(volatile uint8_t *d, uint8_t i) {
+    prof_slot_put(d, &prof_slots[i]);
+}
+
+static void reg_lat(volatile uint8_t *d, uint8_t i) {
+    prof_slot_put(d, &lat_slots[i]);
+}
+
+/* `count` consecutive ids starting at `id`; fill() gets the index. */
+typedef struct {
+    uint8_t id, count, len;
+    void (*fill)(volatile uint8_t *dst, uint8_t idx);
+} reg_desc_t;
+
+static const reg_desc_t regmap[] = {
+    { REG_DIAG,       1,              26, reg_diag },
+    { REG_BATTERY,    1,              16, reg_battery },
+    { REG_LED_STREAM, 1,               6, reg_led_stream },
+    { REG_ANIM,       1,              11, reg_anim },
+    { REG_DEPTH,      1,              10, reg_depth },
+    { REG_TELEM,      1,               3, reg_telem },
+    { REG_TAGGED,     1,               4, reg_tagged },
+    { REG_GOV,        1,              26, reg_gov },
+    { REG_PROF_BASE,  PROF_NUM_HOOKS, 36, reg_prof },
+    { REG_LAT_BASE,   LAT_NUM_MODES,  36, reg_lat },
+};
+#define REGMAP_DESCS (sizeof(regmap) / sizeof(regmap[0]))
+
+static const reg_desc_t *regmap_find(uint8_t id, uint8_t *idx) {
+    for (uint8_t r = 0; r < REGMAP_DESCS; r++) {
+        if (id >= regmap[r].id && id - regmap[r].id < regmap[r].count) {
+            *idx = id - regmap[r].id;
+            return &regmap[r];
+        }
+    }
+    return 0;
 }
 
-static int handle_patch_info(volatile uint8_t *buf) {
-    fill_patch_info_response(buf);
-    buf[0] = 0;   /* mark consumed */
+static int handle_regmap(volatile uint8_t *buf) {
+    if (buf[3] == REGMAP_DIR) {
+        uint8_t first = buf[4], total = 0, n = 0, pos = 11;
+        for (uint8_t r = 0; r < REGMAP_DESCS; r++) {
+            for (uint8_t k = 0; k < regmap[r].count; k++, total++) {
+                if (total < first || pos + 2 > REGMAP_BUF_END)
+                    continue;
+                buf[pos++] = regmap[r].id + k;
+                buf[pos++] = regmap[r].len;
+                n++;
+            }
+        }
+        buf[4]  = REGMAP_VERSION;
+        buf[5]  = PATCH_VERSION;
+        buf[6]  = (uint8_t)PATCH_CAPS;
+        buf[7]  = (uint8_t)(PATCH_CAPS >> 8);
+        buf[8]  = total;
+        buf[9]  = first;
+        buf[10] = n;
+        while (pos < REGMAP_BUF_END)
+            buf[pos++] = 0;
+    } else {
+        uint8_t ids[REGMAP_MAX_IDS], nids = 0;
+        while (nids < REGMAP_MAX_IDS && buf[4 + nids])
+            ids[nids] = buf[4 + nids], nids++;
+
+        uint8_t pos = 5;
+        for (uint8_t j = 0; j < nids; j++) {
+            uint8_t idx = 0;
+            const reg_desc_t *r = regmap_find(ids[j], &idx);
+            uint8_t len = r ? r->len : 0;
+            if (pos + 2 + len > REGMAP_BUF_END)
+                continue;
+            buf[pos] = ids[j];
+            buf[pos + 1] = len;
+            if (r)
+                r->fill(&buf[pos + 2], idx);
+            pos += 2 + len;
+        }
+        buf[4] = REGMAP_VERSION;
+        while (pos < REGMAP_BUF_END)
+            buf[pos++] = 0;
+    }
+    buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
     return 1;
 }
 
@@ -847,24 +2735,46 @@ static int handle_patch_info(volatile uint8_t *buf) {
  * 0xFF = no LED (gap for wide keys / empty slots). */
 
 /* Per-LED RGB overlay: additive, saturating. 0 = no overlay for that channel.
- * overlay_buf and overlay_active defined above (near anim structs) for
+ * overlay_buf and overlay_mask defined above (near anim structs) for
  * visibility to both anim_tick() and led_overlay_memcpy_and_blend(). */
 
-/* Decode one color byte from WS2812 SPI encoding (8 SPI bytes → 1 data byte).
- * Each SPI byte's bit 4 carries one data bit (0xF0 → 1, 0xC0 → 0). */
-static inline uint8_t decode_ws2812_byte(volatile uint8_t *p) {
-    return ((p[0] & 0x10) << 3) | ((p[1] & 0x10) << 2) |
-           ((p[2] & 0x10) << 1) | ((p[3] & 0x10)     ) |
-           ((p[4] & 0x10) >> 1) | ((p[5] & 0x10) >> 2) |
-           ((p[6] & 0x10) >> 3) | ((p[7] & 0x10) >> 4);
+/* Walk lit LEDs only: copy the untouched run before each one with the
+ * stock (word-optimised) memcpy, then blend that LED in place.  Runs from
+ * SRAM: this is the one loop every LED frame executes. */
+RAMFUNC static void overlay_blend_lit(volatile uint32_t *d, const volatile uint32_t *s) {
+    uint32_t next = 0;   /* first LED not yet written to dst */
+    for (int w = 0; w < OVERLAY_MASK_WORDS; w++) {
+        uint32_t bits = overlay_mask[w];
+        while (bits) {
+            uint32_t i = (uint32_t)w * 32 + (uint32_t)__builtin_ctz(bits);
+            bits &= bits - 1;
+
+            if (i > next)
+                memcpy((void *)&d[next * WS2812_WORDS_PER_LED],
+                       (void *)&s[next * WS2812_WORDS_PER_LED],
+                       (i - next) * WS2812_WORDS_PER_LED * 4);
+            next = i + 1;
+
+            /* Decode GRB from the frame, add overlay RGB (saturating),
+             * encode.  A channel loop, not unrolled: SRAM is scarcer than
+             * the cycles it would save. */
+            const uint8_t *ov = &overlay_buf[i * 3];
+            const volatile uint32_t *sp = &s[i * WS2812_WORDS_PER_LED];
+            volatile uint32_t *dp = &d[i * WS2812_WORDS_PER_LED];
+            for (uint32_t c = 0; c < 3; c++) {      /* wire order G, R, B */
+                uint32_t v = ws2812_decode(sp + 2 * c) + ov[c < 2 ? c ^ 1 : c];
+                if (v > 255) v = 255;
+                ws2812_encode(dp + 2 * c, (uint8_t)v);
+            }
+        }
+    }
+    if (next < LED_COUNT)
+        memcpy((void *)&d[next * WS2812_WORDS_PER_LED],
+               (void *)&s[next * WS2812_WORDS_PER_LED],
+               (LED_COUNT - next) * WS2812_WORDS_PER_LED * 4);
 }
 
-/* Replacement for firmware's memcpy(dma_buf, frame_buf, 0x7b0) at 0x080161a8.
- * Called every scan cycle after led_render_frame writes to g_led_frame_buf.
- * Copies frame→DMA then applies the additive overlay. */
-void led_overlay_memcpy_and_blend(void *dst, const void *src, uint32_t len) {
-    memcpy(dst, src, len);
-
+static void overlay_blend_frame(void *dst, const void *src, uint32_t len) {
     /* Count frames (monotonic, for sync) */
     anim_engine.frame_count++;
 
@@ -885,54 +2795,288 @@ void led_overlay_memcpy_and_blend(void *dst, const void *src, uint32_t len) {
      * when it's about to enter its blocking loop.  When it returns and
      * this blend hook runs, sleeping_flag is still 1 → we detect wake.
      *
-     * Events sent via EP2 immediately (USB) and queued for
-     * handle_vendor_cmd (wireless, next RF command from dongle). */
+     * Events go through the EP2 mailbox, which also drains here every
+     * cycle; battery level / charge changes are posted to it as well. */
     {
         if (sleeping_flag != 0) {
             /* wireless_sleep_loop (or usb_suspend_handler) just returned.
              * Reset animation engine — firmware may have reconfigured LEDs
-             * and our BSS statics survived but are stale. */
+             * and our BSS statics survived but are stale — to the flash
+             * scene if one was saved for wake, else to idle. */
             sleeping_flag = 0;
-            for (int i = 0; i < LED_COUNT; i++)
-                key_table[i].anim_id = 0xFF;
-            anim_engine.active_count = 0;
-            overlay_active = 0;
-            pending_power_event = PWR_STATE_WAKE;
+            if (!anim_scene_restore()) {
+                for (int i = 0; i < LED_COUNT; i++)
+                    key_table[i].anim_id = 0xFF;
+                anim_engine.active_count = 0;
+                overlay_clear_all();
+            }
             send_power_state(PWR_STATE_WAKE);
         }
+        mbox_post_battery();
+        mbox_drain();
+        telem_poll();
     }
 
-    /* Tick the animation engine */
-    anim_tick();
+    /* Tick the animation engine and visualiser (they write overlay_buf
+     * only; the frame buffer is read below, so ticking before the copy is
+     * equivalent). */
+    {
+        uint32_t t0 = prof_begin();
+        anim_tick();
+        viz_tick();
+        prof_end(PROF_ANIM_TICK, t0);
+    }
+    prof_rtt_tick();
 
-    if (!overlay_active)
+    /* Over the frame budget: keep the previous frame in the DMA buffer */
+    if (gov.skip && overlay_active() && len == LED_BUF_SIZE) {
+        gov.shed_blends++;
         return;
+    }
 
-    volatile uint8_t *dma = (volatile uint8_t *)dst;
-    for (int i = 0; i < LED_COUNT; i++) {
-        uint8_t *ov = &overlay_buf[i * 3];
-        if (ov[0] == 0 && ov[1] == 0 && ov[2] == 0)
-            continue;
+    /* Idle, or not the LED frame copy we were patched over (unexpected
+     * length / alignment): behave exactly like the stock memcpy. */
+    if (!overlay_active() || len != LED_BUF_SIZE ||
+        (((uintptr_t)dst | (uintptr_t)src) & 3) != 0) {
+        memcpy(dst, (void *)src, len);
+        return;
+    }
+    overlay_blend_lit((volatile uint32_t *)dst, (const volatile uint32_t *)src);
+}
+
+/* Replacement for firmware's memcpy(dma_buf, frame_buf, 0x7b0) at 0x080161a8.
+ * Called every scan cycle after led_render_frame writes to g_led_frame_buf.
+ * Copies frame→DMA and applies the additive overlay in a single fused pass:
+ * untouched runs go through the stock memcpy, overlaid LEDs are decoded
+ * from the frame buffer, blended and encoded straight into the DMA buffer. */
+void led_overlay_memcpy_and_blend(void *dst, const void *src, uint32_t len) {
+    uint32_t t0 = prof_begin();
+    gov_update(t0);
+    overlay_blend_frame(dst, src, len);
+    prof_end(PROF_BLEND, t0);
+}
+
+/* ── Kernel bench (PATCH_BENCH builds and the host harness) ──────────────
+ * One repetition of a hot-path kernel, returning an FNV-1a hash of what it
+ * produced, so timing and bit-exact output checks share one definition.
+ * The host harness (2949-v408/patch/host) times these in ns; `make
+ * BENCH=1` builds 0xEB 0x06 in, which times them on the keyboard in DWT
+ * cycles.  The anim kernels run on the live scene and advance it, as
+ * extra LED frames would; WS2812 re-encodes the DMA frame in place. */
+#if defined(PATCH_BENCH) || defined(PATCH_HOST)
+#define BENCH_EASE       0   /* every easing × t = 0..255 */
+#define BENCH_HSV        1   /* hsv_to_rgb, h = 0..255, s = v = 255 */
+#define BENCH_WS2812     2   /* decode + re-encode every channel of the DMA frame */
+#define BENCH_ANIM_EVAL  3   /* anim_evaluate, 16 points across each live def */
+#define BENCH_ANIM_TICK  4   /* anim_tick */
+#define BENCH_BLEND      5   /* frame→DMA copy + blend of the live overlay */
+#define BENCH_NUM        6
+
+static inline uint32_t bench_fold(uint32_t h, uint32_t v) {
+    return (h ^ v) * 16777619u;
+}
 
-        volatile uint8_t *p = &dma[i * 24];
-        /* Decode GRB from WS2812, add overlay RGB, re-encode */
-        uint16_t g = decode_ws2812_byte(p);
-        uint16_t r = decode_ws2812_byte(p + 8);
-        uint16_t b = decode_ws2812_byte(p + 16);
+static uint32_t bench_kernel(uint8_t k) {
+    volatile uint32_t *dma = (volatile uint32_t *)g_led_dma_buf;
+    uint32_t h = 2166136261u;
+    uint8_t r, g, b;
+
+    switch (k) {
+    case BENCH_EASE:
+        for (uint32_t e = EASE_HOLD; e <= EASE_OUT_EXPO; e++)
+            for (uint32_t t = 0; t < 256; t++)
+                h = bench_fold(h, ease_apply((uint8_t)e, (uint8_t)t));
+        break;
+    case BENCH_HSV:
+        for (uint32_t hue = 0; hue < 256; hue++) {
+            hsv_to_rgb((uint8_t)hue, 255, 255, &r, &g, &b);
+            h = bench_fold(h, (uint32_t)r << 16 | (uint32_t)g << 8 | b);
+        }
+        break;
+    case BENCH_WS2812:
+        for (uint32_t w = 0; w < LED_COUNT * WS2812_WORDS_PER_LED; w += 2) {
+            uint32_t v = ws2812_decode(&dma[w]);
+            ws2812_encode(&dma[w], (uint8_t)v);
+            h = bench_fold(h, v);
+        }
+        break;
+    case BENCH_ANIM_EVAL:
+        for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++) {
+            if (anim_defs[d].num_kf == 0)
+                continue;
+            for (uint32_t i = 0; i < 16; i++) {
+                anim_evaluate(d, (uint16_t)(anim_defs[d].duration_ticks * i / 16), &r, &g, &b);
+                h = bench_fold(h, (uint32_t)r << 16 | (uint32_t)g << 8 | b);
+            }
+        }
+        break;
+    case BENCH_ANIM_TICK:
+        anim_engine.frame_count++;
+        anim_tick();
+        for (uint32_t i = 0; i < LED_COUNT * 3; i++)
+            h = bench_fold(h, overlay_buf[i]);
+        break;
+    case BENCH_BLEND:
+        overlay_blend_lit(dma, (const volatile uint32_t *)g_led_frame_buf);
+        for (uint32_t w = 0; w < LED_COUNT * WS2812_WORDS_PER_LED; w++)
+            h = bench_fold(h, dma[w]);
+        break;
+    }
+    return h;
+}
+#endif
+
+#ifdef PATCH_BENCH
+/* 0xEB 0x06 BENCH: buf[4] = BENCH_* kernel, buf[5..6] = repetitions (LE,
+ * 0 = 1, capped at 1000) → buf[4] = kernel, buf[5] = BENCH_NUM, buf[6..41]
+ * = cycles per repetition as a profiler slot, buf[42..45] = output hash */
+static int handle_bench_cmd(volatile uint8_t *buf) {
+    uint8_t k = buf[4] < BENCH_NUM ? buf[4] : 0;
+    uint32_t reps = buf[5] | (uint32_t)buf[6] << 8;
+    if (reps == 0) reps = 1;
+    if (reps > 1000) reps = 1000;
+
+    prof_slot_t slot = { 0 };
+    uint32_t hash = 0;
+    for (uint32_t i = 0; i < reps; i++) {
+        uint32_t t0 = prof_begin();
+        hash = bench_kernel(k);
+        prof_account(&slot, DWT_CYCCNT - t0, PROF_HIST_SHIFT);
+    }
+    prof_slot_put(&buf[6], &slot);
+    put_le32(&buf[42], hash);
+    buf[4] = k;
+    buf[5] = BENCH_NUM;
+    buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+    return 1;
+}
+#endif
 
-        r += ov[0]; if (r > 255) r = 255;
-        g += ov[1]; if (g > 255) g = 255;
-        b += ov[2]; if (b > 255) b = 255;
 
-        encode_ws2812_byte(p,      (uint8_t)g);  /* GRB order */
-        encode_ws2812_byte(p + 8,  (uint8_t)r);
-        encode_ws2812_byte(p + 16, (uint8_t)b);
+/* Accept or drop a compact page by sequence number (serial-number order) */
+static int led_stream_accept(uint8_t seq) {
+    if (led_stream.synced && (int8_t)(seq - led_stream.seq) < 0) {
+        led_stream.stale_drops++;
+        return 0;
     }
+    led_stream.seq = seq;
+    led_stream.synced = 1;
+    return 1;
+}
+
+static inline uint8_t led_stream_add(uint8_t v, uint8_t nib, uint8_t shift) {
+    int32_t d = (int32_t)(nib ^ 8) - 8;   /* sign-extend 4 bits */
+    int32_t x = (int32_t)v + d * (1 << shift);
+    return (uint8_t)(x < 0 ? 0 : (x > 255 ? 255 : x));
 }
 
 static int handle_led_stream(volatile uint8_t *buf) {
     uint8_t page = buf[3];
 
+    if (page == 0xFB) {
+        uint8_t seq = buf[4], start = buf[5];
+        if (led_stream_accept(seq)) {
+            for (uint8_t i = 0; i < LED_STREAM_565_PER_PKT && start + i < LED_COUNT; i++) {
+                uint8_t off = 6 + i * 2;
+                uint16_t c565 = (uint16_t)(buf[off] | ((uint16_t)buf[off + 1] << 8));
+                uint8_t r, g, b;
+                unpack_rgb565(c565, &r, &g, &b);
+                overlay_set(start + i, r, g, b);
+                led_stream.led_seq[start + i] = seq;
+            }
+        }
+        buf[0] = 0;
+        return 1;
+    }
+
+    if (page == 0xFC) {
+        uint8_t seq = buf[4], start = buf[5], shift = buf[6] & 0x03;
+        if (led_stream_accept(seq)) {
+            const volatile uint8_t *nib = &buf[7];
+            for (uint8_t i = 0; i < LED_STREAM_DELTA_PER_PKT && start + i < LED_COUNT; i++) {
+                uint8_t idx = start + i;
+                if (led_stream.led_seq[idx] == seq)
+                    continue;                       /* duplicate page */
+                if (led_stream.led_seq[idx] != (uint8_t)(seq - 1)) {
+                    led_stream.delta_misses++;      /* base frame never arrived */
+                    continue;
+                }
+                uint8_t d[3];
+                for (uint8_t c = 0; c < 3; c++) {
+                    uint16_t n = (uint16_t)i * 3 + c;
+                    d[c] = (n & 1) ? (nib[n >> 1] >> 4) : (nib[n >> 1] & 0x0F);
+                }
+                const uint8_t *ov = &overlay_buf[idx * 3];
+                overlay_set(idx, led_stream_add(ov[0], d[0], shift),
+                                 led_stream_add(ov[1], d[1], shift),
+                                 led_stream_add(ov[2], d[2], shift));
+                led_stream.led_seq[idx] = seq;
+            }
+        }
+        buf[0] = 0;
+        return 1;
+    }
+
+    if (page == LED_STREAM_RF_PAGE) {
+        uint8_t n = buf[4] & 0x7F;
+        if (n == 0) {
+            buf[4] = LED_STREAM_RF_PER_PKT;
+            buf[0] = 0;  /* consumed — but preserve buf[3] page echo */
+            return 1;
+        }
+        if (n > LED_STREAM_RF_PER_PKT)
+            n = LED_STREAM_RF_PER_PKT;
+        uint16_t idx = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            const volatile uint8_t *e = &buf[5 + i * 3];
+            idx = i ? idx + e[0] : e[0];
+            if (idx >= LED_COUNT)
+                break;
+            uint8_t r, g, b;
+            unpack_rgb565((uint16_t)(e[1] | ((uint16_t)e[2] << 8)), &r, &g, &b);
+            overlay_set(idx, r, g, b);
+        }
+        buf[0] = 0;
+        buf[2] = 0;
+        buf[3] = 0;
+        return 1;
+    }
+
+    if (page == 0xF9) {
+        /* Visualiser setup: buf[4] = on, buf[5] = decay, buf[6] = peak hold
+         * frames, buf[7..12] = low, high, peak colour (RGB565 LE).
+         * Turning it off blanks the bars.  Response: buf[3] = 0xF9 (echo),
+         * buf[4] = columns, so a host can tell a patch that renders. */
+        uint8_t on = buf[4] & 0x01;
+        if (viz.on && !on)
+            viz_clear();
+        if (on != viz.on) {
+            for (uint8_t c = 0; c < VIZ_COLS; c++)
+                viz.level[c] = viz.peak[c] = viz.hold[c] = 0;
+        }
+        viz.on = on;
+        viz.decay = buf[5];
+        viz.peak_hold = buf[6];
+        viz.c_lo   = (uint16_t)(buf[7]  | ((uint16_t)buf[8]  << 8));
+        viz.c_hi   = (uint16_t)(buf[9]  | ((uint16_t)buf[10] << 8));
+        viz.c_peak = (uint16_t)(buf[11] | ((uint16_t)buf[12] << 8));
+        buf[4] = VIZ_COLS;
+        buf[0] = 0;  /* consumed — but preserve buf[3] page echo */
+        return 1;
+    }
+
+    if (page == 0xFA) {
+        /* Visualiser levels: buf[4] = band count n (1-16), buf[5..] = n
+         * levels 0-255, low band first, spread evenly over the columns */
+        uint8_t n = buf[4];
+        if (viz.on && n >= 1 && n <= VIZ_COLS) {
+            for (uint8_t c = 0; c < VIZ_COLS; c++)
+                viz_set_level(c, buf[5 + c * n / VIZ_COLS]);
+        }
+        buf[0] = 0;
+        return 1;
+    }
+
     if (page == 0xFD) {
         /* Sparse overlay: buf[4]=count, buf[5..]=([matrix_idx,R,G,B] × count)
          * 4 bytes per LED, max 13 entries (13×4+1 = 53, fits in 54 payload bytes).
@@ -945,11 +3089,8 @@ static int handle_led_stream(volatile uint8_t *buf) {
             if (matrix_idx >= MATRIX_LEN) continue;
             uint8_t strip_idx = static_led_pos_tbl[matrix_idx];
             if (strip_idx >= LED_COUNT) continue;
-            overlay_buf[strip_idx * 3 + 0] = entry[1];  /* R */
-            overlay_buf[strip_idx * 3 + 1] = entry[2];  /* G */
-            overlay_buf[strip_idx * 3 + 2] = entry[3];  /* B */
+            overlay_set(strip_idx, entry[1], entry[2], entry[3]);  /* R, G, B */
         }
-        overlay_active = 1;
         buf[0] = 0;
         return 1;
     }
@@ -957,13 +3098,13 @@ static int handle_led_stream(volatile uint8_t *buf) {
     if (page == 0xFE) {
         /* Clear overlay + all animations */
         for (int i = 0; i < ANIM_MAX_DEFS; i++)
-            anim_defs[i].num_kf = 0;
+            anim_def_release(&anim_defs[i]);
         for (int i = 0; i < LED_COUNT; i++)
             key_table[i].anim_id = 0xFF;
         anim_engine.active_count = 0;
-        for (int i = 0; i < LED_COUNT * 3; i++)
-            overlay_buf[i] = 0;
-        overlay_active = 0;
+        overlay_clear_all();
+        led_stream.synced = 0;
+        viz.on = 0;
         buf[0] = 0;
         return 1;
     }
@@ -985,12 +3126,9 @@ static int handle_led_stream(volatile uint8_t *buf) {
             uint8_t strip_idx = static_led_pos_tbl[pos];
             if (strip_idx >= LED_COUNT)
                 continue;
-            overlay_buf[strip_idx * 3 + 0] = rgb[i * 3];     /* R */
-            overlay_buf[strip_idx * 3 + 1] = rgb[i * 3 + 1]; /* G */
-            overlay_buf[strip_idx * 3 + 2] = rgb[i * 3 + 2]; /* B */
+            overlay_set(strip_idx, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);  /* R, G, B */
         }
 
-        overlay_active = 1;
         buf[0] = 0;
         return 1;
     }
@@ -1000,159 +3138,265 @@ static int handle_led_stream(volatile uint8_t *buf) {
 
 /* ── Animation command handler (0xEA) ──────────────────────────────────── */
 
-/* Unpack RGB565 to RGB888 */
-static inline void unpack_rgb565(uint16_t c565, uint8_t *r, uint8_t *g, uint8_t *b) {
-    *r = (uint8_t)(((c565 >> 8) & 0xF8) | ((c565 >> 13) & 0x07));
-    *g = (uint8_t)(((c565 >> 3) & 0xFC) | ((c565 >> 9)  & 0x03));
-    *b = (uint8_t)(((c565 << 3) & 0xF8) | ((c565 >> 2)  & 0x07));
-}
-
-static void anim_recount_active(void) {
-    uint8_t count = 0;
-    for (int i = 0; i < ANIM_MAX_DEFS; i++) {
-        if (anim_defs[i].num_kf > 0) count++;
-    }
-    anim_engine.active_count = count;
-}
-
-/* Auto-clean zombie defs: num_kf > 0 but no keys assigned.
- * Call ONLY after ASSIGN (when key ownership may have changed),
- * NOT after DEF (which creates defs before keys are assigned). */
-static void anim_cleanup_zombies(void) {
-    for (int d = 0; d < ANIM_MAX_DEFS; d++) {
-        if (anim_defs[d].num_kf == 0)
-            continue;
-        uint8_t has_key = 0;
-        for (int k = 0; k < LED_COUNT; k++) {
-            if (key_table[k].anim_id == d) { has_key = 1; break; }
-        }
-        if (!has_key) {
-            anim_defs[d].num_kf = 0;
-            anim_defs[d].elapsed_ticks = 0;
-        }
-    }
-    anim_recount_active();
-}
-
 static void anim_cancel_def(uint8_t def_id) {
     if (def_id >= ANIM_MAX_DEFS) return;
 
     /* Zero the definition */
-    anim_defs[def_id].num_kf = 0;
-    anim_defs[def_id].elapsed_ticks = 0;
-
-    /* Clear key_table entries pointing to this def + zero their overlay */
-    for (int i = 0; i < LED_COUNT; i++) {
+    uint8_t trigger = anim_is_trigger(def_id);
+    anim_def_release(&anim_defs[def_id]);
+    anim_rt[def_id].elapsed_ticks = 0;
+
+    /* Clear key_table entries pointing to this def + zero their overlay;
+     * keys its one-shot is playing on go back to what it displaced */
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+        if (key_bg[i].id == def_id)
+            key_bg[i].id = 0xFF;
         if (key_table[i].anim_id == def_id) {
+            if (trigger && anim_trigger_end(i))
+                continue;
             key_table[i].anim_id = 0xFF;
-            overlay_buf[i * 3 + 0] = 0;
-            overlay_buf[i * 3 + 1] = 0;
-            overlay_buf[i * 3 + 2] = 0;
+            overlay_set(i, 0, 0, 0);
         }
     }
 
     anim_recount_active();
+}
+
+/* QUERY status record of a live def: [0] num_kf, [1] flags, [2] priority,
+ * [3] key_count, [4..5] duration_ticks (u16 LE). */
+static void anim_put_def_status(volatile uint8_t *d, uint8_t def_id) {
+    const anim_def_t *def = &anim_defs[def_id];
+    uint8_t kc = 0;
+    for (int k = 0; k < LED_COUNT; k++)
+        kc += key_table[k].anim_id == def_id;
+    d[0] = def->num_kf;
+    d[1] = def->flags;
+    d[2] = (uint8_t)def->priority;
+    d[3] = kc;
+    d[4] = (uint8_t)(def->duration_ticks & 0xFF);
+    d[5] = (uint8_t)(def->duration_ticks >> 8);
+}
 
-    /* If no animations remain, check if overlay can be deactivated */
-    if (anim_engine.active_count == 0) {
-        uint8_t any = 0;
-        for (int i = 0; i < LED_COUNT * 3; i++) {
-            if (overlay_buf[i]) { any = 1; break; }
+/* QUERY_KEYS body: d[0] = count, then (strip_idx, phase_offset) × count,
+ * max 28.  Keys of a TRIGGER def report phase 0 — their key_t0 is a start
+ * frame, not a phase. */
+static void anim_put_def_keys(volatile uint8_t *d, uint8_t def_id) {
+    uint8_t count = 0;
+    if (def_id < ANIM_MAX_DEFS) {
+        for (uint8_t k = 0; k < LED_COUNT && count < 28; k++) {
+            if (key_table[k].anim_id == def_id) {
+                d[1 + count * 2] = k;
+                d[2 + count * 2] = anim_key_phase(k);
+                count++;
+            }
         }
-        if (!any) overlay_active = 0;
+    }
+    d[0] = count;
+}
+
+/* Give the key at matrix_idx to def_id unless a higher-priority def holds
+ * it.  Staged keys keep the raw phase; anim_stage_apply() resolves it. */
+static void anim_assign_key(anim_def_t *defs, key_anim_t *keys, uint8_t staging,
+                            uint8_t def_id, uint8_t matrix_idx, uint8_t phase_offset) {
+    if (matrix_idx >= MATRIX_LEN) return;
+    uint8_t strip_idx = static_led_pos_tbl[matrix_idx];
+    if (strip_idx >= LED_COUNT) return;
+
+    /* Priority check: only replace if new def has >= priority */
+    uint8_t cur_id = keys[strip_idx].anim_id;
+    if (cur_id < ANIM_MAX_DEFS && defs[cur_id].num_kf > 0) {
+        if (defs[def_id].priority < defs[cur_id].priority)
+            return; /* current has higher priority */
+    }
+
+    if (staging) {
+        keys[strip_idx].anim_id = def_id;
+        anim_stage.phase[strip_idx] = phase_offset;
+    } else if (defs[def_id].flags & ANIM_FLAG_TRIGGER) {
+        /* fires now on this key, over whatever it was playing */
+        anim_trigger_start(strip_idx, def_id,
+                           anim_key_t0(&defs[def_id], matrix_idx, phase_offset));
+    } else {
+        keys[strip_idx].anim_id = def_id;
+        key_t0[strip_idx] = anim_key_t0(&defs[def_id], matrix_idx, phase_offset);
     }
 }
 
 static int handle_anim_cmd(volatile uint8_t *buf) {
     uint8_t sub = buf[3];
 
+    /* Edits target the staged scene while a stage is open, else live state */
+    uint8_t staging = (anim_stage.state == ANIM_STAGE_OPEN);
+    anim_def_t *defs = staging ? anim_stage.defs : anim_defs;
+    key_anim_t *keys = staging ? anim_stage.keys : key_table;
+
+    /* Short forms carry the def id in the low 3 bits of sub (defs 0-7) and
+     * their payload from buf[4].  Wide forms 0x1B-0x1D (ASSIGN, DEF,
+     * DEF_EXT) reach every def: id in buf[4], same payload from buf[5]. */
+    uint8_t def_id = sub & 0x07;
+    const volatile uint8_t *p = &buf[4];
+    if (sub >= 0x1B && sub <= 0x1D) {
+        def_id = buf[4];
+        if (def_id >= ANIM_MAX_DEFS) goto done;
+        p = &buf[5];
+        sub = (uint8_t)((sub - 0x1B) << 3);   /* → 0x00 / 0x08 / 0x10 */
+    }
+
     if (sub <= 0x07) {
         /* ── ANIM_ASSIGN ─────────────────────────────────────────── */
-        uint8_t def_id = sub;
-        if (anim_defs[def_id].num_kf == 0) goto done; /* def not loaded */
+        if (defs[def_id].num_kf == 0) goto done; /* def not loaded */
 
-        uint8_t count = buf[4];
-        if (count > 29) count = 29;  /* max 29: buf[5 + 28*2 + 1] = buf[62] */
-
-        for (uint8_t i = 0; i < count; i++) {
-            uint8_t matrix_idx   = buf[5 + i * 2];
-            uint8_t phase_offset = buf[5 + i * 2 + 1];
-            if (matrix_idx >= MATRIX_LEN) continue;
-            uint8_t strip_idx = static_led_pos_tbl[matrix_idx];
-            if (strip_idx >= LED_COUNT) continue;
-
-            /* Priority check: only replace if new def has >= priority */
-            uint8_t cur_id = key_table[strip_idx].anim_id;
-            if (cur_id < ANIM_MAX_DEFS && anim_defs[cur_id].num_kf > 0) {
-                if (anim_defs[def_id].priority < anim_defs[cur_id].priority)
-                    continue; /* current has higher priority */
-            }
+        uint8_t count = p[0];
+        if (count > 29) count = 29;  /* max 29: buf[5 + 28*2 + 1] = buf[62] (+1 wide) */
 
-            key_table[strip_idx].anim_id = def_id;
-            key_table[strip_idx].phase_offset = phase_offset;
-        }
-        anim_cleanup_zombies();
+        for (uint8_t i = 0; i < count; i++)
+            anim_assign_key(defs, keys, staging, def_id, p[1 + i * 2], p[1 + i * 2 + 1]);
+        if (!staging)
+            anim_cleanup_zombies();  /* staged scenes are cleaned on swap-in */
         goto done;
     }
 
     if (sub >= 0x08 && sub <= 0x0F) {
         /* ── ANIM_DEF ────────────────────────────────────────────── */
-        uint8_t def_id = sub & 0x07;
-        anim_def_t *def = &anim_defs[def_id];
+        anim_def_t *def = &defs[def_id];
 
-        uint8_t num_kf = buf[4];
+        uint8_t num_kf = p[0];
         if (num_kf == 0) goto done;  /* need at least 1 keyframe */
         if (num_kf > ANIM_MAX_KF) num_kf = ANIM_MAX_KF;
 
-        def->flags = buf[5];
-        def->priority = (int8_t)buf[6];
-        def->duration_ticks = (uint16_t)(buf[7] | ((uint16_t)buf[8] << 8));
+        if (!anim_pool_alloc(def, num_kf)) {
+            if (!staging)
+                anim_recount_active();
+            goto done;  /* pool full: def left unused (QUERY_DEFS shows it) */
+        }
+        def->flags = p[1];
+        def->priority = (int8_t)p[2];
+        def->duration_ticks = (uint16_t)(p[3] | ((uint16_t)p[4] << 8));
         if (def->duration_ticks == 0)
             def->duration_ticks = 1;  /* prevent div-by-zero in tick modulo */
-        def->elapsed_ticks = 0;
-
-        /* Unpack up to 4 keyframes from this packet */
-        uint8_t kf_in_pkt = (num_kf > 4) ? 4 : num_kf;
-        for (uint8_t i = 0; i < kf_in_pkt; i++) {
-            uint8_t off = 9 + i * 5;
-            def->kf[i].t_ticks = (uint16_t)(buf[off] | ((uint16_t)buf[off + 1] << 8));
-            uint16_t c565 = (uint16_t)(buf[off + 2] | ((uint16_t)buf[off + 3] << 8));
-            unpack_rgb565(c565, &def->kf[i].r, &def->kf[i].g, &def->kf[i].b);
-            def->kf[i].easing = buf[off + 4];
-        }
+        def->t_shift = 0;             /* smallest quantum that keeps deltas in a byte */
+        while ((def->duration_ticks >> def->t_shift) > 255)
+            def->t_shift++;
+        def->reach = p[25];  /* after the 4 keyframe slots */
+        def->spread = p[26];
+        if (!staging)
+            anim_rt[def_id].elapsed_ticks = 0;
+
+        /* Store up to 4 keyframes from this packet */
+        anim_store_kf(def, 0, num_kf > 4 ? 4 : num_kf, &p[5]);
 
         /* Only set num_kf now: if num_kf > 4, more KFs come via DEF_EXT */
-        def->num_kf = (num_kf <= 4) ? num_kf : 0; /* 0 = pending ext */
         if (num_kf <= 4) {
             def->num_kf = num_kf;
-            anim_recount_active();
-        } else {
-            /* Store expected count in _pad so DEF_EXT knows */
-            def->_pad = num_kf;
+            if (!staging) {
+                anim_prepare_def(def_id);
+                anim_recount_active();
+            }
         }
         goto done;
     }
 
     if (sub >= 0x10 && sub <= 0x17) {
         /* ── ANIM_DEF_EXT ────────────────────────────────────────── */
-        uint8_t def_id = sub & 0x07;
-        anim_def_t *def = &anim_defs[def_id];
-
-        uint8_t num_kf = def->_pad; /* stored by ANIM_DEF */
-        if (num_kf > ANIM_MAX_KF) num_kf = ANIM_MAX_KF;
+        /* Keyframes 4.. of the pending DEF, up to 12 (buf[4 + 11*5 + 4]) */
+        anim_def_t *def = &defs[def_id];
+        if (def->num_kf != 0 || def->kf_count <= 4)
+            goto done;  /* no DEF waiting on its tail */
+
+        anim_store_kf(def, 4, def->kf_count - 4, p);
+        def->num_kf = def->kf_count;
+        if (!staging) {
+            anim_prepare_def(def_id);
+            anim_recount_active();
+        }
+        goto done;
+    }
 
-        /* Unpack KFs 4-7 */
-        for (uint8_t i = 4; i < num_kf; i++) {
-            uint8_t off = 4 + (i - 4) * 5;
-            def->kf[i].t_ticks = (uint16_t)(buf[off] | ((uint16_t)buf[off + 1] << 8));
-            uint16_t c565 = (uint16_t)(buf[off + 2] | ((uint16_t)buf[off + 3] << 8));
-            unpack_rgb565(c565, &def->kf[i].r, &def->kf[i].g, &def->kf[i].b);
-            def->kf[i].easing = buf[off + 4];
+    if (sub == 0x18) {
+        /* ── ANIM_STAGE ──────────────────────────────────────────── */
+        /* Open a staged scene.  buf[4] bit0: seed it from the live scene
+         * (edit-in-place) instead of starting empty; in-flight TRIGGER
+         * one-shots aren't part of the scene, so their keys are seeded
+         * with the def they displaced.  Re-opening discards any previous
+         * stage, including an armed but not yet due commit. */
+        if (buf[4] & 0x01) {
+            memcpy(anim_stage.defs, anim_defs, sizeof(anim_defs));
+            for (uint8_t i = 0; i < LED_COUNT; i++) {
+                uint8_t id = key_table[i].anim_id;
+                uint8_t phase = anim_key_phase(i);
+                if (anim_is_trigger(id)) {
+                    id = key_bg[i].id;
+                    phase = key_bg[i].phase;
+                    if (anim_is_trigger(id))
+                        id = 0xFF;
+                }
+                anim_stage.keys[i].anim_id = id;
+                anim_stage.phase[i] = phase;
+            }
+        } else {
+            for (int i = 0; i < ANIM_MAX_DEFS; i++)
+                anim_def_release(&anim_stage.defs[i]);
+            for (int i = 0; i < LED_COUNT; i++)
+                anim_stage.keys[i].anim_id = 0xFF;
         }
+        anim_stage.state = ANIM_STAGE_OPEN;
+        goto done;
+    }
+
+    if (sub == 0x19) {
+        /* ── ANIM_COMMIT ─────────────────────────────────────────── */
+        /* Close the stage and swap it in when frame_count reaches
+         * buf[4..7] (u32 LE).  A target already in the past (e.g. 0)
+         * applies on the next tick. */
+        if (anim_stage.state != ANIM_STAGE_OPEN) goto done;
+        anim_stage.commit_frame = (uint32_t)buf[4] | ((uint32_t)buf[5] << 8) |
+                                  ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+        anim_stage.state = ANIM_STAGE_ARMED;
+        goto done;
+    }
+
+    if (sub == 0x1A) {
+        /* ── ANIM_ABORT ──────────────────────────────────────────── */
+        anim_stage.state = ANIM_STAGE_IDLE;
+        goto done;
+    }
+
+    if (sub == 0x1E) {
+        /* ── ANIM_SAVE ───────────────────────────────────────────── */
+        /* Store the live scene in flash.  buf[4] bit0: restore it on wake
+         * and USB connect.  Response: buf[3] = 0x1E (echo), buf[4] = 1 if
+         * the sector was rewritten, 0 if it already held this scene. */
+        uint8_t wrote = (uint8_t)anim_scene_save(buf[4] & SCENE_F_WAKE);
+        uint8_t log_payload[2] = { sub, wrote };
+        log_entry(LOG_SCENE, log_payload, 2);
+        buf[4] = wrote;
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0x1F) {
+        /* ── ANIM_LOAD ───────────────────────────────────────────── */
+        /* Replace the live scene with the stored one now, dropping any
+         * stage.  Response: buf[3] = 0x1F (echo), buf[4] = 1 if loaded,
+         * 0 if flash holds no scene for this patch build. */
+        uint8_t loaded = (uint8_t)anim_scene_load();
+        uint8_t log_payload[2] = { sub, loaded };
+        log_entry(LOG_SCENE, log_payload, 2);
+        buf[4] = loaded;
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
 
-        def->num_kf = num_kf;
-        def->_pad = 0;
-        anim_recount_active();
+    if (sub == 0x20) {
+        /* ── ANIM_ASSIGN_ALL ─────────────────────────────────────── */
+        /* buf[4] = def_id, buf[5] = phase_offset: ASSIGN every key.  With
+         * a spatial def this is a whole-board wave in one packet. */
+        def_id = buf[4];
+        if (def_id >= ANIM_MAX_DEFS || defs[def_id].num_kf == 0) goto done;
+        for (uint8_t pos = 0; pos < MATRIX_LEN; pos++)
+            anim_assign_key(defs, keys, staging, def_id, pos, buf[5]);
+        if (!staging)
+            anim_cleanup_zombies();
         goto done;
     }
 
@@ -1163,9 +3407,11 @@ static int handle_anim_cmd(volatile uint8_t *buf) {
          *   buf[4]    = active_count
          *   buf[5..8] = frame_count (u32 LE, for sync)
          *   buf[9]    = overlay_active
-         *   buf[10..57]= per-def status (8 × 6 bytes)
+         *   buf[10..57]= per-def status of defs 0-7 (8 × 6 bytes)
          *     [0] num_kf, [1] flags, [2] priority, [3] key_count,
-         *     [4..5] duration_ticks (u16 LE) */
+         *     [4..5] duration_ticks (u16 LE)
+         *   buf[58]   = stage state (0 idle, 1 open, 2 armed)
+         *   buf[59..62]= armed commit frame (u32 LE) */
         buf[3] = 0xF0;  /* sub echo — driver verifies to reject stale responses */
         buf[4] = anim_engine.active_count;
         uint32_t fc = anim_engine.frame_count;
@@ -1173,65 +3419,115 @@ static int handle_anim_cmd(volatile uint8_t *buf) {
         buf[6] = (uint8_t)((fc >> 8) & 0xFF);
         buf[7] = (uint8_t)((fc >> 16) & 0xFF);
         buf[8] = (uint8_t)((fc >> 24) & 0xFF);
-        buf[9] = overlay_active;
-
-        for (int d = 0; d < ANIM_MAX_DEFS; d++) {
-            uint8_t base = 10 + d * 6;
-            buf[base + 0] = anim_defs[d].num_kf;
-            buf[base + 1] = anim_defs[d].flags;
-            buf[base + 2] = (uint8_t)anim_defs[d].priority;
-            /* Count keys assigned to this def */
-            uint8_t kc = 0;
-            for (int k = 0; k < LED_COUNT; k++) {
-                if (key_table[k].anim_id == d) kc++;
-            }
-            buf[base + 3] = kc;
-            buf[base + 4] = (uint8_t)(anim_defs[d].duration_ticks & 0xFF);
-            buf[base + 5] = (uint8_t)(anim_defs[d].duration_ticks >> 8);
-        }
+        buf[9] = overlay_active();
+
+        for (uint8_t d = 0; d < 8; d++)
+            anim_put_def_status(&buf[10 + d * 6], d);
+        buf[58] = anim_stage.state;
+        uint32_t cf = anim_stage.commit_frame;
+        buf[59] = (uint8_t)(cf & 0xFF);
+        buf[60] = (uint8_t)((cf >> 8) & 0xFF);
+        buf[61] = (uint8_t)((cf >> 16) & 0xFF);
+        buf[62] = (uint8_t)((cf >> 24) & 0xFF);
         buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
         return 1;
     }
 
     if (sub >= 0xF1 && sub <= 0xF8) {
         /* ── ANIM_QUERY_KEYS ─────────────────────────────────────── */
-        /* Returns key assignments for one def.
+        /* Returns key assignments for one of defs 0-7.
          *   buf[3] = sub (echo for disambiguation from QUERY status)
          *   buf[4] = count
          *   buf[5..] = (strip_idx, phase_offset) × count, max 28 */
-        uint8_t def_id = sub - 0xF1;
         buf[3] = sub;  /* echo sub-command so driver can verify */
-        uint8_t count = 0;
-        for (int k = 0; k < LED_COUNT && count < 28; k++) {
-            if (key_table[k].anim_id == def_id) {
-                buf[5 + count * 2]     = (uint8_t)k;
-                buf[5 + count * 2 + 1] = key_table[k].phase_offset;
-                count++;
+        anim_put_def_keys(&buf[4], sub - 0xF1);
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
+    if (sub == 0xF9) {
+        /* ── ANIM_QUERY_DEFS ─────────────────────────────────────── */
+        /* Status of the 8 defs from buf[4] on, and the engine limits:
+         *   buf[3]    = 0xF9 (echo), buf[4] = first def (echo)
+         *   buf[5..52]= 8 × 6-byte status as in QUERY, zero past the last def
+         *   buf[53]   = ANIM_MAX_DEFS, buf[54] = ANIM_MAX_KF
+         *   buf[55]   = ANIM_POOL_KF, buf[56] = pool keyframes held by live defs */
+        uint8_t first = buf[4];
+        for (uint8_t d = 0; d < 8; d++) {
+            volatile uint8_t *rec = &buf[5 + d * 6];
+            if (first < ANIM_MAX_DEFS && first + d < ANIM_MAX_DEFS) {
+                anim_put_def_status(rec, (uint8_t)(first + d));
+            } else {
+                for (uint8_t j = 0; j < 6; j++)
+                    rec[j] = 0;
             }
         }
-        buf[4] = count;
+        uint8_t held = 0;
+        for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++)
+            held += anim_defs[d].kf_count;
+        buf[53] = ANIM_MAX_DEFS;
+        buf[54] = ANIM_MAX_KF;
+        buf[55] = ANIM_POOL_KF;
+        buf[56] = held;
+        buf[0] = 0;  /* consumed — but preserve buf[3..4] echo */
+        return 1;
+    }
+
+    if (sub == 0xFA) {
+        /* ── ANIM_QUERY_KEYS_W ───────────────────────────────────── */
+        /* QUERY_KEYS for any def: buf[4] = def (echo), buf[5] = count,
+         * buf[6..] = (strip_idx, phase_offset) × count, max 28 */
+        anim_put_def_keys(&buf[5], buf[4]);
+        buf[0] = 0;  /* consumed — but preserve buf[3..4] echo */
+        return 1;
+    }
+
+    if (sub == 0xFB) {
+        /* ── ANIM_QUERY_SCENE ────────────────────────────────────── */
+        /* Flash scene store:
+         *   buf[3] = 0xFB (echo), buf[4] = 1 if a scene is stored
+         *   buf[5] = its SCENE_F_* flags, buf[6] = defs, buf[7] = keys
+         *   buf[8] = scenes restored on wake / connect since boot */
+        const anim_scene_t *st = SCENE_STORE;
+        uint8_t valid = (uint8_t)scene_stored(), nd = 0, nk = 0;
+        if (valid) {
+            for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++)
+                nd += st->defs[d].num_kf > 0;
+            for (uint8_t k = 0; k < LED_COUNT; k++)
+                nk += st->keys[k].anim_id < ANIM_MAX_DEFS;
+        }
+        buf[4] = valid;
+        buf[5] = valid ? st->hdr.flags : 0;
+        buf[6] = nd;
+        buf[7] = nk;
+        buf[8] = scene_restores;
         buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
         return 1;
     }
 
     if (sub == 0xFE) {
         /* ── ANIM_CANCEL ─────────────────────────────────────────── */
-        anim_cancel_def(buf[4]);
+        if (!staging) {
+            anim_cancel_def(buf[4]);
+        } else if (buf[4] < ANIM_MAX_DEFS) {
+            anim_def_release(&defs[buf[4]]);
+            for (int i = 0; i < LED_COUNT; i++)
+                if (keys[i].anim_id == buf[4])
+                    keys[i].anim_id = 0xFF;
+        }
         goto done;
     }
 
     if (sub == 0xFF) {
         /* ── ANIM_CLEAR ──────────────────────────────────────────── */
         for (int i = 0; i < ANIM_MAX_DEFS; i++)
-            anim_defs[i].num_kf = 0;
-        for (int i = 0; i < LED_COUNT; i++) {
-            key_table[i].anim_id = 0xFF;
-            overlay_buf[i * 3 + 0] = 0;
-            overlay_buf[i * 3 + 1] = 0;
-            overlay_buf[i * 3 + 2] = 0;
+            anim_def_release(&defs[i]);
+        for (int i = 0; i < LED_COUNT; i++)
+            keys[i].anim_id = 0xFF;
+        if (!staging) {
+            overlay_clear_all();
+            anim_engine.active_count = 0;
         }
-        overlay_active = 0;
-        anim_engine.active_count = 0;
         goto done;
     }
 
@@ -1243,8 +3539,121 @@ done:
     return 1;
 }
 
+/* ── Command bundles (0xEF) ──────────────────────────────────────────────
+ *
+ * Several 0xE8 / 0xEA sub-commands in one SET_REPORT, run in order within
+ * one handle_vendor_cmd call — one control transfer (one RF round trip on
+ * the dongle) for a whole scene upload instead of one per packet.
+ *
+ *   buf[3..62] = entries [len][cmd][data × (len - 1)], len 0 ends.
+ *
+ * Each entry is replayed through its handler from a scratch copy of the
+ * command buffer, zero-filled past `len`, so the host may drop trailing
+ * zero bytes.  Execution stops at the first malformed entry, unsupported
+ * command or unknown sub-command.  Response: buf[3] = entries run,
+ * buf[4] = index of the entry that stopped the bundle (0xFF = none). */
+#define BUNDLE_START   3
+#define BUNDLE_END     63    /* payload limit: entries end by buf[62] */
+#define BUNDLE_SCRATCH 66    /* whole g_vendor_cmd_buffer, as the handlers index it */
+
+static int handle_bundle(volatile uint8_t *buf) {
+    uint8_t sub[BUNDLE_SCRATCH] __attribute__((aligned(4)));
+    uint8_t pos = BUNDLE_START, ran = 0, failed = 0xFF;
+
+    while (pos < BUNDLE_END && buf[pos]) {
+        uint8_t len = buf[pos];
+        if (pos + 1 + len > BUNDLE_END) {
+            failed = ran;
+            break;
+        }
+        for (uint8_t i = 0; i < BUNDLE_SCRATCH; i++)
+            sub[i] = 0;
+        sub[0] = 1;
+        for (uint8_t i = 0; i < len; i++)
+            sub[2 + i] = buf[pos + 1 + i];
+
+        int ok;
+        if (sub[2] == 0xE8)
+            ok = handle_led_stream(sub);
+        else if (sub[2] == 0xEA)
+            ok = handle_anim_cmd(sub);
+        else
+            ok = 0;
+        if (!ok) {
+            failed = ran;
+            break;
+        }
+        ran++;
+        pos += 1 + len;
+    }
+
+    buf[3] = ran;
+    buf[4] = failed;
+    buf[0] = 0;
+    return 1;
+}
+
 /* ── USB connect init (patches config descriptors before enumeration) ──── */
 
+/* ── Key-press trigger hook ─────────────────────────────────────────────
+ * Filter hook on keymap_lookup(default_key, layer, key_index, pressed),
+ * which the key pipeline calls with the row-major matrix index (same
+ * layout as static_led_pos_tbl) for each key it resolves.  Always passes
+ * through.  Edge-detects presses against our own down mask, so it doesn't
+ * matter whether the caller invokes it per edge or per scan while held.
+ * Each press starts every TRIGGER def on the keys within its radius; the
+ * next LED frame already shows t=1 of the effect.  Every edge, press or
+ * release, also starts the latency stamp. */
+static uint32_t key_down_mask[MATRIX_LEN / 32];
+
+static void anim_trigger_press(uint8_t matrix_idx) {
+    uint8_t row = matrix_idx >> 4, col = matrix_idx & 15;
+    uint16_t now = (uint16_t)anim_engine.frame_count;
+
+    for (uint8_t d = 0; d < ANIM_MAX_DEFS; d++) {
+        const anim_def_t *def = &anim_defs[d];
+        if (def->num_kf == 0 || !(def->flags & ANIM_FLAG_TRIGGER))
+            continue;
+        uint8_t rad = def->reach;
+        for (uint8_t pos = 0; pos < MATRIX_LEN; pos++) {
+            uint8_t dr = (pos >> 4) > row ? (pos >> 4) - row : row - (pos >> 4);
+            uint8_t dc = (pos & 15) > col ? (pos & 15) - col : col - (pos & 15);
+            uint8_t dist = dr > dc ? dr : dc;
+            if (dist > rad)
+                continue;
+            uint8_t strip_idx = static_led_pos_tbl[pos];
+            if (strip_idx >= LED_COUNT)
+                continue;
+            uint8_t cur_id = key_table[strip_idx].anim_id;
+            if (cur_id < ANIM_MAX_DEFS && cur_id != d && anim_defs[cur_id].num_kf > 0 &&
+                def->priority < anim_defs[cur_id].priority)
+                continue;
+            uint16_t delay = (uint16_t)dist * def->spread;
+            anim_trigger_start(strip_idx, d, (uint16_t)(now + (delay > 255 ? 255 : delay)));
+        }
+    }
+}
+
+int key_press_hook(uint32_t default_key, uint32_t layer,
+                   uint32_t key_index, uint32_t pressed) {
+    (void)default_key; (void)layer;
+    if (key_index >= MATRIX_LEN)
+        return 0;
+    uint32_t bit = 1u << (key_index & 31);
+    uint32_t *w = &key_down_mask[key_index >> 5];
+    if (!pressed) {
+        if (*w & bit)
+            lat_mark();
+        *w &= ~bit;
+    } else if (!(*w & bit)) {
+        *w |= bit;
+        lat_mark();
+        if (anim_engine.active_count)
+            anim_trigger_press((uint8_t)key_index);
+    }
+    return 0;   /* always run the original keymap_lookup */
+}
+
 /* ── Sleep entry "before" hooks ────────────────────────────────────────
  * Called before wireless_sleep_loop / usb_suspend_handler.  Check whether
  * the function will actually enter its blocking loop (same conditions the
@@ -1272,7 +3681,6 @@ void wireless_sleep_before_hook(void) {
     /* Will enter blocking sleep loop — send sleep event NOW (before
      * we block) and set flag for wake detection. */
     uint8_t state = kbd->deep_sleep_request ? PWR_STATE_DEEP : PWR_STATE_IDLE;
-    pending_power_event = state;
     send_power_state(state);
     sleeping_flag = 1;
 }
@@ -1292,7 +3700,6 @@ void usb_suspend_before_hook(void) {
     /* When suspend counter (byte 0x1d) exceeds 0x31 (50 cycles ≈ 1s),
      * usb_suspend_handler enters its blocking low-power loop. */
     if (kbs[0x1d] > 0x31) {
-        pending_power_event = PWR_STATE_DEEP;
         send_power_state(PWR_STATE_DEEP);
         sleeping_flag = 1;
     }
@@ -1304,15 +3711,19 @@ int handle_usb_connect(void) {
      * so statics from the previous run persist as garbage.
      * Uses linker-provided __patch_bss_start/__patch_bss_end symbols. */
     zero_patch_bss();
+    load_ramfuncs();
 
     /* key_table uses 0xFF as "unassigned" sentinel, but zero_patch_bss sets
      * everything to 0 which means "assigned to def 0".  Fix it. */
-    for (int i = 0; i < LED_COUNT; i++)
+    for (int i = 0; i < LED_COUNT; i++) {
         key_table[i].anim_id = 0xFF;
+        key_bg[i].id = 0xFF;
+    }
+    anim_scene_restore();   /* back to the saved scene, if it asked for it */
 
-    /* pending_power_event = 0 after BSS zero = PWR_STATE_WAKE, which would
-     * cause a spurious drain.  Set to NONE. */
-    pending_power_event = PWR_STATE_NONE;
+    /* Power events queued before this plug are stale; the WAKE below
+     * replaces them. */
+    mbox_reset();
 
     log_entry(LOG_USB_CONNECT, (const uint8_t *)0, 0);
 
@@ -1321,21 +3732,13 @@ int handle_usb_connect(void) {
 
     /* Patch wDescriptorLength to EXTENDED_RDESC_LEN in all SRAM descriptor
      * copies.  Must happen BEFORE enumeration so the config descriptor
-     * advertises the extended report descriptor size (171 + 46 battery). */
-    WDESCLEN_STANDALONE[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_STANDALONE[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_FS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_FS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_HS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_HS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_OS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_OS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
+     * advertises the extended report descriptor size (171 + 46 battery +
+     * 24 gamepad). */
+    PATCH_WDESCLEN(EXTENDED_RDESC_LEN);
 
     /* Pre-populate extended_rdesc buffer so it's ready if GET_DESCRIPTOR
      * arrives before any hid_setup call. */
-    memcpy(extended_rdesc, (void *)&g_if1_report_desc, IF1_RDESC_LEN);
-    for (int i = 0; i < (int)BATTERY_RDESC_LEN; i++)
-        extended_rdesc[IF1_RDESC_LEN + i] = battery_rdesc[i];
+    extended_rdesc_fill();
 
     /* Notify host of wake from deep sleep (USB re-enumeration) */
     send_power_state(PWR_STATE_WAKE);
@@ -1345,66 +3748,166 @@ int handle_usb_connect(void) {
 
 /* ── Debug log read (0xE9) ─────────────────────────────────────────────
  *
- * Reads pages from the ring buffer.
- *   buf[3] = page number (0-9)
+ * Page mode reads raw pages from the ring buffer.
+ *   buf[3] = page number (0-4)
  * Response (host sees resp[N] = buf[N+2]):
  *   buf[3..4] = count (uint16_t LE)   → resp[1..2]
  *   buf[5..6] = head  (uint16_t LE)   → resp[3..4]
  *   buf[7]    = LOG_BUF_SIZE >> 8      → resp[5]
  *   buf[8..63] = 56 bytes of ring data → resp[6..61]
+ *
+ * Cursor mode returns whole entries written since the host's cursor.
+ *   buf[3] = LOG_READ_SINCE, buf[4..7] = cursor (u32 LE, 0 on first read)
+ * Response:
+ *   buf[3]     = LOG_READ_SINCE (sub echo)
+ *   buf[4..7]  = next cursor (u32 LE) — pass back on the next read
+ *   buf[8]     = LOG_F_* flags
+ *   buf[9]     = entry bytes that follow
+ *   buf[10..13] = CYCCNT now (u32 LE), to anchor entry timestamps
+ *   buf[14..63] = entries
  */
+#define LOG_READ_SINCE   0x80
+#define LOG_SINCE_MAX    50     /* buf[14..63] */
+
+#if PATCH_FEAT_LOG
 static int handle_log_read(volatile uint8_t *buf) {
     uint8_t page = buf[3];
 
+    if (page == LOG_READ_SINCE) {
+        uint32_t cur = buf[4] | ((uint32_t)buf[5] << 8) |
+                       ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+        uint8_t flags;
+        uint8_t n = log_read_since(&cur, &buf[14], LOG_SINCE_MAX, &flags);
+
+        put_le32(&buf[4], cur);
+        buf[8] = flags;
+        buf[9] = n;
+        put_le32(&buf[10], prof_begin());
+        buf[0] = 0;  /* consumed — but preserve buf[3] sub-echo */
+        return 1;
+    }
+
     /* Header */
-    buf[3] = (uint8_t)(log_buf.count & 0xFF);
-    buf[4] = (uint8_t)(log_buf.count >> 8);
-    buf[5] = (uint8_t)(log_buf.head & 0xFF);
-    buf[6] = (uint8_t)(log_buf.head >> 8);
-    buf[7] = (uint8_t)(LOG_BUF_SIZE >> 8);  /* 2 → buffer is 512 */
+    uint16_t count = log_buf.seq < LOG_BUF_SIZE ? (uint16_t)log_buf.seq : LOG_BUF_SIZE;
+    uint16_t head  = log_buf.seq & LOG_BUF_MASK;
+    buf[3] = (uint8_t)(count & 0xFF);
+    buf[4] = (uint8_t)(count >> 8);
+    buf[5] = (uint8_t)(head & 0xFF);
+    buf[6] = (uint8_t)(head >> 8);
+    buf[7] = (uint8_t)(LOG_BUF_SIZE >> 8);  /* 1 → buffer is 256 */
 
     /* Copy 56 bytes from ring at offset page*56 */
     uint16_t offset = page * 56;
     for (int i = 0; i < 56; i++) {
-        uint16_t idx = (offset + i) % LOG_BUF_SIZE;
-        buf[8 + i] = (offset + i < LOG_BUF_SIZE) ? log_buf.data[idx] : 0;
+        buf[8 + i] = (offset + i < LOG_BUF_SIZE) ? log_buf.data[(offset + i) & LOG_BUF_MASK] : 0;
     }
 
     buf[0] = 0;  /* mark consumed */
     return 1;
 }
+#endif /* PATCH_FEAT_LOG */
 
 /* ── Vendor command dispatcher ─────────────────────────────────────────── */
 
-int handle_vendor_cmd(void) {
-    volatile uint8_t *cmd_buf = (volatile uint8_t *)&g_vendor_cmd_buffer;
+/* Patch commands, by command byte (buf[2]).  0 = not ours. */
+static int patch_cmd(volatile uint8_t *buf) {
+    switch (buf[2]) {
+    case 0xE7:
+        return handle_patch_info(buf);
+    case 0xE8:
+        return handle_led_stream(buf);
+#if PATCH_FEAT_LOG
+    case 0xE9:
+        return handle_log_read(buf);
+#endif
+    case 0xEA:
+        return handle_anim_cmd(buf);
+    case 0xEB:
+        return handle_prof_cmd(buf);
+    case 0xEC:
+        return handle_depth_cmd(buf);
+    case 0xED:
+        return handle_gamepad_cmd(buf);
+    case 0xEE:
+        return handle_telem_cmd(buf);
+    case 0xEF:
+        return handle_bundle(buf);
+    default:
+        return 0;
+    }
+}
 
-    /* ── Drain queued power state event (set by blend hook) ──── */
-    /* In wireless mode, ep2_send_if_ready fails (no USB).  The event
-     * sits in pending_power_event until the dongle forwards a vendor
-     * command via RF, which triggers this handler.  We send the event
-     * here so the host sees it in the command response cycle. */
-    if (pending_power_event != PWR_STATE_NONE) {
-        send_power_state(pending_power_event);
-        pending_power_event = PWR_STATE_NONE;
+/* ── Tagged commands (0xEF sub 0xFF) ─────────────────────────────────────
+ *
+ * Runs one patch command and returns its response under a host-chosen tag,
+ * so the host can keep several queries (ANIM_QUERY, log reads, ...) in
+ * flight and match each completion by tag instead of polling GET_REPORT
+ * until the sub-command echo changes.
+ *
+ *   request:  buf[3] = 0xFF, buf[4] = tag, buf[5..65] = command (cmd, data)
+ *   response: buf[3] = 0xFF (0xFE = command refused), buf[4] = tag,
+ *             buf[5..65] = the command's own response from its buf[3] on
+ *
+ * The command runs from a zero-filled scratch copy, as bundle entries do.
+ * On USB the completion is also pushed through the EP2 mailbox as the
+ * patch event report, [0A][1F][tag][61 response bytes], or just
+ * [0A][1F][tag] when refused.
+ * Through the dongle the tagged response is the RF response, which the
+ * dongle caches for the host's read-back.  A tagged bundle works (a nested
+ * tag reads as a bundle whose first entry overruns). */
+#define TAG_MARKER     0xFF
+#define TAG_REFUSED    0xFE
+#define TAG_NOTIF      0x1F
+#define TAG_CMD_LEN    61    /* buf[5..65] → scratch[2..62] */
+#define TAG_SCRATCH    66    /* whole g_vendor_cmd_buffer */
+
+static void tag_post(uint8_t tag, const uint8_t *resp, uint8_t ok) {
+    if (tag_mbox.count >= MBOX_TAG_SLOTS - 1) {
+        tag_mbox.drops++;
+        return;
     }
+    uint8_t slot = (tag_mbox.head + tag_mbox.count) % MBOX_TAG_SLOTS;
+    uint8_t *f = tag_mbox.frame[slot];
+    f[0] = PATCH_EVENT_REPORT_ID;
+    f[1] = TAG_NOTIF;
+    f[2] = tag;
+    for (uint8_t i = 0; i < TAG_CMD_LEN; i++)
+        f[3 + i] = resp[i];
+    tag_mbox.len[slot] = ok ? MBOX_TAG_FRAME : 3;
+    tag_mbox.count++;
+    mbox_drain();
+}
 
-    /* ── Battery Input report on charge state change ─────────────── */
-    {
-        static uint8_t prev_charging;
+static int handle_tagged(volatile uint8_t *buf) {
+    uint8_t sub[TAG_SCRATCH] __attribute__((aligned(4)));
+    uint8_t tag = buf[4];
+
+    for (uint8_t i = 0; i < TAG_SCRATCH; i++)
+        sub[i] = 0;
+    sub[0] = 1;
+    for (uint8_t i = 0; i < TAG_CMD_LEN; i++)
+        sub[2 + i] = buf[5 + i];
+
+    uint8_t ok = patch_cmd(sub) != 0;
+    for (uint8_t i = 0; i < TAG_CMD_LEN; i++)
+        buf[5 + i] = ok ? sub[3 + i] : 0;
+    buf[3] = ok ? TAG_MARKER : TAG_REFUSED;
+    buf[4] = tag;
+    buf[0] = 0;
 
-        volatile kbd_state_t *kbd = (volatile kbd_state_t *)&g_kbd_state;
-        uint8_t cur_charging = kbd->charger_connected;
-        if (cur_charging != prev_charging) {
-            prev_charging = cur_charging;
-
-            static uint8_t bat_input[4] __attribute__((aligned(4)));
-            bat_input[0] = 0x07;
-            bat_input[1] = kbd->battery_level;
-            bat_input[2] = cur_charging;
-            ep2_send_if_ready(bat_input, 3);
-        }
-    }
+    if (*(volatile uint8_t *)&g_connection_mode == 6)
+        tag_post(tag, &sub[3], ok);
+    return 1;
+}
+
+static int vendor_cmd_process(void) {
+    volatile uint8_t *cmd_buf = (volatile uint8_t *)&g_vendor_cmd_buffer;
+
+    /* ── Drain the EP2 mailbox (also drained by the blend hook) ──── */
+    /* Keeps notifications moving while the LED frame copy is not running,
+     * and lets the host see them in the command response cycle. */
+    mbox_post_battery();
+    mbox_drain();
 
     /* No pending command — cmd_buf[0] is set non-zero by firmware SET_REPORT handler */
     if (cmd_buf[0] == 0)
@@ -1428,32 +3931,31 @@ int handle_vendor_cmd(void) {
     }
 
     /* Log vendor command entry (skip 0xE9 to avoid contaminating the log
-     * when reading it — each log read would otherwise add 3 bytes) */
-    if (cmd_buf[2] != 0xE9) {
+     * when reading it — each log read would otherwise add 6 bytes) */
+    uint8_t tagged = cmd_buf[2] == 0xEF && cmd_buf[3] == TAG_MARKER;
+    if (cmd_buf[2] != 0xE9 && !(tagged && cmd_buf[5] == 0xE9)) {
         uint8_t log_payload[2] = { cmd_buf[0], cmd_buf[2] };
         log_entry(LOG_VENDOR_CMD_ENTRY, log_payload, 2);
     }
 
     /* Command byte is at cmd_buf[2] = lp_class_report_buf[0]
      * (SET_REPORT data lands at cmd_buf+2, first byte = command) */
-    switch (cmd_buf[2]) {
-    case 0xE7:
-        return handle_patch_info(cmd_buf);
-    case 0xE8:
-        return handle_led_stream(cmd_buf);
-    case 0xE9:
-        return handle_log_read(cmd_buf);
-    case 0xEA:
-        return handle_anim_cmd(cmd_buf);
-    default:
-        return 0;   /* passthrough to original firmware */
-    }
+    if (tagged)
+        return handle_tagged(cmd_buf);
+    return patch_cmd(cmd_buf);   /* 0 = passthrough to original firmware */
 
 reject:
     cmd_buf[0] = 0;   /* discard command */
     return 1;          /* intercepted — skip original */
 }
 
+int handle_vendor_cmd(void) {
+    uint32_t t0 = prof_begin();
+    int r = vendor_cmd_process();
+    prof_end(PROF_VENDOR_CMD, t0);
+    return r;
+}
+
 /* ── Boot-time config validation (bugs 4-5 from oob_hazards.txt) ──────────
  * Called via BL.W from config_load_all (0x08012376), replacing:
  *   ldr r4, [pc, #0xEC]   ; r4 = g_fw_config ptr
@@ -1461,9 +3963,17 @@ reject:
  * Must return with r4 = g_fw_config, r0 = clamped profile_id.
  * r1 is caller-saved (AAPCS) and safe to clobber. */
 
+#ifndef PATCH_HOST
 __attribute__((naked))
 void validate_config_after_load(void) {
     __asm__ volatile (
+        /* Boot: copy SRAM-resident code before the main loop hooks run.
+         * Only r1 is known dead here, so save everything the call may
+         * clobber (6 registers keeps the stack 8-byte aligned). */
+        "push {r0-r3, r12, lr}          \n"
+        "bl   load_ramfuncs             \n"
+        "pop  {r0-r3, r12, lr}          \n"
+
         "ldr  r4, =g_fw_config          \n"
 
         /* Bug 4: clamp profile_id (offset 0x00) to < 4 */
@@ -1488,3 +3998,4 @@ void validate_config_after_load(void) {
         ".ltorg                         \n"
     );
 }
+#endif /* !PATCH_HOST */
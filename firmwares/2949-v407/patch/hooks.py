@@ -60,6 +60,13 @@ HOOKS = [
         mode="before",
         displace=4,                # push {r4-r12,lr} — 4 bytes, safe
     ),
+    Hook(
+        name="report_send",
+        target=0x08013138,         # usb_ep_report_send
+        handler="report_send_before_hook",
+        mode="before",
+        displace=4,                # push.w {r4-r10,lr} — 4 bytes (wide Thumb2), safe
+    ),
     Hook(
         name="wireless_sleep",
         target=0x08016B80,         # wireless_sleep_loop
@@ -74,21 +81,42 @@ HOOKS = [
         mode="before",
         displace=4,                # push {r3-r11,lr} — 4 bytes (wide Thumb2), safe
     ),
+    Hook(
+        name="key_press",
+        target=0x080072D8,         # keymap_lookup
+        handler="key_press_hook",
+        mode="filter",             # filter (not before): r0-r3 carry the key args
+        displace=4,                # push {r4-r9} — 4 bytes (wide Thumb2), safe
+    ),
+    Hook(
+        name="adc_scan",
+        target=0x08005860,         # adc_sensor_process
+        handler="adc_scan_before_hook",
+        mode="before",
+        displace=4,                # push.w {r4-r12,lr} — 4 bytes (wide Thumb2), safe
+    ),
+    Hook(
+        name="depth_report",
+        target=0x08012804,         # send_depth_monitor_report
+        handler="depth_report_hook",
+        mode="filter",             # filter: r0-r3 carry (type, depth_lo, depth_hi, key)
+        displace=4,                # push.w {r4-r8,lr} — 4 bytes (wide Thumb2), safe
+    ),
     # LED overlay: BL-patch the frame→DMA memcpy so our blend function runs every frame.
     # No hook needed — rgb_led_animate and led_render_frame run normally.
 ]
 
 # ── Binary patches ───────────────────────────────────────────────────────────
-# Build-time patches for battery HID descriptor support.
+# Build-time patches for battery + gamepad HID descriptor support.
 # Redirect hid_class_setup_handler to read from extended_rdesc buffer
-# (with battery descriptor appended) instead of the original IF1 report
+# (with battery and gamepad descriptors appended) instead of the original IF1 report
 # descriptor in SRAM.
 
 BINARY_PATCHES = [
-    BinaryPatch(0x080147FC, b'\xAB', b'\xD9',
-                "IF1 rdesc length CMP cap: 171→217"),
-    BinaryPatch(0x08014800, b'\xAB', b'\xD9',
-                "IF1 rdesc length MOV cap: 171→217"),
+    BinaryPatch(0x080147FC, b'\xAB', b'\xF9',
+                "IF1 rdesc length CMP cap: 171→249"),
+    BinaryPatch(0x08014800, b'\xAB', b'\xF9',
+                "IF1 rdesc length MOV cap: 171→249"),
     BinaryPatch(0x0801485C, struct.pack('<I', 0x20000318), b'',
                 "IF1 rdesc pointer → extended_rdesc",
                 symbol='extended_rdesc'),
@@ -123,9 +151,10 @@ BINARY_PATCHES = [
                 "hid_report_check_send blk3: NOP consumer zero+bitmap (7×NOP)"),
     # ── Boot-time config validation (bugs 4-5 from oob_hazards.txt) ──────
     # config_load_all: replace ldr r4,[pc,#0xEC]; ldrb r0,[r4,#0] with
-    # BL validate_config_after_load (returns r4=g_fw_config, r0=profile_id)
+    # BL validate_config_after_load (returns r4=g_fw_config, r0=profile_id).
+    # Runs at boot in every connection mode, so it also loads .ramfunc.
     BinaryPatch(0x08012376, bytes.fromhex('3b4c2078'), b'',
-                "config_load_all: validate profile_id+led_effect_mode after flash read",
+                "config_load_all: load .ramfunc, validate profile_id+led_effect_mode",
                 bl_symbol='validate_config_after_load'),
     # ── LED overlay blend ────────────────────────────────────────────────
     # Replace memcpy(dma_buf, frame_buf, 0x7b0) in firmware_main's scan loop
@@ -0,0 +1,21 @@
+/*
+ * Keyboard firmware v407 adapter for the shared handlers.c.
+ *
+ * Pulls in the Ghidra-exported header for this build (symbol addresses
+ * come from fw_symbols.ld) and selects the shared patch/ modules that fit
+ * its 5 KB PATCH_SRAM.  Any switch can be overridden with -D.
+ */
+
+#ifndef PATCH_TARGET_H
+#define PATCH_TARGET_H
+
+#include "fw_v407.h"
+
+#ifndef PATCH_FEAT_RTT
+#define PATCH_FEAT_RTT 1        /* SEGGER RTT telemetry + stream, 584 B */
+#endif
+#ifndef PATCH_FEAT_LOG
+#define PATCH_FEAT_LOG 1        /* 0xE9 debug log ring, 264 B */
+#endif
+
+#endif /* PATCH_TARGET_H */
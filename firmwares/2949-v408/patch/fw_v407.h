@@ -1,2 +0,0 @@
-/* Compatibility shim: handlers.c includes fw_v407.h, redirect to fw_v408.h */
-#include "fw_v408.h"
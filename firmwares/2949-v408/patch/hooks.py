@@ -66,6 +66,13 @@ HOOKS = [
         mode="before",
         displace=4,                # push {r4-r12,lr} — 4 bytes, safe
     ),
+    Hook(
+        name="report_send",
+        target=0x0801315C,         # usb_ep_report_send (v407: 0x08013138, +36)
+        handler="report_send_before_hook",
+        mode="before",
+        displace=4,                # push.w {r4-r10,lr} — 4 bytes (wide Thumb2), safe
+    ),
     Hook(
         name="wireless_sleep",
         target=0x08016C0C,         # wireless_sleep_loop (v407: 0x08016B80, +140)
@@ -80,16 +87,37 @@ HOOKS = [
         mode="before",
         displace=4,                # push {r3-r11,lr} — 4 bytes (wide Thumb2), safe
     ),
+    Hook(
+        name="key_press",
+        target=0x080072D8,         # keymap_lookup (v407: 0x080072D8, +0)
+        handler="key_press_hook",
+        mode="filter",             # filter (not before): r0-r3 carry the key args
+        displace=4,                # push {r4-r9} — 4 bytes (wide Thumb2), safe
+    ),
+    Hook(
+        name="adc_scan",
+        target=0x08005860,         # adc_sensor_process (v407: 0x08005860, +0)
+        handler="adc_scan_before_hook",
+        mode="before",
+        displace=4,                # push.w {r4-r12,lr} — 4 bytes (wide Thumb2), safe
+    ),
+    Hook(
+        name="depth_report",
+        target=0x08012804,         # send_depth_monitor_report (v407: 0x08012804, +0)
+        handler="depth_report_hook",
+        mode="filter",             # filter: r0-r3 carry (type, depth_lo, depth_hi, key)
+        displace=4,                # push.w {r4-r8,lr} — 4 bytes (wide Thumb2), safe
+    ),
 ]
 
 # ── Binary patches ───────────────────────────────────────────────────────────
 # Same patches as v407, addresses shifted for v408.
 
 BINARY_PATCHES = [
-    BinaryPatch(0x08014820, b'\xAB', b'\xD9',
-                "IF1 rdesc length CMP cap: 171→217"),  # v407: 0x080147FC, +36
-    BinaryPatch(0x08014824, b'\xAB', b'\xD9',
-                "IF1 rdesc length MOV cap: 171→217"),  # v407: 0x08014800, +36
+    BinaryPatch(0x08014820, b'\xAB', b'\xF9',
+                "IF1 rdesc length CMP cap: 171→249"),  # v407: 0x080147FC, +36
+    BinaryPatch(0x08014824, b'\xAB', b'\xF9',
+                "IF1 rdesc length MOV cap: 171→249"),  # v407: 0x08014800, +36
     BinaryPatch(0x08014880, struct.pack('<I', 0x20000318), b'',
                 "IF1 rdesc pointer → extended_rdesc",   # v407: 0x0801485C, +36
                 symbol='extended_rdesc'),
@@ -106,9 +134,9 @@ BINARY_PATCHES = [
                 b'\x08\x48\x01\x80\x81\x70\x20\x78\x40\xf0\x04\x00\x20\x70',
                 b'\x00\xbf\x00\xbf\x00\xbf\x00\xbf\x00\xbf\x00\xbf\x00\xbf',
                 "hid_report_check_send blk3: NOP consumer zero+bitmap (7×NOP)"),  # v407: same, shift 0
-    # Boot-time config validation
+    # Boot-time config validation (also loads .ramfunc)
     BinaryPatch(0x08012376, bytes.fromhex('3b4c2078'), b'',
-                "config_load_all: validate profile_id+led_effect_mode after flash read",
+                "config_load_all: load .ramfunc, validate profile_id+led_effect_mode",
                 bl_symbol='validate_config_after_load'),  # v407: same, shift 0
     # LED overlay blend
     BinaryPatch(0x08016234, bytes.fromhex('eff716fa'), b'',
@@ -0,0 +1,386 @@
+/*
+ * Off-target benchmark and regression harness for the patch hot paths.
+ *
+ * Builds handlers.c for the host (host_hw.h) and drives it the way the
+ * stock firmware does: vendor commands into g_vendor_cmd_buffer and one
+ * led_overlay_memcpy_and_blend() per LED frame.  Every scene runs in a
+ * fresh process, so it starts from power-on state, and folds each DMA frame
+ * it produces into an FNV-1a hash.  Hashes are checked against golden.txt;
+ * timings are host ns and only meaningful relative to each other (the
+ * on-target figure comes from 0xEB 0x06 in a BENCH=1 build).
+ *
+ *   ./bench            run, compare with golden.txt, exit 1 on a mismatch
+ *   ./bench -u         run and rewrite golden.txt
+ *   ./bench -r N       best of N runs per scene (default 5)
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "host_hw.h"
+#include "handlers.c"
+
+#define HB_FRAMES     700
+#define HB_KERNEL_REPS 200
+#define HB_GOLDEN     "golden.txt"
+#define HB_MAX_ROWS   32
+#define HB_FRAME_BYTES (LED_COUNT * WS2812_WORDS_PER_LED * 4)   /* 0x7B0 */
+
+static const char *const hb_kernel_names[BENCH_NUM] = {
+    "ease", "hsv", "ws2812", "anim_eval", "anim_tick", "blend",
+};
+
+/* ── Driving the handlers ────────────────────────────────────────────── */
+
+static void hb_cmd(const uint8_t *b, uint32_t n) {
+    memset((void *)g_vendor_cmd_buffer, 0, 66);
+    g_vendor_cmd_buffer[0] = 1;
+    memcpy((void *)&g_vendor_cmd_buffer[2], (void *)b, n);
+    handle_vendor_cmd();
+}
+
+static uint32_t hb_fold_frame(uint32_t h) {
+    for (uint32_t i = 0; i < HB_FRAME_BYTES; i++)
+        h = bench_fold(h, g_led_dma_buf[i]);
+    return h;
+}
+
+static void hb_frame(void) {
+    led_overlay_memcpy_and_blend((void *)g_led_dma_buf, (void *)g_led_frame_buf,
+                                 HB_FRAME_BYTES);
+}
+
+/* Stock frame: every channel dark, or a per-LED gradient */
+static void hb_stock(int gradient) {
+    volatile uint32_t *f = (volatile uint32_t *)g_led_frame_buf;
+    for (uint32_t i = 0; i < LED_COUNT * 3; i++)
+        ws2812_encode(&f[i * 2], gradient ? (uint8_t)(i * 7) : 0);
+}
+
+/* DEF with a TRIGGER radius or spatial mode arg (reach) and spread */
+static void hb_anim_def_at(uint8_t id, uint8_t flags, uint8_t prio, uint16_t dur,
+                           uint8_t nkf, const uint16_t (*kf)[3],
+                           uint8_t reach, uint8_t spread) {
+    uint8_t b[64] = { 0xEA, (uint8_t)(0x08 + id), nkf, flags, prio,
+                      (uint8_t)dur, (uint8_t)(dur >> 8) };
+    b[27] = reach;
+    b[28] = spread;
+    for (uint8_t i = 0; i < nkf && i < 4; i++) {
+        uint8_t *o = &b[7 + i * 5];
+        o[0] = (uint8_t)kf[i][0]; o[1] = (uint8_t)(kf[i][0] >> 8);
+        o[2] = (uint8_t)kf[i][1]; o[3] = (uint8_t)(kf[i][1] >> 8);
+        o[4] = (uint8_t)kf[i][2];
+    }
+    hb_cmd(b, sizeof(b));
+    if (nkf > 4) {
+        uint8_t e[64] = { 0xEA, (uint8_t)(0x10 + id) };
+        for (uint8_t i = 4; i < nkf; i++) {
+            uint8_t *o = &e[2 + (i - 4) * 5];
+            o[0] = (uint8_t)kf[i][0]; o[1] = (uint8_t)(kf[i][0] >> 8);
+            o[2] = (uint8_t)kf[i][1]; o[3] = (uint8_t)(kf[i][1] >> 8);
+            o[4] = (uint8_t)kf[i][2];
+        }
+        hb_cmd(e, sizeof(e));
+    }
+}
+
+static void hb_anim_def(uint8_t id, uint8_t flags, uint8_t prio, uint16_t dur,
+                        uint8_t nkf, const uint16_t (*kf)[3]) {
+    hb_anim_def_at(id, flags, prio, dur, nkf, kf, 0, 0);
+}
+
+static void hb_anim_assign(uint8_t id, uint8_t from, uint8_t to, uint8_t step) {
+    for (uint8_t s = from; s < to; s += 29) {
+        uint8_t b[64] = { 0xEA, id };
+        uint8_t n = 0;
+        for (uint8_t k = s; k < to && n < 29; k++, n++) {
+            b[3 + n * 2] = k;
+            b[4 + n * 2] = (uint8_t)((k - from) * step);
+        }
+        b[2] = n;
+        hb_cmd(b, sizeof(b));
+    }
+}
+
+/* Four overlapping defs: sticky, one-shot, ping-pong and a long keyframe
+ * chain, with per-key phase on three of them */
+static void hb_anim_mix(void) {
+    static const uint16_t k0[4][3] = {
+        { 0, 0x001F, 2 }, { 50, 0xF800, 1 }, { 90, 0x07E0, 6 }, { 140, 0x001F, 3 } };
+    static const uint16_t k1[2][3] = { { 0, 0xFF00, 1 }, { 100, 0x4000, 4 } };
+    static const uint16_t k2[6][3] = {
+        { 0, 0xFFFF, 1 }, { 10, 0x1234, 2 }, { 25, 0xF00F, 5 },
+        { 40, 0x0FF0, 3 }, { 60, 0xAAAA, 4 }, { 80, 0x0000, 0 } };
+    hb_anim_def(0, 0, 1, 150, 4, k0); hb_anim_assign(0, 0, 60, 0);
+    hb_anim_def(1, 4, 2, 200, 2, k1); hb_anim_assign(1, 20, 40, 1);
+    hb_anim_def(2, 1, 3, 100, 6, k2); hb_anim_assign(2, 60, 82, 2);
+    hb_anim_def(3, 0, 0, 97, 6, k2);  hb_anim_assign(3, 70, 82, 3);
+}
+
+/* Sparse overlay on every key, 15 keys per 0xE8 0xFD packet */
+static void hb_overlay_all(void) {
+    for (uint8_t s = 0; s < LED_COUNT; s += 15) {
+        uint8_t b[64] = { 0xE8, 0xFD };
+        uint8_t n = 0;
+        for (uint8_t k = s; k < LED_COUNT && n < 15; k++, n++) {
+            b[3 + n * 4] = k;
+            b[4 + n * 4] = (uint8_t)(k * 3);
+            b[5 + n * 4] = (uint8_t)(255 - k * 3);
+            b[6 + n * 4] = (uint8_t)(k & 1 ? 0x40 : 0);
+        }
+        b[2] = n;
+        hb_cmd(b, 3 + n * 4u);
+    }
+}
+
+/* ── Scenes ──────────────────────────────────────────────────────────── */
+
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*per_frame)(uint32_t f);   /* before each frame, or NULL */
+} hb_scene_t;
+
+static void hb_setup_idle(void)   { hb_stock(1); }
+static void hb_setup_static(void) { hb_stock(1); hb_overlay_all(); }
+static void hb_setup_anim(void)   { hb_stock(0); hb_anim_mix(); }
+
+static void hb_setup_viz(void) {
+    /* on, decay 8, peak hold 10, bars blue→red, white peaks */
+    static const uint8_t cfg[] = { 0xE8, 0xF9, 1, 8, 10, 0x1F, 0x00, 0x00, 0xF8, 0xFF, 0xFF };
+    hb_stock(0);
+    hb_cmd(cfg, sizeof(cfg));
+}
+
+static void hb_viz_levels(uint32_t f) {
+    uint8_t b[19] = { 0xE8, 0xFA, 16 };
+    if (f % 2)                          /* host sends at half the frame rate */
+        return;
+    for (uint32_t i = 0; i < 16; i++)
+        b[3 + i] = (uint8_t)((f * (i + 3) * 5) ^ (i * 37));
+    hb_cmd(b, sizeof(b));
+}
+
+/* A looping def on five keys of row 2 and a TRIGGER ripple (radius 2,
+ * 3 ticks per cell) pressed in their middle.  An ASSIGN elsewhere while
+ * the one-shot covers them runs zombie cleanup; once it has played out,
+ * the looping def must be back on its keys. */
+#define HB_TRIG_KEY   37
+#define HB_TRIG_PRESS 100
+
+static void hb_setup_trigger(void) {
+    static const uint16_t loop[2][3] = { { 0, 0x07E0, 1 }, { 40, 0x001F, 1 } };
+    static const uint16_t ring[2][3] = { { 0, 0xFFFF, 4 }, { 30, 0xF800, 0 } };
+    hb_stock(0);
+    hb_anim_def(0, 0, 0, 80, 2, loop);
+    hb_anim_assign(0, HB_TRIG_KEY - 2, HB_TRIG_KEY + 3, 4);
+    hb_anim_def(1, 0, 0, 80, 2, loop);
+    hb_anim_assign(1, 0, 16, 2);
+    hb_anim_def_at(2, ANIM_FLAG_TRIGGER, 1, 30, 2, ring, 2, 3);
+}
+
+static void hb_trigger_frame(uint32_t f) {
+    if (f == HB_TRIG_PRESS)
+        key_press_hook(0, 0, HB_TRIG_KEY, 1);
+    else if (f == HB_TRIG_PRESS + 5)
+        key_press_hook(0, 0, HB_TRIG_KEY, 0);
+    else if (f == HB_TRIG_PRESS + 10)
+        hb_anim_assign(1, 16, 20, 2);   /* zombie cleanup mid one-shot */
+    else if (f == HB_TRIG_PRESS + 60)
+        for (uint8_t pos = HB_TRIG_KEY - 2; pos < HB_TRIG_KEY + 3; pos++) {
+            uint8_t k = static_led_pos_tbl[pos];
+            if (k < LED_COUNT && (key_table[k].anim_id != 0 || anim_defs[0].num_kf == 0)) {
+                fprintf(stderr, "trigger: key %u did not resume def 0\n", pos);
+                _exit(1);
+            }
+        }
+}
+
+static const hb_scene_t hb_scenes[] = {
+    { "idle",   hb_setup_idle,   NULL },
+    { "static", hb_setup_static, NULL },
+    { "anim",   hb_setup_anim,   NULL },
+    { "viz",    hb_setup_viz,    hb_viz_levels },
+    { "trigger", hb_setup_trigger, hb_trigger_frame },
+};
+#define HB_NUM_SCENES (sizeof(hb_scenes) / sizeof(hb_scenes[0]))
+
+static uint64_t hb_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void hb_run_scene(FILE *out, const hb_scene_t *sc) {
+    uint32_t h = 2166136261u;
+    uint64_t busy = 0;
+
+    handle_usb_connect();
+    sc->setup();
+    for (uint32_t f = 0; f < HB_FRAMES; f++) {
+        if (sc->per_frame)
+            sc->per_frame(f);
+        uint64_t t0 = hb_now_ns();
+        hb_frame();
+        busy += hb_now_ns() - t0;
+        h = hb_fold_frame(h);
+    }
+    fprintf(out, "%s %08x %llu\n", sc->name, (unsigned)h,
+            (unsigned long long)(busy / HB_FRAMES));
+}
+
+/* Kernels run on the anim-mix scene under a full overlay, so the anim
+ * kernels see live defs and the blend sees lit keys */
+static void hb_run_kernels(FILE *out) {
+    handle_usb_connect();
+    hb_stock(1);
+    hb_anim_mix();
+    hb_overlay_all();
+    hb_frame();
+    for (uint8_t k = 0; k < BENCH_NUM; k++) {
+        uint32_t h = 0;
+        uint64_t t0 = hb_now_ns();
+        for (uint32_t i = 0; i < HB_KERNEL_REPS; i++)
+            h = bench_kernel(k);
+        uint64_t dt = hb_now_ns() - t0;
+        fprintf(out, "k:%s %08x %llu\n", hb_kernel_names[k], (unsigned)h,
+                (unsigned long long)(dt / HB_KERNEL_REPS));
+    }
+}
+
+/* ── Runner ─────────────────────────────────────────────────────────── */
+
+typedef struct {
+    char name[24];
+    uint32_t hash;
+    uint64_t ns;        /* best run */
+    int unstable;       /* hash differed between runs */
+} hb_row_t;
+
+static hb_row_t hb_rows[HB_MAX_ROWS];
+static uint32_t hb_num_rows;
+
+static hb_row_t *hb_row(const char *name) {
+    for (uint32_t i = 0; i < hb_num_rows; i++)
+        if (strcmp(hb_rows[i].name, name) == 0)
+            return &hb_rows[i];
+    if (hb_num_rows == HB_MAX_ROWS)
+        return NULL;
+    hb_row_t *r = &hb_rows[hb_num_rows++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->ns = UINT64_MAX;
+    return r;
+}
+
+/* Run one job (scene index, or HB_NUM_SCENES for the kernels) in a child
+ * and merge the rows it reports */
+static int hb_fork_job(uint32_t job) {
+    int fd[2];
+    if (pipe(fd) < 0)
+        return -1;
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0) {
+        FILE *out = fdopen(fd[1], "w");
+        close(fd[0]);
+        if (job < HB_NUM_SCENES)
+            hb_run_scene(out, &hb_scenes[job]);
+        else
+            hb_run_kernels(out);
+        fclose(out);
+        _exit(0);
+    }
+    close(fd[1]);
+
+    FILE *in = fdopen(fd[0], "r");
+    char name[24];
+    unsigned hash;
+    unsigned long long ns;
+    while (fscanf(in, "%23s %x %llu", name, &hash, &ns) == 3) {
+        hb_row_t *r = hb_row(name);
+        if (!r)
+            break;
+        if (r->ns != UINT64_MAX && r->hash != hash)
+            r->unstable = 1;
+        r->hash = hash;
+        if (ns < r->ns)
+            r->ns = ns;
+    }
+    fclose(in);
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+        return -1;
+    return 0;
+}
+
+static int hb_golden_lookup(FILE *g, const char *name, uint32_t *hash) {
+    char n[24];
+    unsigned h;
+    rewind(g);
+    while (fscanf(g, "%23s %x", n, &h) == 2)
+        if (strcmp(n, name) == 0) {
+            *hash = h;
+            return 1;
+        }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int update = 0, repeats = 5, opt;
+    while ((opt = getopt(argc, argv, "ur:")) != -1) {
+        if (opt == 'u') {
+            update = 1;
+        } else if (opt == 'r') {
+            repeats = atoi(optarg);
+            if (repeats < 1) repeats = 1;
+        } else {
+            fprintf(stderr, "usage: %s [-u] [-r repeats]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (int rep = 0; rep < repeats; rep++)
+        for (uint32_t job = 0; job <= HB_NUM_SCENES; job++)
+            if (hb_fork_job(job) < 0) {
+                fprintf(stderr, "job %u failed: %s\n", job, strerror(errno));
+                return 1;
+            }
+
+    FILE *g = fopen(HB_GOLDEN, update ? "w" : "r");
+    if (!g) {
+        fprintf(stderr, "%s: %s\n", HB_GOLDEN, strerror(errno));
+        return 1;
+    }
+
+    int bad = 0;
+    printf("%-14s %-8s %10s\n", "", "hash", "ns");
+    for (uint32_t i = 0; i < hb_num_rows; i++) {
+        const hb_row_t *r = &hb_rows[i];
+        const char *verdict = "";
+        uint32_t want;
+        if (update) {
+            fprintf(g, "%s %08x\n", r->name, (unsigned)r->hash);
+        } else if (!hb_golden_lookup(g, r->name, &want)) {
+            verdict = "  NO GOLDEN";
+            bad = 1;
+        } else if (want != r->hash) {
+            verdict = "  MISMATCH";
+            bad = 1;
+        }
+        if (r->unstable) {
+            verdict = "  UNSTABLE";
+            bad = 1;
+        }
+        printf("%-14s %08x %10llu%s\n", r->name, (unsigned)r->hash,
+               (unsigned long long)r->ns, verdict);
+    }
+    fclose(g);
+    printf("%s\n", bad ? "bench: FAIL" : update ? "bench: golden updated" : "bench: ok");
+    return bad;
+}
@@ -0,0 +1,43 @@
+/*
+ * Host build of the patch handlers: the target-access hooks patch_core.h
+ * and handlers.c leave open under PATCH_HOST, pointed at host memory.
+ *
+ * Include this, then handlers.c, as one translation unit (see bench.c).
+ * Linked -no-pie so host data sits below 4 GiB and survives the
+ * firmware's 32-bit address arithmetic (uint32_t casts of pointers).
+ */
+
+#ifndef HOST_HW_H
+#define HOST_HW_H
+
+#include <stdint.h>
+
+#define PATCH_HOST 1
+
+/* MMIO and fixed-address SRAM words → host_stubs.c variables */
+volatile uint32_t *host_mmio(uint32_t addr);
+#define MMIO32(addr)   (*host_mmio(addr))
+#define SYNC_DSB()     ((void)0)
+#define SYNC_DSB_ISB() ((void)0)
+#define irq_save()     0u
+#define irq_restore(m) ((void)(m))
+
+/* No SRAM/flash split on the host: "RAM" functions run where they link */
+#define RAMFUNC
+#define RAMFUNC_RODATA
+
+/* Scene store sector → a host buffer the flash stubs erase and program */
+extern uint8_t host_scene_flash[2048];
+#define SCENE_FLASH_ADDR  ((uint32_t)(uintptr_t)host_scene_flash)
+
+/* fw_v408.h declares the firmware's memcpy with its own prototype */
+#define memcpy fw_memcpy
+
+/* fw_v408.h pins the sizes of USB structs that hold pointers, which only
+ * holds on the 32-bit target: read it here with its asserts off, so the
+ * include in handlers.c is a no-op and the patch's own asserts still run */
+#define _Static_assert(...)
+#include "patch_target.h"
+#undef _Static_assert
+
+#endif /* HOST_HW_H */
@@ -0,0 +1,102 @@
+/*
+ * Stock firmware symbols the patch handlers reference, as host storage and
+ * no-op or RAM-backed calls.  Sized from the v408 SRAM map (fw_symbols.ld).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_hw.h"
+#undef memcpy      /* fw_memcpy below is the libc one */
+
+/* ── Firmware SRAM ───────────────────────────────────────────────────── */
+
+volatile uint8_t g_led_dma_buf[0x7B0] __attribute__((aligned(4)));
+volatile uint8_t g_led_frame_buf[0x7B0] __attribute__((aligned(4)));
+const uint8_t static_led_pos_tbl[96] = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+    64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+    80, 81, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+volatile uint8_t g_vendor_cmd_buffer[128];
+volatile uint8_t g_kbd_state[128];
+volatile uint8_t g_connection_mode[4];
+volatile uint8_t g_conn_state_buf[64];
+volatile uint8_t g_hid_report_pending_flags[16];
+volatile uint8_t g_dongle_consumer_buf[8];
+volatile uint8_t g_battery_avg_buf[64];
+volatile uint8_t g_adc_accumulator[64];
+volatile uint8_t g_cfg_desc_fs[128];
+volatile uint8_t g_cfg_desc_hs[128];
+volatile uint8_t g_cfg_desc_os[128];
+volatile uint8_t g_if1_hid_desc[32];
+volatile uint8_t g_if1_report_desc[256];
+volatile mag_engine_state_t g_mag_engine_state[1];
+
+/* patch.ld symbols: BSS starts zeroed, there is no RAM image to load */
+uint8_t __patch_bss_start[1], __patch_bss_end[1];
+uint32_t __ramfunc_start[1], __ramfunc_load[1];
+__asm__(".globl __ramfunc_end\n.set __ramfunc_end, __ramfunc_start");
+
+/* ── MMIO ────────────────────────────────────────────────────────────── */
+
+static uint32_t host_demcr, host_dwt_ctrl, host_dwt_cyccnt;
+static uint32_t host_gpioc_idr, host_gpiob_idr, host_adc_raw;
+
+volatile uint32_t *host_mmio(uint32_t addr) {
+    switch (addr) {
+    case 0xE000EDFC: return &host_demcr;
+    case 0xE0001000: return &host_dwt_ctrl;
+    case 0xE0001004: return &host_dwt_cyccnt;
+    case 0x40020810: return &host_gpioc_idr;
+    case 0x40020410: return &host_gpiob_idr;
+    case 0x20003C88: return &host_adc_raw;
+    }
+    fprintf(stderr, "host_mmio: unmapped register 0x%08x\n", (unsigned)addr);
+    abort();
+}
+
+/* ── Firmware calls ──────────────────────────────────────────────────── */
+
+void *fw_memcpy(void *dst, void *src, uint32_t n) {
+    return memcpy(dst, src, n);
+}
+
+void usb_ep0_in_xfer_start(otg_dev_handle_t *udev, void *buf, uint32_t len) {
+    (void)udev; (void)buf; (void)len;
+}
+
+void usb_ep2_in_transmit(void *buf, uint32_t len) {
+    (void)buf; (void)len;
+}
+
+/* Scene store: NOR semantics over host_scene_flash, erase needs unlock */
+uint8_t host_scene_flash[2048] __attribute__((aligned(4)));
+static int host_flash_locked = 1;
+
+void flash_unlock(void) { host_flash_locked = 0; }
+void flash_lock(void)   { host_flash_locked = 1; }
+
+void flash_erase_sector(uint32_t addr) {
+    if (host_flash_locked) {
+        fprintf(stderr, "flash_erase_sector: flash locked\n");
+        abort();
+    }
+    memset((void *)(uintptr_t)addr, 0xFF, sizeof(host_scene_flash));
+}
+
+void flash_program_bytes(uint32_t dst, void *src, uint32_t len) {
+    uint8_t *d = (uint8_t *)(uintptr_t)dst;
+    const uint8_t *s = src;
+    if (host_flash_locked) {
+        fprintf(stderr, "flash_program_bytes: flash locked\n");
+        abort();
+    }
+    while (len--)
+        *d++ &= *s++;
+}
@@ -21,7 +21,20 @@ typedef struct __attribute__((packed)) {
     uint8_t kb_battery_info;        /* +0xDB */
     uint8_t kb_charging;            /* +0xDC */
     uint8_t kb_connection_status;   /* +0xDD */
-} dongle_state_t;  /* partial, 222 bytes declared */
+    uint8_t _pad_de[0x08];         /* +0xDE .. +0xE5 */
+    uint8_t mouse_count;            /* +0xE6  queued mouse reports (4 slots, +0xEE..) */
+    uint8_t _pad_e7[0x27];         /* +0xE7 .. +0x10D */
+    uint8_t kbd_ready;              /* +0x10E  6KRO report waiting for EP1 */
+    uint8_t kbd_report[8];          /* +0x10F */
+    uint8_t nkro_ready;             /* +0x117  NKRO (ID 1) report waiting for EP2 */
+    uint8_t nkro_report[15];        /* +0x118 */
+    uint8_t consumer_ready;         /* +0x127  consumer (ID 3) report waiting for EP2 */
+    uint8_t consumer_report[2];     /* +0x128 */
+    uint8_t system_ready;           /* +0x12A  system (ID 2) report waiting for EP2 */
+    uint8_t system_report[2];       /* +0x12B */
+    uint8_t vendor_ready;           /* +0x12D  vendor (ID 5) report waiting for EP2 */
+    uint8_t vendor_report[31];      /* +0x12E  payload after the report ID */
+} dongle_state_t;  /* partial, 333 bytes declared */
 
 /* ── SPI buffer struct (150 bytes @ 0x20000834) ──────────────────────── */
 /* Used to intercept RF packets before rf_packet_dispatch processes them. */
@@ -47,10 +60,15 @@ extern spi_buf_t g_spi_buf;                 /* 0x20000834 */
 extern uint8_t g_usb_device[];              /* 0x20000484 (opaque USB device struct) */
 extern uint8_t g_if1_report_desc[];         /* 0x200001EC (171 bytes, IF1 HID rdesc) */
 extern uint8_t g_ep2_report_buf[];          /* 0x200007F4 (64 bytes, EP2 IN buffer) */
+extern uint8_t g_if1_wdesclen_fs[];         /* 0x200000DA (IF1 wDescriptorLength, FS config) */
+extern uint8_t g_if1_wdesclen_hs[];         /* 0x2000012E (HS config) */
+extern uint8_t g_if1_wdesclen_os[];         /* 0x20000182 (other-speed config) */
+extern uint8_t g_if1_wdesclen_standalone[]; /* 0x200002BF (standalone IF1 HID desc) */
 
 /* ── Firmware functions (Thumb, resolved by fw_symbols.ld) ────────────── */
 extern void usb_ep0_in_xfer_start(void *udev, const void *buf, uint16_t len);
 extern void usb_otg_in_ep_xfer_start(void *usb_dev, uint8_t ep, const void *buf, uint32_t len);
 extern void *memcpy(void *dst, const void *src, unsigned int n);
+extern void rf_tx_handler(void);   /* main loop: forwards ready RF reports to EP1/EP2 */
 
 #endif /* FW_DONGLE_H */
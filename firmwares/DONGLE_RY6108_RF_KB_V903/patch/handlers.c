@@ -12,7 +12,11 @@
  *   2. "filter" hook on hid_class_setup_handler — intercepts GET_REPORT
  *      Feature ID 7 for battery data.
  *   3. "before" hook on rf_packet_dispatch — detects battery/charging
- *      changes and pushes HID Input reports on EP2 (with busy-flag check).
+ *      changes and queues HID Input reports for EP2.
+ *
+ * Plus a BL patch of the main loop's rf_tx_handler call, which runs the
+ * EP2 scheduler (per-class report queues) around the stock sender,
+ * and the RF LED-frame channel (coalesced 0xE8 page 0xF8 frames).
  *
  * Convention (filter mode):
  *   return 0     = passthrough to original firmware handler
@@ -20,66 +24,26 @@
  */
 
 #include <stdint.h>
-#include "fw_dongle.h"
+#include "patch_target.h"   /* fw_dongle.h + feature switches */
+#include "patch_core.h"
 #include "hid_desc.h"
 
-/* ── Linker-provided BSS boundaries (from patch.ld) ──────────────────── */
-
-extern uint8_t __patch_bss_start[];
-extern uint8_t __patch_bss_end[];
-
-static void zero_patch_bss(void) {
-    for (uint8_t *p = __patch_bss_start; p < __patch_bss_end; p++)
-        *p = 0;
-}
-
-/* ── USB HID request constants ───────────────────────────────────────── */
-
-#define USB_BMREQ_CLASS_IN         0xA1   /* bmRequestType: class, device-to-host, interface */
-#define HID_GET_REPORT             0x01   /* bRequest: GET_REPORT */
-#define WVALUE_FEATURE_REPORT(id)  ((3 << 8) | (id))  /* wValue for Feature report by ID */
-
 /* ── Derived addresses ───────────────────────────────────────────────── */
 
 #define IF1_RDESC_LEN  171   /* original IF1 report descriptor length */
 
-/* wDescriptorLength field offsets in SRAM descriptor copies.
+/* wDescriptorLength fields in the SRAM descriptor copies (fw_symbols.ld).
  * Each is a 2-byte LE field within a 9-byte HID descriptor. */
-#define WDESCLEN_FS   ((volatile uint8_t *)0x200000DA)   /* FS config descriptor */
-#define WDESCLEN_HS   ((volatile uint8_t *)0x2000012E)   /* HS config descriptor */
-#define WDESCLEN_OS   ((volatile uint8_t *)0x20000182)   /* OS config descriptor */
-#define WDESCLEN_STANDALONE ((volatile uint8_t *)0x200002BF) /* standalone IF1 HID desc */
+#define WDESCLEN_FS         ((volatile uint8_t *)g_if1_wdesclen_fs)
+#define WDESCLEN_HS         ((volatile uint8_t *)g_if1_wdesclen_hs)
+#define WDESCLEN_OS         ((volatile uint8_t *)g_if1_wdesclen_os)
+#define WDESCLEN_STANDALONE ((volatile uint8_t *)g_if1_wdesclen_standalone)
 
 /* ── Battery HID report descriptor (appended to IF1) ─────────────────── */
 
-/* 46 bytes: Battery Strength + Charging status, Feature + Input reports.
- * Identical to keyboard patch — shared hid_desc.h macros. */
+/* 46 bytes, Report ID 7 — the same collection as the keyboard patch */
 static const uint8_t battery_rdesc[] = {
-    HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
-    HID_USAGE(HID_USAGE_DESKTOP_KEYBOARD),
-    HID_COLLECTION(HID_COLLECTION_APPLICATION),
-      HID_REPORT_ID(7)
-      /* ── Battery capacity (0-100%) ── */
-      HID_USAGE_PAGE(HID_USAGE_PAGE_GENERIC_DEVICE),
-      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),
-      HID_LOGICAL_MIN(0),
-      HID_LOGICAL_MAX_N(100, 2),
-      HID_REPORT_SIZE(8),
-      HID_REPORT_COUNT(1),
-      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),
-      HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      /* ── Charging status (0/1) ── */
-      HID_USAGE_PAGE(HID_USAGE_PAGE_BATTERY_SYSTEM),
-      HID_USAGE(HID_USAGE_BATTERY_CHARGING),
-      HID_LOGICAL_MIN(0),
-      HID_LOGICAL_MAX(1),
-      HID_REPORT_SIZE(8),
-      HID_REPORT_COUNT(1),
-      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-      HID_USAGE(HID_USAGE_BATTERY_CHARGING),
-      HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
-    HID_COLLECTION_END,
+    HID_BATTERY_RDESC(7),
 };
 
 #define BATTERY_RDESC_LEN  (sizeof(battery_rdesc))        /* 46 */
@@ -106,23 +70,357 @@ static inline int ep2_send_if_ready(uint8_t *data, uint32_t len) {
     return 1;
 }
 
+/* ── RF LED-frame channel ────────────────────────────────────────────────
+ * A forwarded vendor command costs the host a full round trip: poll F7
+ * until the keyboard's RF reply lands, flush it with FC, and only then
+ * send the next one.  LED streaming at 30+ fps can't live with that, so
+ * dirty-LED frames (0xE8 page 0xF8, see the keyboard's handle_led_stream)
+ * stop here instead:
+ *   - the host sends them without reading anything back; each one is
+ *     merged into a per-LED RGB565 shadow with a dirty bit, and dropped
+ *     from vendor_cmd_pending so the stock forwarder never sees it;
+ *   - whenever the link is free, the LEDs still dirty are packed, in
+ *     strip order, into one page-0xF8 command and handed to the stock
+ *     forwarder through vendor_cmd_buf — its SPI framing stays stock.
+ * An LED changed again before it went out is sent once, newest colour
+ * only, so a slow link drops stale colours rather than queueing them.
+ * There is no per-frame ack: between our own packets we only wait for
+ * the SPI TX slot (tx_ready clear), not for the keyboard's reply.  After
+ * a host command we wait for rf_idle, so its reply is not overwritten
+ * in the response cache.  Packets we build carry bit 7 in the count
+ * byte, which tells them apart from a host page that overwrote one
+ * before the forwarder took it (its LEDs are then marked dirty again).
+ * Probes (count 0) and every other command pass through.
+ *
+ * Stock contract (disassembly): the USB OUT handler at 0x08007058 runs in
+ * the OTG IRQ, sets vendor_cmd_pending and then copies the 64-byte report
+ * into vendor_cmd_buf.  The main-loop forwarder at 0x0800637c clears
+ * pending, dispatches on vendor_cmd_buf[0] (dongle-local 0x7A/0x7F/0xF0/
+ * 0xF6-0xFE, anything else is copied whole into spi tx_data) and sets
+ * spi tx_ready; the SPI sender at 0x0800619c clears tx_ready when it
+ * starts the DMA.  The forwarder never checks tx_ready, so neither may a
+ * packet of ours be queued while it is set.  Every access to vendor_cmd_buf
+ * here runs with the IRQ masked, so a host report cannot land mid-copy. */
+#define RF_LED_COUNT    82
+#define RF_LED_MAP      ((RF_LED_COUNT + 7) / 8)
+#define RF_LED_PAGE     0xF8
+#define RF_LED_PER_PKT  20    /* [n] + 20 × [gap][RGB565] fills buf[2..62] */
+#define RF_LED_OURS     0x80
+
+static struct {
+    uint16_t color[RF_LED_COUNT];    /* newest colour of each strip LED */
+    uint8_t  dirty[RF_LED_MAP];      /* changed since it last went out */
+    uint8_t  sent[RF_LED_MAP];       /* in the packet waiting to be forwarded */
+    uint8_t  inflight;               /* our packet is in vendor_cmd_buf */
+    uint8_t  link_ours;              /* last forwarded command was ours */
+} rf_led;                            /* 188 bytes */
+
+static inline int rf_led_is_frame(volatile uint8_t *v) {
+    return v[0] == 0xE8 && v[1] == RF_LED_PAGE;
+}
+
+/* Merge a host page into the shadow */
+static void rf_led_merge(const uint8_t *v) {
+    uint8_t n = v[2] & 0x7F;
+    if (n > RF_LED_PER_PKT)
+        n = RF_LED_PER_PKT;
+    uint16_t idx = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const uint8_t *e = &v[3 + i * 3];
+        idx = i ? idx + e[0] : e[0];
+        if (idx >= RF_LED_COUNT)
+            break;
+        rf_led.color[idx] = (uint16_t)(e[1] | ((uint16_t)e[2] << 8));
+        rf_led.dirty[idx >> 3] |= (uint8_t)(1 << (idx & 7));
+    }
+}
+
+/* Pack dirty LEDs into a page, moving them to sent; returns 0 if none */
+static int rf_led_build(uint8_t *v) {
+    uint8_t n = 0, prev = 0;
+    for (uint8_t idx = 0; idx < RF_LED_COUNT && n < RF_LED_PER_PKT; idx++) {
+        uint8_t bit = (uint8_t)(1 << (idx & 7));
+        if (!(rf_led.dirty[idx >> 3] & bit))
+            continue;
+        uint8_t *e = &v[3 + n * 3];
+        e[0] = n ? idx - prev : idx;
+        e[1] = (uint8_t)rf_led.color[idx];
+        e[2] = (uint8_t)(rf_led.color[idx] >> 8);
+        rf_led.dirty[idx >> 3] &= (uint8_t)~bit;
+        rf_led.sent[idx >> 3] |= bit;
+        prev = idx;
+        n++;
+    }
+    if (!n)
+        return 0;
+    v[0] = 0xE8;
+    v[1] = RF_LED_PAGE;
+    v[2] = n | RF_LED_OURS;
+    for (uint8_t i = 3 + n * 3; i < 64; i++)
+        v[i] = 0;
+    return 1;
+}
+
+static void rf_led_requeue(void) {
+    for (uint8_t i = 0; i < RF_LED_MAP; i++) {
+        rf_led.dirty[i] |= rf_led.sent[i];
+        rf_led.sent[i] = 0;
+    }
+}
+
+static void rf_led_schedule(void) {
+    volatile dongle_state_t *ds = (volatile dongle_state_t *)&g_dongle_state;
+    volatile uint8_t *v = ds->vendor_cmd_buf;
+    uint8_t page[64] __attribute__((aligned(4)));
+    uint32_t primask;
+
+    if (ds->vendor_cmd_pending) {
+        /* Snapshot the command and, if it is a host LED page, take it
+         * off the forwarder in the same critical section */
+        primask = irq_save();
+        for (uint8_t i = 0; i < sizeof(page); i++)
+            page[i] = v[i];
+        int ours = rf_led.inflight && rf_led_is_frame(page) && (page[2] & RF_LED_OURS);
+        int host_frame = !ours && rf_led_is_frame(page) && (page[2] & 0x7F);
+        if (host_frame)
+            ds->vendor_cmd_pending = 0;
+        irq_restore(primask);
+
+        if (ours)
+            return;                             /* still waiting for the forwarder */
+        if (rf_led.inflight) {
+            rf_led_requeue();
+            rf_led.inflight = 0;
+        }
+        if (!host_frame) {
+            /* Host command: forwarded as usual.  A release/clear (0xE8
+             * 0xFE) wipes the overlay, so colours still queued are stale. */
+            if (page[0] == 0xE8 && page[1] == 0xFE) {
+                for (uint8_t i = 0; i < RF_LED_MAP; i++)
+                    rf_led.dirty[i] = 0;
+            }
+            rf_led.link_ours = 0;
+            return;
+        }
+        rf_led_merge(page);
+    } else if (rf_led.inflight) {
+        for (uint8_t i = 0; i < RF_LED_MAP; i++)
+            rf_led.sent[i] = 0;                 /* forwarded */
+        rf_led.inflight = 0;
+        rf_led.link_ours = 1;
+    }
+
+    volatile spi_buf_t *spi = (volatile spi_buf_t *)&g_spi_buf;
+    if (spi->tx_ready || !(rf_led.link_ours || ds->rf_idle))
+        return;
+    if (!rf_led_build(page))
+        return;
+    /* A host report that arrived since the check above wins; ours waits */
+    primask = irq_save();
+    int free = !ds->vendor_cmd_pending;
+    if (free) {
+        for (uint8_t i = 0; i < sizeof(page); i++)
+            v[i] = page[i];
+        ds->vendor_cmd_pending = 1;
+    }
+    irq_restore(primask);
+    if (free)
+        rf_led.inflight = 1;
+    else
+        rf_led_requeue();
+}
+
+/* ── EP2 scheduler ───────────────────────────────────────────────────────
+ * EP2 carries NKRO, mouse, consumer, system and vendor (ID 5: depth and
+ * keyboard notifications) reports, and takes one of them per USB
+ * microframe (busy is cleared on SOF).  Stock rf_tx_handler keeps one
+ * buffer per type and sends at most one report per main-loop pass, so a
+ * report still waiting when the next RF packet lands is overwritten —
+ * with depth streaming on, a consumer press and its release can collapse
+ * into the release alone, and vendor reports are mostly lost.
+ *
+ * Reports are sorted into classes, highest priority first:
+ *   key       6KRO (EP1), NKRO and mouse — left in the stock buffers,
+ *             where the newest state replacing an unsent one is right;
+ *   consumer, system
+ *             queued, so every press and release goes out in order;
+ *   battery   one slot, newest wins;
+ *   notify    vendor reports other than depth;
+ *   depth     vendor 0x1B analog telemetry — the only droppable class.
+ * A full queue drops its oldest entry.  Each class has a deadline in
+ * microframes: a depth report older than it is discarded unsent, any
+ * other class still sends but counts the report as late.
+ *
+ * dongle_tx_schedule replaces the main loop's rf_tx_handler call:
+ *   0. runs the RF LED-frame channel (above);
+ *   1. moves ready consumer, system and vendor reports into their queues
+ *      (rf_tx_handler's vendor branch is patched out, and the other two
+ *      find their flags already clear), so RF dispatch can reuse the
+ *      buffers;
+ *   2. runs rf_tx_handler for EP1 and the key class;
+ *   3. if EP2 is still free and no key report is waiting, sends the head
+ *      of the highest-priority non-empty queue.
+ * The key check in 3 matters: EP2 can free up between 2 and 3, and the
+ * key report must then take the next pass rather than wait behind 32
+ * bytes of telemetry.  rf_packet_dispatch decodes at most one RF packet
+ * per pass, so one capture per pass keeps up.  EP2 busy is cleared in
+ * interrupt context; draining there would race the stock sender's
+ * unlocked check-then-set, so the drain stays in the main loop, right
+ * after the pass that observed the clear.
+ *
+ * Waits are timed in microframes from the DWT cycle counter (216 MHz,
+ * same core as the keyboard).  Per-class queue depth, high-water mark,
+ * drops, late count and worst wait are returned by Feature ID 8. */
+#define SCHED_UFRAME_CYC  (216000000u / 8000u)  /* 125 µs */
+
+#define SC_CONSUMER  0
+#define SC_SYSTEM    1
+#define SC_BATTERY   2
+#define SC_NOTIFY    3
+#define SC_DEPTH     4
+#define SC_NUM       5
+
+#define VENDOR_REPORT_LEN  32   /* ID 5 + 31 bytes, fixed */
+#define DEPTH_REPORT_TYPE  0x1B
+
+typedef struct {
+    uint8_t  depth;                  /* reports queued now */
+    uint8_t  peak;                   /* high-water mark */
+    uint16_t drops;                  /* overflowed or expired, saturating */
+    uint16_t late;                   /* sent past the deadline, saturating */
+    uint16_t worst_wait;             /* microframes */
+} sched_stat_t;                      /* 8 bytes, sent as-is in Feature ID 8 */
+
+typedef struct {
+    uint8_t  *rpt;                   /* cap × len */
+    uint16_t *t_in;                  /* enqueue time per slot */
+    uint8_t   len;                   /* report length including the ID */
+    uint8_t   cap;
+    uint8_t   droppable;
+    uint16_t  deadline;              /* microframes */
+} sched_class_t;
+
+static uint8_t  q_consumer[4][3], q_system[2][3], q_battery[1][3];
+static uint8_t  q_notify[4][VENDOR_REPORT_LEN], q_depth[8][VENDOR_REPORT_LEN];
+static uint16_t t_consumer[4], t_system[2], t_battery[1], t_notify[4], t_depth[8];
+
+static const sched_class_t sched_class[SC_NUM] = {
+    [SC_CONSUMER] = { q_consumer[0], t_consumer, 3, 4, 0, 8 },    /* 1 ms */
+    [SC_SYSTEM]   = { q_system[0],   t_system,   3, 2, 0, 8 },
+    [SC_BATTERY]  = { q_battery[0],  t_battery,  3, 1, 0, 80 },   /* 10 ms */
+    [SC_NOTIFY]   = { q_notify[0],   t_notify,   VENDOR_REPORT_LEN, 4, 0, 40 },
+    [SC_DEPTH]    = { q_depth[0],    t_depth,    VENDOR_REPORT_LEN, 8, 1, 64 },
+};
+
+static struct {
+    uint32_t     cyc_mark;           /* CYCCNT at the last whole microframe */
+    uint16_t     now;                /* microframe clock */
+    uint8_t      head[SC_NUM];
+    sched_stat_t stat[SC_NUM];
+} sched;                             /* 495 bytes with the queues */
+
+static void sched_clock(void) {
+    uint32_t d = dwt_now() - sched.cyc_mark;
+    if (d >= SCHED_UFRAME_CYC) {
+        uint32_t n = d / SCHED_UFRAME_CYC;
+        sched.now += (uint16_t)n;
+        sched.cyc_mark += n * SCHED_UFRAME_CYC;
+    }
+}
+
+static void sched_count(uint16_t *ctr) {
+    if (*ctr != 0xFFFF)
+        (*ctr)++;
+}
+
+static void sched_pop(int c) {
+    sched.head[c] = (sched.head[c] + 1) % sched_class[c].cap;
+    sched.stat[c].depth--;
+}
+
+/* Returns the slot for a new report of class c (ID byte included), making
+ * room by dropping the oldest one if the queue is full. */
+static uint8_t *sched_push(int c) {
+    const sched_class_t *k = &sched_class[c];
+    sched_stat_t *s = &sched.stat[c];
+    if (s->depth == k->cap) {
+        sched_pop(c);
+        sched_count(&s->drops);
+    }
+    uint8_t slot = (sched.head[c] + s->depth) % k->cap;
+    k->t_in[slot] = sched.now;
+    if (++s->depth > s->peak)
+        s->peak = s->depth;
+    return k->rpt + slot * k->len;
+}
+
+static void sched_capture(volatile uint8_t *ready, volatile uint8_t *src,
+                          int c, uint8_t id) {
+    if (!*ready)
+        return;
+    uint8_t *r = sched_push(c);
+    r[0] = id;
+    for (int i = 0; i < sched_class[c].len - 1; i++)
+        r[1 + i] = src[i];
+    *ready = 0;
+}
+
+static void sched_service(void) {
+    volatile dongle_state_t *ds = (volatile dongle_state_t *)&g_dongle_state;
+
+    for (int c = 0; c < SC_NUM; c++) {
+        const sched_class_t *k = &sched_class[c];
+        sched_stat_t *s = &sched.stat[c];
+        while (s->depth) {
+            uint16_t wait = sched.now - k->t_in[sched.head[c]];
+            if (wait <= k->deadline || !k->droppable)
+                break;
+            sched_pop(c);
+            sched_count(&s->drops);
+        }
+        if (!s->depth)
+            continue;
+
+        if (ds->nkro_ready || ds->mouse_count)
+            return;                  /* key class first, next pass */
+        uint16_t wait = sched.now - k->t_in[sched.head[c]];
+        if (!ep2_send_if_ready(k->rpt + sched.head[c] * k->len, k->len))
+            return;
+        if (wait > s->worst_wait)
+            s->worst_wait = wait;
+        if (wait > k->deadline)
+            sched_count(&s->late);
+        sched_pop(c);
+        return;
+    }
+}
+
+void dongle_tx_schedule(void) {
+    volatile dongle_state_t *ds = (volatile dongle_state_t *)&g_dongle_state;
+
+    sched_clock();
+    rf_led_schedule();
+
+    sched_capture(&ds->consumer_ready, ds->consumer_report, SC_CONSUMER, 0x03);
+    sched_capture(&ds->system_ready, ds->system_report, SC_SYSTEM, 0x02);
+    sched_capture(&ds->vendor_ready, ds->vendor_report,
+                  ds->vendor_report[0] == DEPTH_REPORT_TYPE ? SC_DEPTH : SC_NOTIFY,
+                  0x05);
+
+    rf_tx_handler();
+
+    sched_service();
+}
+
 /* ── Descriptor patching (idempotent) ────────────────────────────────── */
 
 static void patch_descriptors(void) {
     /* Copy original IF1 rdesc + append battery descriptor */
     memcpy(extended_rdesc, (void *)g_if1_report_desc, IF1_RDESC_LEN);
-    for (int i = 0; i < (int)BATTERY_RDESC_LEN; i++)
-        extended_rdesc[IF1_RDESC_LEN + i] = battery_rdesc[i];
+    rdesc_append(extended_rdesc, IF1_RDESC_LEN, battery_rdesc, BATTERY_RDESC_LEN);
 
     /* Patch wDescriptorLength in all SRAM descriptor copies */
-    WDESCLEN_FS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_FS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_HS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_HS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_OS[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_OS[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
-    WDESCLEN_STANDALONE[0] = (uint8_t)(EXTENDED_RDESC_LEN & 0xFF);
-    WDESCLEN_STANDALONE[1] = (uint8_t)(EXTENDED_RDESC_LEN >> 8);
+    PATCH_WDESCLEN(EXTENDED_RDESC_LEN);
 }
 
 /* ── USB init hook (descriptor patching before enumeration) ──────────── */
@@ -176,17 +474,23 @@ int handle_hid_setup(void *udev, uint8_t *setup_pkt) {
         /* GET_REPORT Feature ID 8 — dongle patch discovery.
          * Same format as keyboard 0xE7 but via HID Feature report. */
         if (wValue == WVALUE_FEATURE_REPORT(8)) {
-            static uint8_t patch_rsp[16] __attribute__((aligned(4)));
+            static uint8_t patch_rsp[16 + sizeof(sched.stat)] __attribute__((aligned(4)));
             patch_rsp[0]  = 0x08;       /* Report ID 8 */
             patch_rsp[1]  = 0xCA;       /* magic hi */
             patch_rsp[2]  = 0xFE;       /* magic lo */
-            patch_rsp[3]  = 0x01;       /* version */
-            patch_rsp[4]  = 0x31;       /* caps lo: battery(0x01) + consumer_redirect(0x10) + speed_gate_nop(0x20) */
+            patch_rsp[3]  = 0x02;       /* version: 2 adds the EP2 scheduler stats */
+            patch_rsp[4]  = 0x33;       /* caps lo: battery(0x01) + led_stream(0x02, RF LED frames) + consumer_redirect(0x10) + speed_gate_nop(0x20) */
             patch_rsp[5]  = 0x00;       /* caps hi */
             /* name: "MONSDON\0" */
             patch_rsp[6]  = 'M'; patch_rsp[7]  = 'O'; patch_rsp[8]  = 'N'; patch_rsp[9]  = 'S';
             patch_rsp[10] = 'D'; patch_rsp[11] = 'O'; patch_rsp[12] = 'N'; patch_rsp[13] = '\0';
-            uint16_t xfer_len = (wLength < 14) ? wLength : 14;
+            /* EP2 scheduler stats: [classes] [entry size] then sched_stat_t
+             * per class, consumer first (copied: EP0 IN reads the buffer
+             * after we return) */
+            patch_rsp[14] = SC_NUM;
+            patch_rsp[15] = sizeof(sched_stat_t);
+            memcpy(&patch_rsp[16], sched.stat, sizeof(sched.stat));
+            uint16_t xfer_len = (wLength < sizeof(patch_rsp)) ? wLength : sizeof(patch_rsp);
             usb_ep0_in_xfer_start(udev, patch_rsp, xfer_len);
             return 1;  /* intercepted */
         }
@@ -218,13 +522,13 @@ int handle_hid_setup(void *udev, uint8_t *setup_pkt) {
  *
  * Consumer reports now flow through sub=3 natively: the keyboard hook
  * copies encoder data to g_dongle_consumer_buf (sub=3 source buffer),
- * the stock rf_packet_dispatch sets consumer_ready, and rf_tx_handler
- * sends it on EP2 (binary-patched from EP1 in hooks.py).
+ * the stock rf_packet_dispatch sets consumer_ready, and the EP2 scheduler
+ * queues and sends it (rf_tx_handler's consumer branch is binary-patched
+ * from EP1 to EP2 in hooks.py, but now finds the flag already taken).
  *
  * Battery notifications: compares battery/charging values against cached
- * copies.  If changed, pushes HID Input report on EP2 using the busy-flag
- * protocol.  rf_packet_dispatch and rf_tx_handler run sequentially in the
- * main loop (no preemption), so the busy check is race-free. */
+ * copies.  If changed, queues a HID Input report in the scheduler's
+ * battery class, the newest replacing any still unsent. */
 
 void handle_rf_dispatch(void) {
     volatile dongle_state_t *ds = (volatile dongle_state_t *)&g_dongle_state;
@@ -242,7 +546,9 @@ void handle_rf_dispatch(void) {
         prev_battery = bat;
         prev_charging = chg;
 
-        uint8_t bat_input[4] = { 0x07, bat, chg, 0 };
-        ep2_send_if_ready(bat_input, 3);
+        uint8_t *r = sched_push(SC_BATTERY);
+        r[0] = 0x07;
+        r[1] = bat;
+        r[2] = chg;
     }
 }
@@ -65,6 +65,17 @@ BINARY_PATCHES = [
     BinaryPatch(0x08006A34, b'\x03\x28\x7c\xd1',
                 b'\x00\xbf\x00\xbf',
                 "rf_tx_handler: NOP Full-Speed-only gate (CMP+BNE → 2×NOP)"),
+    # ── EP2 scheduler ────────────────────────────────────────────────────
+    # Main loop calls rf_tx_handler once per pass; route it through
+    # dongle_tx_schedule, which queues vendor (ID 5) reports and battery
+    # Input reports around the stock sender.
+    BinaryPatch(0x0800807A, bytes.fromhex('fef7d7fc'), b'',
+                "main loop: rf_tx_handler call → dongle_tx_schedule",
+                bl_symbol='dongle_tx_schedule'),
+    # rf_tx_handler's vendor branch: BEQ skip → B skip, so only the queue
+    # sends vendor reports (keeps them in order).
+    BinaryPatch(0x08006D38, b'\xb7\xd0', b'\xb7\xe7',
+                "rf_tx_handler: skip stock vendor (ID 5) send (BEQ → B)"),
     # NOTE: rf_tx_handler's consumer path already uses EP2 (0x82) with
     # report_id=3 natively.  No EP redirect patches needed — the stock
     # code is correct once consumer_ready/consumer_data are populated
@@ -0,0 +1,22 @@
+/*
+ * Dongle firmware (RY6108 RF KB V903) adapter for the shared patch/ core.
+ *
+ * Pulls in the curated firmware header (symbol addresses come from
+ * fw_symbols.ld) and selects the shared modules.  PATCH_SRAM is 1 KB and
+ * the EP2 scheduler queues take most of it, so RTT and the log ring stay
+ * out.  Any switch can be overridden with -D.
+ */
+
+#ifndef PATCH_TARGET_H
+#define PATCH_TARGET_H
+
+#include "fw_dongle.h"
+
+#ifndef PATCH_FEAT_RTT
+#define PATCH_FEAT_RTT 0
+#endif
+#ifndef PATCH_FEAT_LOG
+#define PATCH_FEAT_LOG 0
+#endif
+
+#endif /* PATCH_TARGET_H */
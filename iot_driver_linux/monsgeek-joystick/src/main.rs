@@ -190,6 +190,21 @@ fn apply_depths(pending_depths: &HashMap<u8, u16>, precision_factor: f64, mapper
 }
 
 /// Run in headless mode (no TUI) with event-driven depth.
+/// On patched firmware, only report depth for keys that drive an axis.
+/// Best effort: stock firmware keeps reporting every key.
+fn subscribe_mapped_keys(keyboard: &KeyboardInterface, config: &JoystickConfig) {
+    let depth_packed =
+        matches!(keyboard.get_patch_info(), Ok(Some(info)) if info.has_depth_packed());
+    if !depth_packed {
+        return;
+    }
+    let keys = config.mapped_key_indices();
+    match keyboard.set_depth_filter(Some(&keys), 0, 0) {
+        Ok(()) => info!("Subscribed depth reports for {} mapped keys", keys.len()),
+        Err(e) => warn!("Failed to set depth filter: {}", e),
+    }
+}
+
 async fn run_headless(config: JoystickConfig, _config_path: PathBuf) -> Result<()> {
     info!("Running in headless mode");
 
@@ -221,6 +236,8 @@ async fn run_headless(config: JoystickConfig, _config_path: PathBuf) -> Result<(
             tokio::time::sleep(Duration::from_secs(2)).await;
         };
 
+        subscribe_mapped_keys(&conn.keyboard, &config);
+
         let mut event_rx = conn.event_rx;
         let precision_factor = conn.precision_factor;
 
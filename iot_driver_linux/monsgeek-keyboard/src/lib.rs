@@ -37,6 +37,8 @@ impl PatchInfo {
         self.capabilities & 0x01 != 0
     }
 
+    /// Check if LED streaming (0xE8) is available. On the dongle patch this
+    /// bit is the RF LED-frame channel, see [`KeyboardInterface::stream_led_rf`].
     pub fn has_led_stream(&self) -> bool {
         self.capabilities & 0x02 != 0
     }
@@ -44,6 +46,92 @@ impl PatchInfo {
     pub fn has_anim_engine(&self) -> bool {
         self.capabilities & 0x40 != 0
     }
+
+    pub fn has_led_stream_compact(&self) -> bool {
+        self.capabilities & 0x80 != 0
+    }
+
+    pub fn has_depth_packed(&self) -> bool {
+        self.capabilities & 0x100 != 0
+    }
+
+    /// Check if the native HID gamepad (0xED, report ID 9) is available
+    pub fn has_gamepad(&self) -> bool {
+        self.capabilities & 0x200 != 0
+    }
+
+    /// Check if push telemetry (0xEE, EP2 notif 0x1E) is available
+    pub fn has_telemetry(&self) -> bool {
+        self.capabilities & 0x400 != 0
+    }
+
+    /// Check if the diagnostics register map (0xE7 sub 0x01/0x02) is available
+    pub fn has_regmap(&self) -> bool {
+        self.capabilities & 0x800 != 0
+    }
+
+    /// Check if command bundles (0xEF) are available
+    pub fn has_bundle(&self) -> bool {
+        self.capabilities & 0x1000 != 0
+    }
+
+    /// Check if tagged commands (0xEF sub 0xFF) are available
+    pub fn has_tagged(&self) -> bool {
+        self.capabilities & 0x2000 != 0
+    }
+
+    /// Check if the flash scene store (0xEA sub 0x1E/0x1F/0xFB) is available
+    pub fn has_scene_store(&self) -> bool {
+        self.capabilities & 0x4000 != 0
+    }
+
+    /// Check if spatial anim defs and ASSIGN_ALL (0xEA sub 0x20) are available
+    pub fn has_anim_spatial(&self) -> bool {
+        self.capabilities & 0x8000 != 0
+    }
+}
+
+/// Dongle EP2 scheduler counters for one report class (Feature ID 8,
+/// dongle patch version 2+).
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct DongleSchedClass {
+    /// Reports queued right now
+    pub depth: u8,
+    /// Queue high-water mark
+    pub peak: u8,
+    /// Reports dropped (queue full, or depth telemetry past its deadline)
+    pub drops: u16,
+    /// Reports sent after their class deadline
+    pub late: u16,
+    /// Worst queueing delay, in 125 µs microframes
+    pub worst_wait: u16,
+}
+
+impl DongleSchedClass {
+    /// Class names in firmware order
+    pub const NAMES: [&'static str; 5] = ["consumer", "system", "battery", "notify", "depth"];
+}
+
+/// Parse the scheduler stats that follow the name in a dongle Feature ID 8
+/// response: `[classes] [entry size]` at byte 14, then one
+/// `[depth, peak, drops:u16, late:u16, worst_wait:u16]` entry per class.
+/// Returns an empty list for older dongle patches.
+pub fn parse_dongle_sched_stats(buf: &[u8]) -> Vec<DongleSchedClass> {
+    if buf.len() < 16 || buf[3] < 2 || buf[15] < 8 {
+        return Vec::new();
+    }
+    let (n, size) = (buf[14] as usize, buf[15] as usize);
+    buf[16..]
+        .chunks_exact(size)
+        .take(n)
+        .map(|e| DongleSchedClass {
+            depth: e[0],
+            peak: e[1],
+            drops: u16::from_le_bytes([e[2], e[3]]),
+            late: u16::from_le_bytes([e[4], e[5]]),
+            worst_wait: u16::from_le_bytes([e[6], e[7]]),
+        })
+        .collect()
 }
 
 /// Status of a single animation definition slot.
@@ -66,6 +154,35 @@ impl AnimDefStatus {
     }
 }
 
+/// Setup of the bar visualiser drawn by the firmware patch (0xE8 page
+/// 0xF9), see [`KeyboardInterface::stream_viz_setup`].
+#[derive(Debug, Clone)]
+pub struct VizSetup {
+    pub enabled: bool,
+    /// Level units (of 255) a bar falls per LED frame; 0 shows levels as sent.
+    pub decay: u8,
+    /// LED frames a peak marker holds before it sinks.
+    pub peak_hold: u8,
+    /// RGB565 colour of the bottom row, ramping to `high` at the top row.
+    pub low: u16,
+    pub high: u16,
+    /// RGB565 peak marker colour, 0 = no markers.
+    pub peak: u16,
+}
+
+impl Default for VizSetup {
+    fn default() -> Self {
+        Self {
+            enabled: true,
+            decay: 8,
+            peak_hold: 30,
+            low: 0x07E0,
+            high: 0xF800,
+            peak: 0xFFFF,
+        }
+    }
+}
+
 /// Animation engine status from firmware query.
 #[derive(Debug, Clone)]
 pub struct AnimStatus {
@@ -73,6 +190,10 @@ pub struct AnimStatus {
     pub frame_count: u32,
     pub overlay_active: bool,
     pub defs: Vec<AnimDefStatus>,
+    /// Staged-upload state: 0 = idle, 1 = open, 2 = armed.
+    pub stage_state: u8,
+    /// Frame an armed stage will be swapped in at.
+    pub commit_frame: u32,
 }
 
 // Macro parsing
@@ -670,6 +791,7 @@ impl KeyboardInterface {
             ));
         }
         self.transport.send(&SetMagnetismReport::enable())?;
+        self.select_depth_frames(true);
         Ok(())
     }
 
@@ -679,9 +801,28 @@ impl KeyboardInterface {
             return Ok(());
         }
         self.transport.send(&SetMagnetismReport::disable())?;
+        self.select_depth_frames(false);
         Ok(())
     }
 
+    /// On patched firmware, switch between packed depth frames and stock
+    /// 0x1B reports. Best effort: stock firmware keeps its own reports.
+    fn select_depth_frames(&self, packed: bool) {
+        if let Ok(Some(info)) = self.get_patch_info() {
+            if info.has_depth_packed() {
+                let mode = if packed {
+                    monsgeek_transport::command::DEPTH_MODE_PACKED
+                } else {
+                    0
+                };
+                let _ = self.set_depth_mode(mode);
+                if !packed {
+                    let _ = self.set_depth_filter(None, 0, 0);
+                }
+            }
+        }
+    }
+
     /// Read a key depth event
     ///
     /// Returns None on timeout
@@ -1923,6 +2064,120 @@ impl KeyboardInterface {
         Ok(())
     }
 
+    /// Stream strip-indexed RGB565 colors (0xE8 page 0xFB).
+    ///
+    /// `colors[i]` is the color for strip index `start + i`. Sent as spans of
+    /// 28 LEDs, so a full 82-LED frame takes 3 packets. All packets of one
+    /// frame must carry the same `seq`; the firmware drops pages with a
+    /// sequence older than the newest it has seen. Increment `seq` per frame.
+    pub fn stream_led_rgb565(
+        &self,
+        seq: u8,
+        start: u8,
+        colors: &[u16],
+    ) -> Result<(), KeyboardError> {
+        for (n, chunk) in colors.chunks(28).enumerate() {
+            let mut data = vec![0u8; 3 + chunk.len() * 2]; // page + seq + start + colors
+            data[0] = 0xFB;
+            data[1] = seq;
+            data[2] = start + (n * 28) as u8;
+            for (i, &c) in chunk.iter().enumerate() {
+                data[3 + i * 2..5 + i * 2].copy_from_slice(&c.to_le_bytes());
+            }
+            self.transport.send_command_with_delay(
+                cmd::LED_STREAM,
+                &data,
+                ChecksumType::None,
+                0,
+            )?;
+        }
+        Ok(())
+    }
+
+    /// Newest compact-stream sequence the firmware accepted (register
+    /// `LED_STREAM`), or `None` before its first compact page since boot or
+    /// [`Self::stream_led_release`]. A new stream must continue after it, as
+    /// older sequences are dropped.
+    pub fn stream_led_seq(&self) -> Result<Option<u8>, KeyboardError> {
+        use monsgeek_transport::command::patch_reg;
+        let regs = self.read_patch_registers(&[patch_reg::LED_STREAM])?;
+        Ok(regs
+            .iter()
+            .find(|(id, _)| *id == patch_reg::LED_STREAM)
+            .filter(|(_, v)| v.len() >= 2 && v[1] != 0)
+            .map(|(_, v)| v[0]))
+    }
+
+    /// Stream dirty LEDs as absolute RGB565 colours (0xE8 page 0xF8).
+    ///
+    /// `entries` are `(strip index, colour)`; they are sorted and sent 20 per
+    /// packet without waiting for a reply. This is the 2.4 GHz frame path:
+    /// the dongle merges the packets and forwards the newest colour of each
+    /// LED when the link is free, so send only LEDs that changed. Needs the
+    /// dongle patch's `led_stream` bit and [`Self::stream_led_rf_probe`].
+    pub fn stream_led_rf(&self, entries: &[(u8, u16)]) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::LedRfFrame;
+        let mut sorted = entries.to_vec();
+        sorted.sort_by_key(|&(strip, _)| strip);
+        for chunk in sorted.chunks(LedRfFrame::MAX_ENTRIES) {
+            let frame = LedRfFrame {
+                entries: chunk.to_vec(),
+            };
+            self.transport.send_with_delay(&frame, 0)?;
+        }
+        Ok(())
+    }
+
+    /// Check that the keyboard patch decodes dirty-LED frames: an empty page
+    /// 0xF8 is answered with the entries per packet, where a stock echo
+    /// returns the empty count. The dongle forwards it like any query.
+    pub fn stream_led_rf_probe(&self) -> Result<bool, KeyboardError> {
+        use monsgeek_transport::command::LedRfFrame;
+        let resp = self.transport.query_command(
+            cmd::LED_STREAM,
+            &[LedRfFrame::PAGE, 0],
+            ChecksumType::None,
+        )?;
+        Ok(resp.get(1) == Some(&LedRfFrame::PAGE)
+            && resp.get(2) == Some(&(LedRfFrame::MAX_ENTRIES as u8)))
+    }
+
+    /// Start or stop the patch's bar visualiser (0xE8 page 0xF9).
+    ///
+    /// While enabled, the firmware draws one bar per matrix column from the
+    /// levels sent with [`Self::stream_viz_levels`], over the current
+    /// lighting, with peak markers and per-frame fall-off. Returns false if
+    /// the firmware can't: its reply must carry the column count where the
+    /// request had the enable flag, which a stock echo never does.
+    pub fn stream_viz_setup(&self, setup: &VizSetup) -> Result<bool, KeyboardError> {
+        let mut data = vec![0u8; 10];
+        data[0] = 0xF9;
+        data[1] = setup.enabled as u8;
+        data[2] = setup.decay;
+        data[3] = setup.peak_hold;
+        data[4..6].copy_from_slice(&setup.low.to_le_bytes());
+        data[6..8].copy_from_slice(&setup.high.to_le_bytes());
+        data[8..10].copy_from_slice(&setup.peak.to_le_bytes());
+        let resp = self
+            .transport
+            .query_command(cmd::LED_STREAM, &data, ChecksumType::None)?;
+        Ok(resp.get(1) == Some(&0xF9) && resp.get(2) == Some(&16))
+    }
+
+    /// Send one frame of visualiser levels (0xE8 page 0xFA): up to 16 bands,
+    /// low band first, 0-255 each. One ~20-byte packet per frame instead of
+    /// three LED pages; the firmware spreads fewer bands over the columns.
+    pub fn stream_viz_levels(&self, levels: &[u8]) -> Result<(), KeyboardError> {
+        let n = levels.len().min(16);
+        let mut data = vec![0u8; 2 + n];
+        data[0] = 0xFA;
+        data[1] = n as u8;
+        data[2..].copy_from_slice(&levels[..n]);
+        self.transport
+            .send_command_with_delay(cmd::LED_STREAM, &data, ChecksumType::None, 0)?;
+        Ok(())
+    }
+
     /// Release LED streaming — signals end of streaming session
     pub fn stream_led_release(&self) -> Result<(), KeyboardError> {
         self.transport
@@ -1935,8 +2190,11 @@ impl KeyboardInterface {
 
     /// Define an animation on the firmware.
     ///
-    /// `keyframes` is a slice of `(t_ticks, color_rgb565, easing)` tuples.
+    /// `keyframes` is a slice of `(t_ticks, color_rgb565, easing)` tuples, up
+    /// to [`AnimDefine::MAX_KF`](monsgeek_transport::command::AnimDefine::MAX_KF).
     /// If more than 4 keyframes, sends a DEF_EXT packet automatically.
+    /// Defs 8-31 need a patch with the keyframe pool (see
+    /// [`Self::anim_query_defs`]).
     pub fn anim_define(
         &self,
         def_id: u8,
@@ -1944,9 +2202,29 @@ impl KeyboardInterface {
         priority: i8,
         duration_ticks: u16,
         keyframes: &[(u16, u16, u8)],
+    ) -> Result<(), KeyboardError> {
+        self.anim_define_with_trigger(def_id, flags, priority, duration_ticks, keyframes, 0, 0)
+    }
+
+    /// Define an animation, including the parameters used by trigger defs.
+    ///
+    /// With the trigger flag (0x08) set in `flags`, the firmware plays the def
+    /// as a one-shot on every key within `trigger_radius` matrix cells of a
+    /// pressed key, delayed by `trigger_spread` ticks per cell, with no host
+    /// round trip. Trigger defs need no ASSIGN.
+    #[allow(clippy::too_many_arguments)]
+    pub fn anim_define_with_trigger(
+        &self,
+        def_id: u8,
+        flags: u8,
+        priority: i8,
+        duration_ticks: u16,
+        keyframes: &[(u16, u16, u8)],
+        trigger_radius: u8,
+        trigger_spread: u8,
     ) -> Result<(), KeyboardError> {
         use monsgeek_transport::command::{AnimDefine, AnimDefineExt};
-        let num_kf = keyframes.len().min(8) as u8;
+        let num_kf = keyframes.len().min(AnimDefine::MAX_KF) as u8;
         // Use query_command (not send) — ensures dongle relay completes
         self.transport.query_command(
             cmd::ANIM_CMD,
@@ -1957,6 +2235,8 @@ impl KeyboardInterface {
                 priority,
                 duration_ticks,
                 keyframes: keyframes.to_vec(),
+                reach: trigger_radius,
+                spread: trigger_spread,
             }
             .to_data(),
             ChecksumType::None,
@@ -1975,6 +2255,201 @@ impl KeyboardInterface {
         Ok(())
     }
 
+    /// Define a looping or one-shot animation whose per-key phase the
+    /// firmware derives from matrix position: `spread` ticks per cell of
+    /// distance along `pattern`, on top of each key's phase_offset. Needs
+    /// [`PatchInfo::has_anim_spatial`]; follow with [`Self::anim_assign_all`]
+    /// for a full-board effect. The phase is fixed when keys are assigned,
+    /// so re-assign after redefining the pattern.
+    #[allow(clippy::too_many_arguments)]
+    pub fn anim_define_spatial(
+        &self,
+        def_id: u8,
+        flags: u8,
+        priority: i8,
+        duration_ticks: u16,
+        keyframes: &[(u16, u16, u8)],
+        pattern: monsgeek_transport::command::AnimSpatial,
+        spread: u8,
+    ) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::AnimSpatial;
+        let flags = (flags & !(AnimSpatial::FLAG_MASK | 0x08)) | pattern.flags();
+        self.anim_define_with_trigger(
+            def_id,
+            flags,
+            priority,
+            duration_ticks,
+            keyframes,
+            pattern.reach(),
+            spread,
+        )
+    }
+
+    /// Define an animation and assign its keys in as few transfers as
+    /// possible, packing DEF, DEF_EXT and ASSIGN packets into command
+    /// bundles (0xEF). Needs [`PatchInfo::has_bundle`]; same arguments as
+    /// [`Self::anim_define`] and [`Self::anim_assign`].
+    pub fn anim_program(
+        &self,
+        def_id: u8,
+        flags: u8,
+        priority: i8,
+        duration_ticks: u16,
+        keyframes: &[(u16, u16, u8)],
+        keys: &[(u8, u8)],
+    ) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::{AnimAssign, AnimDefine, AnimDefineExt};
+        let num_kf = keyframes.len().min(AnimDefine::MAX_KF) as u8;
+        let mut packets = vec![AnimDefine {
+            def_id,
+            num_kf,
+            flags,
+            priority,
+            duration_ticks,
+            keyframes: keyframes.to_vec(),
+            reach: 0,
+            spread: 0,
+        }
+        .to_data()];
+        if num_kf > 4 {
+            packets.push(
+                AnimDefineExt {
+                    def_id,
+                    keyframes: keyframes[4..num_kf as usize].to_vec(),
+                }
+                .to_data(),
+            );
+        }
+        for chunk in keys.chunks(29) {
+            packets.push(
+                AnimAssign {
+                    def_id,
+                    keys: chunk.to_vec(),
+                }
+                .to_data(),
+            );
+        }
+        let packets: Vec<_> = packets.into_iter().map(|p| (cmd::ANIM_CMD, p)).collect();
+        self.send_bundled(&packets)
+    }
+
+    /// Send `(cmd, data)` packets for 0xE8 / 0xEA, packed into as few
+    /// command bundles (0xEF) as fit, in order. Needs
+    /// [`PatchInfo::has_bundle`]. Packets too large for a bundle are sent on
+    /// their own.
+    pub fn send_bundled(&self, packets: &[(u8, Vec<u8>)]) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::{BundleResponse, CommandBundle};
+        let flush = |bundle: &CommandBundle| -> Result<(), KeyboardError> {
+            let r = self
+                .transport
+                .query::<CommandBundle, BundleResponse>(bundle)?;
+            match r.failed {
+                Some(i) => Err(KeyboardError::UnexpectedResponse(format!(
+                    "bundle stopped at entry {i} of {}",
+                    bundle.len()
+                ))),
+                None => Ok(()),
+            }
+        };
+        let mut bundle = CommandBundle::new();
+        for (c, data) in packets {
+            if bundle.push(*c, data) {
+                continue;
+            }
+            if !bundle.is_empty() {
+                flush(&bundle)?;
+                bundle = CommandBundle::new();
+            }
+            if !bundle.push(*c, data) {
+                self.transport.query_command(*c, data, ChecksumType::None)?;
+            }
+        }
+        if !bundle.is_empty() {
+            flush(&bundle)?;
+        }
+        Ok(())
+    }
+
+    /// Send a patch command (`cmd` 0xE7..0xEF plus its data) under `tag`
+    /// without waiting for it (0xEF sub 0xFF). On USB its completion arrives
+    /// as a [`VendorEvent::TaggedCompletion`] carrying `tag`, so several can
+    /// be in flight. Needs [`PatchInfo::has_tagged`].
+    pub fn send_tagged(&self, tag: u8, cmd: u8, data: &[u8]) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::TaggedCommand;
+        self.transport.send(&TaggedCommand {
+            tag,
+            cmd,
+            data: data.to_vec(),
+        })?;
+        Ok(())
+    }
+
+    /// Run a patch command under `tag` and return its plain response
+    /// (`[cmd, …]`, as `query_command` would). Over USB this waits for the
+    /// pushed completion instead of polling GET_REPORT; if none arrives in
+    /// time (late, or dropped from a full completion queue) the response is
+    /// read back once with GET_REPORT. The command is never sent twice, as
+    /// many patch commands are not idempotent. Wireless, it runs as a plain
+    /// query. Either way the read-back response must carry `tag`.
+    /// Needs [`PatchInfo::has_tagged`].
+    pub fn query_tagged(&self, tag: u8, cmd: u8, data: &[u8]) -> Result<Vec<u8>, KeyboardError> {
+        use monsgeek_transport::command::{HidResponse, TaggedCommand, TaggedResponse};
+        use std::time::{Duration, Instant};
+        use tokio::sync::broadcast::error::TryRecvError;
+        const TAGGED_TIMEOUT_MS: u64 = 100;
+
+        let refused = || KeyboardError::UnexpectedResponse(format!("tagged 0x{cmd:02X} refused"));
+        let command = TaggedCommand {
+            tag,
+            cmd,
+            data: data.to_vec(),
+        };
+        let mut sent = false;
+        if !self.is_wireless() {
+            if let Some(mut rx) = self.transport.subscribe_events() {
+                self.transport.send(&command)?;
+                sent = true;
+                let deadline = Instant::now() + Duration::from_millis(TAGGED_TIMEOUT_MS);
+                loop {
+                    match rx.try_recv() {
+                        Ok(ev) => {
+                            if let VendorEvent::TaggedCompletion { tag: t, payload } = ev.event {
+                                if t == tag {
+                                    let mut r = vec![cmd];
+                                    r.extend(payload.ok_or_else(refused)?);
+                                    return Ok(r);
+                                }
+                            }
+                        }
+                        Err(TryRecvError::Empty) => {
+                            if Instant::now() >= deadline {
+                                break;
+                            }
+                            std::thread::sleep(Duration::from_millis(1));
+                        }
+                        Err(TryRecvError::Lagged(_)) => continue,
+                        Err(TryRecvError::Closed) => break,
+                    }
+                }
+            }
+        }
+        let r = if sent {
+            let resp = self.transport.inner().read_report()?;
+            TaggedResponse::parse(&resp)
+                .map_err(|e| KeyboardError::UnexpectedResponse(e.to_string()))?
+        } else {
+            self.transport
+                .query::<TaggedCommand, TaggedResponse>(&command)?
+        };
+        if r.tag != tag {
+            return Err(KeyboardError::UnexpectedResponse(format!(
+                "tag 0x{:02X}, expected 0x{tag:02X}",
+                r.tag
+            )));
+        }
+        r.response(cmd).ok_or_else(refused)
+    }
+
     /// Assign keys to an animation definition.
     ///
     /// `keys` is a slice of `(matrix_idx, phase_offset)` pairs.
@@ -1995,6 +2470,22 @@ impl KeyboardInterface {
         Ok(())
     }
 
+    /// Assign every key to a def in one packet (0xEA sub 0x20). Keys held by
+    /// a higher-priority def keep it. Needs [`PatchInfo::has_anim_spatial`].
+    pub fn anim_assign_all(&self, def_id: u8, phase_offset: u8) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::AnimAssignAll;
+        self.transport.query_command(
+            cmd::ANIM_CMD,
+            &AnimAssignAll {
+                def_id,
+                phase_offset,
+            }
+            .to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
     /// Cancel a specific animation definition and release its keys.
     pub fn anim_cancel(&self, def_id: u8) -> Result<(), KeyboardError> {
         self.transport.query_command(
@@ -2015,33 +2506,151 @@ impl KeyboardInterface {
         Ok(())
     }
 
+    /// Open a staged scene: subsequent define/assign/cancel/clear calls edit a
+    /// shadow copy while the live scene keeps playing.
+    ///
+    /// With `seed_from_live` the stage starts as a copy of the live scene,
+    /// otherwise empty. Staged packets don't touch live state, so they can be
+    /// sent back-to-back without waiting for the engine in between.
+    pub fn anim_stage(&self, seed_from_live: bool) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::ANIM_CMD,
+            &monsgeek_transport::command::AnimStage { seed_from_live }.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Swap the staged scene in once the firmware frame counter reaches
+    /// `at_frame` (see [`AnimStatus::frame_count`]); pass 0 for "next frame".
+    pub fn anim_commit(&self, at_frame: u32) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::ANIM_CMD,
+            &monsgeek_transport::command::AnimCommit { at_frame }.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Discard an open or armed stage.
+    pub fn anim_abort(&self) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::ANIM_CMD,
+            &monsgeek_transport::command::AnimAbort.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Save the live scene to the firmware's flash scene store.
+    ///
+    /// With `restore_on_wake` the keyboard brings the scene back by itself
+    /// after sleep and on USB connect, with no re-upload. Returns whether the
+    /// flash sector was rewritten (false if it already held this scene), or
+    /// `None` if the patch has no scene store.
+    pub fn anim_save(&self, restore_on_wake: bool) -> Result<Option<bool>, KeyboardError> {
+        use monsgeek_transport::command::{AnimSave, AnimSceneOpResponse};
+        match self
+            .transport
+            .query::<AnimSave, AnimSceneOpResponse>(&AnimSave { restore_on_wake })
+        {
+            Ok(r) => Ok(Some(r.done)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Replace the live scene with the one in the flash scene store.
+    ///
+    /// Returns whether a scene was loaded, or `None` if the patch has no
+    /// scene store.
+    pub fn anim_load(&self) -> Result<Option<bool>, KeyboardError> {
+        use monsgeek_transport::command::{AnimLoad, AnimSceneOpResponse};
+        match self
+            .transport
+            .query::<AnimLoad, AnimSceneOpResponse>(&AnimLoad)
+        {
+            Ok(r) => Ok(Some(r.done)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Query the flash scene store. Returns `None` if the patch has none.
+    pub fn anim_query_scene(
+        &self,
+    ) -> Result<Option<monsgeek_transport::command::AnimQuerySceneResponse>, KeyboardError> {
+        use monsgeek_transport::command::{AnimQueryScene, AnimQuerySceneResponse};
+        match self
+            .transport
+            .query::<AnimQueryScene, AnimQuerySceneResponse>(&AnimQueryScene)
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
     /// Query animation engine status.
     ///
+    /// Defs 8-31 are fetched with extra def-page queries only when
+    /// `active_count` says some are in use.
     /// Returns `None` if the firmware doesn't support the animation engine.
     pub fn anim_query(&self) -> Result<Option<AnimStatus>, KeyboardError> {
         use monsgeek_transport::command::{AnimQuery, AnimQueryResponse};
-        match self
+        let status_of = |d: monsgeek_transport::command::AnimDefStatusRaw| AnimDefStatus {
+            id: d.id,
+            num_kf: d.num_kf,
+            flags: d.flags,
+            priority: d.priority,
+            key_count: d.key_count,
+            duration_ticks: d.duration_ticks,
+        };
+        let r = match self
             .transport
             .query::<AnimQuery, AnimQueryResponse>(&AnimQuery)
         {
-            Ok(r) => Ok(Some(AnimStatus {
-                active_count: r.active_count,
-                frame_count: r.frame_count,
-                overlay_active: r.overlay_active,
-                defs: r
-                    .defs
-                    .into_iter()
-                    .map(|d| AnimDefStatus {
-                        id: d.id,
-                        num_kf: d.num_kf,
-                        flags: d.flags,
-                        priority: d.priority,
-                        key_count: d.key_count,
-                        duration_ticks: d.duration_ticks,
-                    })
-                    .collect(),
-            })),
-            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Ok(r) => r,
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => return Ok(None),
+            Err(e) => return Err(e.into()),
+        };
+        let mut defs: Vec<_> = r.defs.into_iter().map(status_of).collect();
+        let mut first = 8;
+        while defs.len() < r.active_count as usize {
+            match self.anim_query_defs(first)? {
+                Some(page) if first < page.max_defs => {
+                    defs.extend(page.defs.into_iter().map(status_of))
+                }
+                _ => break,
+            }
+            first += 8;
+        }
+        Ok(Some(AnimStatus {
+            active_count: r.active_count,
+            frame_count: r.frame_count,
+            overlay_active: r.overlay_active,
+            defs,
+            stage_state: r.stage_state,
+            commit_frame: r.commit_frame,
+        }))
+    }
+
+    /// Query eight def slots from `first` on, with the engine limits
+    /// (def count, keyframes per def, shared keyframe pool size and use).
+    ///
+    /// Returns `None` on patches without the keyframe pool, which have
+    /// 8 defs of 8 keyframes.
+    pub fn anim_query_defs(
+        &self,
+        first: u8,
+    ) -> Result<Option<monsgeek_transport::command::AnimQueryDefsResponse>, KeyboardError> {
+        use monsgeek_transport::command::{AnimQueryDefs, AnimQueryDefsResponse};
+        match self
+            .transport
+            .query::<AnimQueryDefs, AnimQueryDefsResponse>(&AnimQueryDefs { first })
+        {
+            Ok(r) if r.max_defs > 0 => Ok(Some(r)),
+            Ok(_) | Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
             Err(e) => Err(e.into()),
         }
     }
@@ -2060,6 +2669,254 @@ impl KeyboardInterface {
         }
     }
 
+    /// Read the cycle profile of one patch hook.
+    ///
+    /// Hook ids follow the firmware's PROF_* order (0 = LED blend, 1 = anim
+    /// tick, 2 = vendor cmd, 3 = HID setup, 4 = dongle reports, 5 = battery).
+    /// Returns `None` if the patch has no profiler.
+    pub fn prof_read(
+        &self,
+        hook: u8,
+    ) -> Result<Option<monsgeek_transport::command::ProfReadResponse>, KeyboardError> {
+        use monsgeek_transport::command::{ProfRead, ProfReadResponse};
+        match self
+            .transport
+            .query::<ProfRead, ProfReadResponse>(&ProfRead { hook })
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Read the scan-to-report latency histogram of one connection mode
+    /// (`LATENCY_USB`, `LATENCY_24G` or `LATENCY_BT` from
+    /// `monsgeek_transport::command`). Returns `None` if the patch has no
+    /// latency counters. Cleared together with the hook profiles.
+    pub fn latency_read(
+        &self,
+        mode: u8,
+    ) -> Result<Option<monsgeek_transport::command::LatencyReadResponse>, KeyboardError> {
+        use monsgeek_transport::command::{LatencyRead, LatencyReadResponse};
+        match self
+            .transport
+            .query::<LatencyRead, LatencyReadResponse>(&LatencyRead { mode })
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Zero all hook profiles.
+    pub fn prof_reset(&self) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::PROF_CMD,
+            &monsgeek_transport::command::ProfReset.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Stream scan timing and/or raw `adc_filtered_value` samples for up to
+    /// four keys on RTT up-channel 1 (see [`ProfStream`] for `flags`).
+    ///
+    /// [`ProfStream`]: monsgeek_transport::command::ProfStream
+    pub fn prof_stream(&self, flags: u8, decimation: u8, keys: &[u8]) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::PROF_CMD,
+            &monsgeek_transport::command::ProfStream {
+                flags,
+                decimation,
+                keys: keys.to_vec(),
+            }
+            .to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Emit cumulative hook profiles over RTT every `period_frames` LED
+    /// frames (0 disables).
+    pub fn prof_rtt(&self, period_frames: u16) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::PROF_CMD,
+            &monsgeek_transport::command::ProfRtt { period_frames }.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Shed LED work while the main loop runs over `budget_cycles` per pass
+    /// (0 disables; see [`FrameGovernor`]). Resets the governor counters.
+    ///
+    /// [`FrameGovernor`]: monsgeek_transport::command::FrameGovernor
+    pub fn set_frame_governor(&self, budget_cycles: u32, slices: u8) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::PROF_CMD,
+            &monsgeek_transport::command::FrameGovernor {
+                budget_cycles,
+                slices,
+            }
+            .to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Read the frame-budget governor's level and shed counters. Returns
+    /// `None` if the patch has no governor.
+    pub fn frame_governor_status(
+        &self,
+    ) -> Result<Option<monsgeek_transport::command::FrameGovernorStatus>, KeyboardError> {
+        use monsgeek_transport::command::{patch_reg, FrameGovernorStatus};
+        let regs = self.read_patch_registers(&[patch_reg::GOV])?;
+        Ok(regs
+            .iter()
+            .find(|(id, _)| *id == patch_reg::GOV)
+            .and_then(|(_, v)| FrameGovernorStatus::from_reg(v)))
+    }
+
+    /// Time `reps` repetitions of one LED hot-path kernel on the keyboard
+    /// (ids from `BENCH_KERNELS`). Returns `None` unless the patch was built
+    /// with `make BENCH=1`.
+    pub fn kernel_bench(
+        &self,
+        kernel: u8,
+        reps: u16,
+    ) -> Result<Option<monsgeek_transport::command::KernelBenchResponse>, KeyboardError> {
+        use monsgeek_transport::command::{KernelBench, KernelBenchResponse};
+        match self
+            .transport
+            .query::<KernelBench, KernelBenchResponse>(&KernelBench { kernel, reps })
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Switch depth monitor reports between stock single-key 0x1B reports
+    /// and packed multi-key frames (`DEPTH_MODE_PACKED`, USB only; wireless
+    /// keeps the stock path). The event reader expands packed frames back
+    /// into `VendorEvent::KeyDepth`, so subscribers see no difference.
+    pub fn set_depth_mode(&self, mode: u8) -> Result<(), KeyboardError> {
+        self.transport.query_command(
+            cmd::DEPTH_CMD,
+            &monsgeek_transport::command::DepthMode { mode }.to_data(),
+            ChecksumType::None,
+        )?;
+        Ok(())
+    }
+
+    /// Limit depth reports to `keys` (`None` = all keys), drop changes within
+    /// `deadband` of the last reported depth, and cap the report rate at
+    /// `max_rate_hz` (0 = uncapped). Applies to both the packed and the stock
+    /// report path; cleared again by `stop_magnetism_report`.
+    pub fn set_depth_filter(
+        &self,
+        keys: Option<&[u8]>,
+        deadband: u16,
+        max_rate_hz: u16,
+    ) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::DepthFilter;
+        let mut filter = keys.map_or_else(DepthFilter::off, DepthFilter::keys);
+        filter.deadband = deadband;
+        filter.max_rate_hz = max_rate_hz;
+        self.transport
+            .query_command(cmd::DEPTH_CMD, &filter.to_data(), ChecksumType::None)?;
+        Ok(())
+    }
+
+    /// Assign keys to the native HID gamepad axes X, Y, Z, Rx, Ry, Rz
+    /// (`None` = unused). Each axis then reports that key's filtered ADC
+    /// value straight from the keyboard over USB, no host daemon needed.
+    /// `invert` bit a flips axis a, for switches that read lower when pressed.
+    pub fn set_gamepad_axes(
+        &self,
+        keys: &[Option<u8>; monsgeek_transport::command::GAMEPAD_AXES],
+        invert: u8,
+    ) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::{GamepadAxes, GAMEPAD_AXIS_UNUSED};
+        let mut axes = GamepadAxes::off();
+        for (slot, key) in axes.keys.iter_mut().zip(keys) {
+            *slot = key.unwrap_or(GAMEPAD_AXIS_UNUSED);
+        }
+        axes.invert = invert;
+        self.transport
+            .query_command(cmd::GAMEPAD_CMD, &axes.to_data(), ChecksumType::None)?;
+        Ok(())
+    }
+
+    /// Read the gamepad axis assignment. Returns `None` without the patch.
+    pub fn gamepad_status(
+        &self,
+    ) -> Result<Option<monsgeek_transport::command::GamepadStatusResponse>, KeyboardError> {
+        use monsgeek_transport::command::{GamepadStatus, GamepadStatusResponse};
+        match self
+            .transport
+            .query::<GamepadStatus, GamepadStatusResponse>(&GamepadStatus)
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Subscribe to push telemetry: `fields` is a mask of `TELEM_*` from
+    /// `monsgeek_transport::command` (0 = off). A record (notif 0x1E) is sent
+    /// whenever the battery level moves by `bat_thresh` percent, the ADC
+    /// average by `adc_thresh` counts (0 = any change), or the charger or
+    /// power state changes, plus one right away as the baseline. Works on
+    /// USB and through the dongle.
+    pub fn subscribe_telemetry(
+        &self,
+        fields: u8,
+        bat_thresh: u8,
+        adc_thresh: u16,
+    ) -> Result<(), KeyboardError> {
+        use monsgeek_transport::command::TelemetrySubscribe;
+        let sub = TelemetrySubscribe {
+            fields,
+            bat_thresh,
+            adc_thresh,
+        };
+        self.transport
+            .query_command(cmd::TELEM_CMD, &sub.to_data(), ChecksumType::None)?;
+        Ok(())
+    }
+
+    /// Read the telemetry subscription and last reported values.
+    /// Returns `None` without the patch.
+    pub fn telemetry_status(
+        &self,
+    ) -> Result<Option<monsgeek_transport::command::TelemetryStatusResponse>, KeyboardError> {
+        use monsgeek_transport::command::{TelemetryStatus, TelemetryStatusResponse};
+        match self
+            .transport
+            .query::<TelemetryStatus, TelemetryStatusResponse>(&TelemetryStatus)
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
+    /// Read packed depth frame counters. Returns `None` without the patch.
+    pub fn depth_status(
+        &self,
+    ) -> Result<Option<monsgeek_transport::command::DepthStatusResponse>, KeyboardError> {
+        use monsgeek_transport::command::{DepthStatus, DepthStatusResponse};
+        match self
+            .transport
+            .query::<DepthStatus, DepthStatusResponse>(&DepthStatus)
+        {
+            Ok(r) => Ok(Some(r)),
+            Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => Ok(None),
+            Err(e) => Err(e.into()),
+        }
+    }
+
     /// Query patch info from modded firmware
     ///
     /// Returns `Some(PatchInfo)` if the keyboard is running patched firmware,
@@ -2093,6 +2950,53 @@ impl KeyboardInterface {
         }))
     }
 
+    /// List the patch's diagnostic registers as `(id, len)` pairs, reading
+    /// every directory page. Returns `None` without the register map.
+    pub fn patch_registers(&self) -> Result<Option<Vec<(u8, u8)>>, KeyboardError> {
+        use monsgeek_transport::command::{PatchRegDir, PatchRegDirResponse};
+        let mut regs = Vec::new();
+        loop {
+            let first = regs.len() as u8;
+            let page = match self
+                .transport
+                .query::<PatchRegDir, PatchRegDirResponse>(&PatchRegDir { first })
+            {
+                Ok(r) => r,
+                Err(monsgeek_transport::TransportError::InvalidResponse { .. }) => return Ok(None),
+                Err(e) => return Err(e.into()),
+            };
+            if page.entries.is_empty() {
+                break;
+            }
+            regs.extend(page.entries);
+            if regs.len() >= page.total as usize {
+                break;
+            }
+        }
+        Ok(Some(regs))
+    }
+
+    /// Read diagnostic registers by id (`patch_reg::*` from
+    /// `monsgeek_transport::command`). Registers that don't fit one response
+    /// are fetched with follow-up reads. Unknown ids come back empty.
+    pub fn read_patch_registers(&self, ids: &[u8]) -> Result<Vec<(u8, Vec<u8>)>, KeyboardError> {
+        use monsgeek_transport::command::{PatchRegRead, PatchRegReadResponse};
+        let mut out = Vec::with_capacity(ids.len());
+        let mut rest = ids.to_vec();
+        while !rest.is_empty() {
+            let chunk: Vec<u8> = rest.iter().copied().take(PatchRegRead::MAX_IDS).collect();
+            let resp = self
+                .transport
+                .query::<PatchRegRead, PatchRegReadResponse>(&PatchRegRead { ids: chunk })?;
+            if resp.regs.is_empty() {
+                break; // nothing fits: don't spin
+            }
+            rest.retain(|id| !resp.regs.iter().any(|(got, _)| got == id));
+            out.extend(resp.regs);
+        }
+        Ok(out)
+    }
+
     /// Query dongle patch info via HID Feature Report ID 8.
     ///
     /// Returns `Some(PatchInfo)` if the dongle is running patched firmware,
@@ -2122,6 +3026,18 @@ impl KeyboardInterface {
         }))
     }
 
+    /// Read the dongle's EP2 scheduler counters (Feature ID 8). Empty when
+    /// the dongle is stock, runs an older patch, or this isn't a dongle.
+    pub fn get_dongle_sched_stats(&self) -> Result<Vec<DongleSchedClass>, KeyboardError> {
+        Ok(self
+            .transport
+            .inner()
+            .get_dongle_patch_info()?
+            .filter(|buf| buf.len() >= 3 && buf[1] == 0xCA && buf[2] == 0xFE)
+            .map(|buf| parse_dongle_sched_stats(&buf))
+            .unwrap_or_default())
+    }
+
     /// Subscribe to timestamped vendor events via broadcast channel
     ///
     /// Returns a receiver for asynchronous vendor event notifications.
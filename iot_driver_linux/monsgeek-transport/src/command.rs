@@ -1804,6 +1804,9 @@ pub enum ParsedCommand {
         def_id: u8,
         count: u8,
     },
+    AnimAssignAll {
+        def_id: u8,
+    },
     AnimCancel {
         def_id: u8,
     },
@@ -1812,6 +1815,54 @@ pub enum ParsedCommand {
     AnimQueryKeys {
         def_id: u8,
     },
+    AnimQueryDefs {
+        first: u8,
+    },
+    AnimStage {
+        seed_from_live: bool,
+    },
+    AnimCommit {
+        at_frame: u32,
+    },
+    AnimAbort,
+    AnimSave {
+        restore_on_wake: bool,
+    },
+    AnimLoad,
+    AnimQueryScene,
+    /// PROF_CMD (0xEB) - hook profiler
+    Prof {
+        /// 0x00 = read, 0x01 = reset, 0x02 = RTT period, 0x03 = RTT stream,
+        /// 0x04 = latency
+        subcmd: u8,
+    },
+    /// DEPTH_CMD (0xEC) - packed depth frames
+    Depth {
+        /// 0x00 = read status, 0x01 = mode, 0x02 = filter
+        subcmd: u8,
+    },
+    /// GAMEPAD_CMD (0xED) - native HID gamepad axes
+    Gamepad {
+        /// 0x00 = read, 0x01 = set axes
+        subcmd: u8,
+    },
+    /// TELEM_CMD (0xEE) - push telemetry subscription
+    Telemetry {
+        /// 0x00 = read, 0x01 = subscribe
+        subcmd: u8,
+    },
+    /// BUNDLE (0xEF) - several patch packets in one report
+    Bundle {
+        /// Command byte of each entry
+        cmds: Vec<u8>,
+    },
+    /// BUNDLE (0xEF) sub 0xFF - one patch command under a host tag
+    Tagged {
+        /// Host-chosen tag echoed in the completion
+        tag: u8,
+        /// Command byte of the tagged command
+        cmd: u8,
+    },
     /// Command we don't have a parser for yet
     Unknown {
         cmd: u8,
@@ -2188,8 +2239,51 @@ pub fn try_parse_command(data: &[u8]) -> ParsedCommand {
                     ]),
                 },
                 0x10..=0x17 => ParsedCommand::AnimDefineExt { def_id: sub & 0x07 },
+                0x18 => ParsedCommand::AnimStage {
+                    seed_from_live: data.get(2).copied().unwrap_or(0) & 0x01 != 0,
+                },
+                0x19 => ParsedCommand::AnimCommit {
+                    at_frame: u32::from_le_bytes([
+                        data.get(2).copied().unwrap_or(0),
+                        data.get(3).copied().unwrap_or(0),
+                        data.get(4).copied().unwrap_or(0),
+                        data.get(5).copied().unwrap_or(0),
+                    ]),
+                },
+                0x1A => ParsedCommand::AnimAbort,
+                0x1B => ParsedCommand::AnimAssignKeys {
+                    def_id: data.get(2).copied().unwrap_or(0),
+                    count: data.get(3).copied().unwrap_or(0),
+                },
+                0x1C => ParsedCommand::AnimDefine {
+                    def_id: data.get(2).copied().unwrap_or(0),
+                    num_kf: data.get(3).copied().unwrap_or(0),
+                    flags: data.get(4).copied().unwrap_or(0),
+                    priority: data.get(5).copied().unwrap_or(0) as i8,
+                    duration_ticks: u16::from_le_bytes([
+                        data.get(6).copied().unwrap_or(0),
+                        data.get(7).copied().unwrap_or(0),
+                    ]),
+                },
+                0x1D => ParsedCommand::AnimDefineExt {
+                    def_id: data.get(2).copied().unwrap_or(0),
+                },
+                0x1E => ParsedCommand::AnimSave {
+                    restore_on_wake: data.get(2).copied().unwrap_or(0) & 0x01 != 0,
+                },
+                0x1F => ParsedCommand::AnimLoad,
+                0x20 => ParsedCommand::AnimAssignAll {
+                    def_id: data.get(2).copied().unwrap_or(0),
+                },
                 0xF0 => ParsedCommand::AnimQuery,
                 0xF1..=0xF8 => ParsedCommand::AnimQueryKeys { def_id: sub - 0xF1 },
+                0xF9 => ParsedCommand::AnimQueryDefs {
+                    first: data.get(2).copied().unwrap_or(0),
+                },
+                0xFA => ParsedCommand::AnimQueryKeys {
+                    def_id: data.get(2).copied().unwrap_or(0),
+                },
+                0xFB => ParsedCommand::AnimQueryScene,
                 0xFE => ParsedCommand::AnimCancel {
                     def_id: data.get(2).copied().unwrap_or(0),
                 },
@@ -2200,6 +2294,27 @@ pub fn try_parse_command(data: &[u8]) -> ParsedCommand {
                 },
             }
         }
+        cmd::PROF_CMD => ParsedCommand::Prof {
+            subcmd: data.get(1).copied().unwrap_or(0),
+        },
+        cmd::DEPTH_CMD => ParsedCommand::Depth {
+            subcmd: data.get(1).copied().unwrap_or(0),
+        },
+        cmd::GAMEPAD_CMD => ParsedCommand::Gamepad {
+            subcmd: data.get(1).copied().unwrap_or(0),
+        },
+        cmd::TELEM_CMD => ParsedCommand::Telemetry {
+            subcmd: data.get(1).copied().unwrap_or(0),
+        },
+        cmd::BUNDLE if data.get(1) == Some(&TaggedCommand::MARKER) => ParsedCommand::Tagged {
+            tag: data.get(2).copied().unwrap_or(0),
+            cmd: data.get(3).copied().unwrap_or(0),
+        },
+        cmd::BUNDLE => ParsedCommand::Bundle {
+            cmds: CommandBundle::entries(&data[1..])
+                .map(|(cmd, _)| cmd)
+                .collect(),
+        },
 
         _ => ParsedCommand::Unknown {
             cmd,
@@ -2233,7 +2348,18 @@ fn parse_led_params_command(data: &[u8]) -> Option<LedParamsResponse> {
 // Animation engine commands (0xEA)
 // =============================================================================
 
-/// Define an animation (0xEA sub 0x08-0x0F).
+/// Short-form 0xEA sub-commands carry the def id in their low 3 bits (defs
+/// 0-7). Wide forms reach every def: `wide_sub`, the def id, then the same
+/// payload as the short form.
+fn anim_wide_form(mut data: Vec<u8>, wide_sub: u8, def_id: u8) -> Vec<u8> {
+    if def_id >= 8 {
+        data[0] = wide_sub;
+        data.insert(1, def_id);
+    }
+    data
+}
+
+/// Define an animation (0xEA sub 0x08-0x0F, or 0x1C for defs 8-31).
 /// Keyframes are (t_ticks_le16, color_rgb565_le16, easing_u8) — 5 bytes each.
 #[derive(Debug, Clone)]
 pub struct AnimDefine {
@@ -2242,8 +2368,15 @@ pub struct AnimDefine {
     pub flags: u8,
     pub priority: i8,
     pub duration_ticks: u16,
-    /// Up to 8 keyframes: (t_ticks, color_rgb565, easing).
+    /// Keyframes: (t_ticks, color_rgb565, easing). This packet carries the
+    /// first 4; [`AnimDefineExt`] carries the rest.
     pub keyframes: Vec<(u16, u16, u8)>,
+    /// Trigger defs (flag 0x08): radius in matrix cells around the pressed
+    /// key. Spatial defs: [`AnimSpatial::reach`].
+    pub reach: u8,
+    /// Ticks per cell of distance: the ripple delay of a trigger def, the
+    /// phase step of a spatial def.
+    pub spread: u8,
 }
 
 impl HidCommand for AnimDefine {
@@ -2251,7 +2384,7 @@ impl HidCommand for AnimDefine {
     const CHECKSUM: ChecksumType = ChecksumType::None;
 
     fn to_data(&self) -> Vec<u8> {
-        let mut data = vec![0u8; 26];
+        let mut data = vec![0u8; 28];
         data[0] = 0x08 | (self.def_id & 0x07);
         data[1] = self.num_kf;
         data[2] = self.flags;
@@ -2264,15 +2397,71 @@ impl HidCommand for AnimDefine {
             data[off + 2..off + 4].copy_from_slice(&c565.to_le_bytes());
             data[off + 4] = easing;
         }
-        data
+        data[26] = self.reach;
+        data[27] = self.spread;
+        anim_wide_form(data, 0x1C, self.def_id)
+    }
+}
+
+impl AnimDefine {
+    /// Keyframes per definition.
+    pub const MAX_KF: usize = 16;
+    /// Definition slots on patches with the keyframe pool (8 before it).
+    pub const MAX_DEFS: u8 = 32;
+}
+
+/// Spatial phase pattern of a looping or one-shot def (DEF flag bits 4-5).
+/// At assign time the firmware adds each key's distance along the pattern,
+/// in matrix cells times the def's `spread`, to its phase_offset, so one
+/// [`AnimAssignAll`] paints a whole-board wave.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AnimSpatial {
+    /// Plane wave travelling at `angle`, in 256ths of a turn (0 = rightward,
+    /// 64 = downward), starting from the board corner it enters at.
+    Linear { angle: u8 },
+    /// Rings around the key at matrix position `origin` (row * 16 + col).
+    Radial { origin: u8 },
+    /// Whole columns or rows in turn.
+    Sweep(AnimSweep),
+}
+
+/// Direction of an [`AnimSpatial::Sweep`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AnimSweep {
+    LeftToRight = 0,
+    RightToLeft = 1,
+    TopToBottom = 2,
+    BottomToTop = 3,
+}
+
+impl AnimSpatial {
+    /// DEF flag bits holding the pattern.
+    pub const FLAG_MASK: u8 = 0x30;
+
+    /// DEF flag bits for this pattern.
+    pub fn flags(self) -> u8 {
+        match self {
+            AnimSpatial::Linear { .. } => 0x10,
+            AnimSpatial::Radial { .. } => 0x20,
+            AnimSpatial::Sweep(_) => 0x30,
+        }
+    }
+
+    /// Pattern argument, sent in [`AnimDefine::reach`].
+    pub fn reach(self) -> u8 {
+        match self {
+            AnimSpatial::Linear { angle } => angle,
+            AnimSpatial::Radial { origin } => origin,
+            AnimSpatial::Sweep(dir) => dir as u8,
+        }
     }
 }
 
-/// Continuation keyframes 4-7 (0xEA sub 0x10-0x17).
+/// Continuation keyframes 4-15 (0xEA sub 0x10-0x17, or 0x1D for defs 8-31).
 #[derive(Debug, Clone)]
 pub struct AnimDefineExt {
     pub def_id: u8,
-    pub keyframes: Vec<(u16, u16, u8)>, // KFs 4-7
+    pub keyframes: Vec<(u16, u16, u8)>, // KFs 4..
 }
 
 impl HidCommand for AnimDefineExt {
@@ -2280,19 +2469,21 @@ impl HidCommand for AnimDefineExt {
     const CHECKSUM: ChecksumType = ChecksumType::None;
 
     fn to_data(&self) -> Vec<u8> {
-        let mut data = vec![0u8; 21];
+        let n = self.keyframes.len().clamp(4, AnimDefine::MAX_KF - 4);
+        let mut data = vec![0u8; 1 + n * 5];
         data[0] = 0x10 | (self.def_id & 0x07);
-        for (i, &(t, c565, easing)) in self.keyframes.iter().enumerate().take(4) {
+        for (i, &(t, c565, easing)) in self.keyframes.iter().enumerate().take(n) {
             let off = 1 + i * 5;
             data[off..off + 2].copy_from_slice(&t.to_le_bytes());
             data[off + 2..off + 4].copy_from_slice(&c565.to_le_bytes());
             data[off + 4] = easing;
         }
-        data
+        anim_wide_form(data, 0x1D, self.def_id)
     }
 }
 
-/// Assign keys to an animation definition (0xEA sub 0x00-0x07).
+/// Assign keys to an animation definition (0xEA sub 0x00-0x07, or 0x1B for
+/// defs 8-31).
 #[derive(Debug, Clone)]
 pub struct AnimAssign {
     pub def_id: u8,
@@ -2313,7 +2504,24 @@ impl HidCommand for AnimAssign {
             data[2 + i * 2] = idx;
             data[2 + i * 2 + 1] = phase;
         }
-        data
+        anim_wide_form(data, 0x1B, self.def_id)
+    }
+}
+
+/// Assign every key to a def (0xEA sub 0x20), subject to the same priority
+/// check as [`AnimAssign`].
+#[derive(Debug, Clone)]
+pub struct AnimAssignAll {
+    pub def_id: u8,
+    pub phase_offset: u8,
+}
+
+impl HidCommand for AnimAssignAll {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x20, self.def_id, self.phase_offset]
     }
 }
 
@@ -2345,6 +2553,60 @@ impl HidCommand for AnimClear {
     }
 }
 
+/// Open a staged scene (0xEA sub 0x18).
+///
+/// While a stage is open, DEF/DEF_EXT/ASSIGN/CANCEL/CLEAR edit a shadow copy
+/// of the engine tables; the live scene keeps playing untouched until
+/// [`AnimCommit`] swaps the stage in.
+#[derive(Debug, Clone)]
+pub struct AnimStage {
+    /// Start from a copy of the live scene instead of an empty one.
+    pub seed_from_live: bool,
+}
+
+impl HidCommand for AnimStage {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x18, self.seed_from_live as u8]
+    }
+}
+
+/// Close the open stage and swap it in at a frame (0xEA sub 0x19).
+///
+/// The firmware applies the stage on the first tick where its `frame_count`
+/// reaches `at_frame`; a frame already in the past (e.g. 0) applies on the
+/// next tick. All staged defs restart together on that frame.
+#[derive(Debug, Clone)]
+pub struct AnimCommit {
+    pub at_frame: u32,
+}
+
+impl HidCommand for AnimCommit {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let mut data = vec![0x19];
+        data.extend_from_slice(&self.at_frame.to_le_bytes());
+        data
+    }
+}
+
+/// Discard the open or armed stage (0xEA sub 0x1A).
+#[derive(Debug, Clone)]
+pub struct AnimAbort;
+
+impl HidCommand for AnimAbort {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x1A]
+    }
+}
+
 /// Query animation engine status (0xEA sub 0xF0).
 #[derive(Debug, Clone)]
 pub struct AnimQuery;
@@ -2376,6 +2638,10 @@ pub struct AnimQueryResponse {
     pub frame_count: u32,
     pub overlay_active: bool,
     pub defs: Vec<AnimDefStatusRaw>,
+    /// Stage state: 0 = idle, 1 = open, 2 = armed (0 on older patches).
+    pub stage_state: u8,
+    /// Frame an armed stage will be swapped in at.
+    pub commit_frame: u32,
 }
 
 impl HidResponse for AnimQueryResponse {
@@ -2412,16 +2678,29 @@ impl HidResponse for AnimQueryResponse {
             });
         }
 
+        // Stage fields were appended later; older patches leave them zero
+        let (stage_state, commit_frame) = if data.len() >= 61 {
+            (
+                data[56],
+                u32::from_le_bytes([data[57], data[58], data[59], data[60]]),
+            )
+        } else {
+            (0, 0)
+        };
+
         Ok(Self {
             active_count,
             frame_count,
             overlay_active,
             defs,
+            stage_state,
+            commit_frame,
         })
     }
 }
 
-/// Query key assignments for one def (0xEA sub 0xF1-0xF8).
+/// Query key assignments for one def (0xEA sub 0xF1-0xF8, or 0xFA for defs
+/// 8-31).
 #[derive(Debug, Clone)]
 pub struct AnimQueryKeys {
     pub def_id: u8,
@@ -2432,7 +2711,11 @@ impl HidCommand for AnimQueryKeys {
     const CHECKSUM: ChecksumType = ChecksumType::None;
 
     fn to_data(&self) -> Vec<u8> {
-        vec![0xF1 + (self.def_id & 0x07)]
+        if self.def_id >= 8 {
+            vec![0xFA, self.def_id]
+        } else {
+            vec![0xF1 + self.def_id]
+        }
     }
 }
 
@@ -2448,20 +2731,24 @@ impl HidResponse for AnimQueryKeysResponse {
     const MIN_LEN: usize = 3; // echo + sub + count
 
     fn from_data(data: &[u8]) -> Result<Self, ParseError> {
-        // data[0] = 0xEA, data[1] = sub echo (0xF1-0xF8), data[2] = count
-        let expected_range = 0xF1..=0xF8;
+        // data[0] = 0xEA, data[1] = sub echo (0xF1-0xF8), data[2] = count;
+        // wide form: data[1] = 0xFA, data[2] = def echo, data[3] = count
         let sub = data.get(1).copied().unwrap_or(0);
-        if !expected_range.contains(&sub) {
-            return Err(ParseError::CommandMismatch {
-                expected: 0xF1,
-                got: sub,
-            });
-        }
+        let start = match sub {
+            0xF1..=0xF8 => 2,
+            0xFA => 3,
+            _ => {
+                return Err(ParseError::CommandMismatch {
+                    expected: 0xF1,
+                    got: sub,
+                })
+            }
+        };
 
-        let count = data.get(2).copied().unwrap_or(0) as usize;
+        let count = data.get(start).copied().unwrap_or(0) as usize;
         let mut keys = Vec::with_capacity(count);
         for i in 0..count {
-            let base = 3 + i * 2;
+            let base = start + 1 + i * 2;
             if base + 1 < data.len() {
                 keys.push((data[base], data[base + 1]));
             }
@@ -2470,103 +2757,1263 @@ impl HidResponse for AnimQueryKeysResponse {
     }
 }
 
-// Tests
-// =============================================================================
-
-#[cfg(test)]
-mod tests {
-    use super::*;
-    use crate::protocol::REPORT_SIZE;
+/// Query eight def slots from `first` on, plus the engine limits (0xEA sub
+/// 0xF9). Reaches defs 8-31, which [`AnimQuery`] does not report.
+#[derive(Debug, Clone)]
+pub struct AnimQueryDefs {
+    pub first: u8,
+}
 
-    #[test]
-    fn test_set_led_params_builder() {
-        let cmd = SetLedParams::new()
-            .mode(LedMode::Wave)
-            .brightness(4)
-            .speed(3)
-            .color(255, 0, 128)
-            .dazzle(true);
+impl HidCommand for AnimQueryDefs {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
 
-        let data = cmd.to_data();
-        assert_eq!(data[0], LedMode::Wave as u8); // mode
-        assert_eq!(data[1], 1); // speed inverted: 4 - 3 = 1
-        assert_eq!(data[2], 4); // brightness
-        assert_eq!(data[3], DAZZLE_ON); // dazzle
-        assert_eq!(data[4], 255); // R
-        assert_eq!(data[5], 0); // G
-        assert_eq!(data[6], 128); // B
+    fn to_data(&self) -> Vec<u8> {
+        vec![0xF9, self.first]
     }
+}
 
-    #[test]
-    fn test_set_led_params_user_picture() {
-        let cmd = SetLedParams::new()
-            .mode(LedMode::UserPicture)
-            .layer(2)
-            .color(255, 0, 0); // Should be ignored
+/// Def-page query response.
+#[derive(Debug, Clone)]
+pub struct AnimQueryDefsResponse {
+    pub first: u8,
+    /// Slots in use among the eight queried.
+    pub defs: Vec<AnimDefStatusRaw>,
+    /// 0 on patches without the keyframe pool, which pass 0xF9 through.
+    pub max_defs: u8,
+    pub max_kf: u8,
+    /// Keyframe pool shared by all defs, live and staged.
+    pub pool_kf: u8,
+    /// Pool keyframes held by live defs.
+    pub pool_held: u8,
+}
 
-        let data = cmd.to_data();
-        assert_eq!(data[0], LedMode::UserPicture as u8);
-        assert_eq!(data[3], 2 << 4); // layer in option
-        assert_eq!(data[4], 0); // Fixed R
-        assert_eq!(data[5], 200); // Fixed G
-        assert_eq!(data[6], 200); // Fixed B
+impl HidResponse for AnimQueryDefsResponse {
+    const CMD_ECHO: u8 = cmd::ANIM_CMD;
+    const MIN_LEN: usize = 55; // echo + sub + first + 48 (8×6) + 4 limits
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0xF9) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0xF9,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let first = data[2];
+        let mut defs = Vec::new();
+        for d in 0..8u8 {
+            let base = 3 + d as usize * 6;
+            let num_kf = data[base];
+            if num_kf == 0 {
+                continue;
+            }
+            defs.push(AnimDefStatusRaw {
+                id: first.wrapping_add(d),
+                num_kf,
+                flags: data[base + 1],
+                priority: data[base + 2] as i8,
+                key_count: data[base + 3],
+                duration_ticks: u16::from_le_bytes([data[base + 4], data[base + 5]]),
+            });
+        }
+        Ok(Self {
+            first,
+            defs,
+            max_defs: data[51],
+            max_kf: data[52],
+            pool_kf: data[53],
+            pool_held: data[54],
+        })
     }
+}
 
-    #[test]
-    fn test_led_params_response_parse() {
-        // Simulated response: [cmd_echo, mode, speed_inv, brightness, option, r, g, b]
-        let data = [0x87, 4, 1, 3, DAZZLE_ON, 128, 64, 32];
+/// Store the live scene in the firmware's flash scene store (0xEA sub 0x1E).
+///
+/// With `restore_on_wake` the firmware reloads the scene by itself after
+/// sleep and on USB connect, so the host doesn't have to replay the upload.
+/// In-flight TRIGGER keys and defs still waiting on DEF_EXT are left out of
+/// the saved scene and also dropped from the live one. The firmware skips
+/// the flash erase when the store already holds the same scene. Reply:
+/// [`AnimSceneOpResponse`].
+#[derive(Debug, Clone)]
+pub struct AnimSave {
+    pub restore_on_wake: bool,
+}
 
-        let resp = LedParamsResponse::parse(&data).unwrap();
-        assert_eq!(resp.mode, LedMode::Wave);
-        assert_eq!(resp.speed, 3); // 4 - 1 = 3 (inverted back)
-        assert_eq!(resp.brightness, 3);
-        assert!(resp.dazzle);
-        assert_eq!(resp.color.r, 128);
+impl HidCommand for AnimSave {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x1E, self.restore_on_wake as u8]
     }
+}
 
-    #[test]
-    fn test_polling_rate() {
-        // Frame is [cmd, 0, code, ...] — the code sits two bytes after the command,
-        // not one. Writing it at offset 1 leaves offset 2 zero, which the firmware
-        // reads as code 0 (8 kHz), so every rate change silently became 8 kHz.
-        let cmd = SetPollingRate::from_hz(1000).unwrap();
-        assert_eq!(cmd.to_data(), vec![0, 3]); // 1000Hz = protocol value 3
+/// Replace the live scene with the stored one now (0xEA sub 0x1F). Any open
+/// or armed stage is dropped. Reply: [`AnimSceneOpResponse`].
+#[derive(Debug, Clone)]
+pub struct AnimLoad;
 
-        let resp_data = [0x83, 0, 3];
-        let resp = PollingRateResponse::parse(&resp_data).unwrap();
-        assert_eq!(resp.rate.to_hz(), 1000);
+impl HidCommand for AnimLoad {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
 
-        // A frame truncated before the code must fail rather than decode as 8 kHz.
-        assert!(PollingRateResponse::parse(&[0x83, 0]).is_err());
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x1F]
     }
+}
 
-    #[test]
-    fn test_sleep_time() {
-        // Test command with 4 values: idle=120s, deep=1680s for both modes
-        let cmd = SetSleepTime::uniform(120, 1680);
-        let data = cmd.to_data();
-        // Data should be 15 bytes with values at indices 7-14
-        assert_eq!(data.len(), 15);
-        // idle_bt at [7..9]: 120 = 0x0078 LE
-        assert_eq!(data[7], 0x78);
-        assert_eq!(data[8], 0x00);
-        // idle_24g at [9..11]: 120 = 0x0078 LE
-        assert_eq!(data[9], 0x78);
-        assert_eq!(data[10], 0x00);
-        // deep_bt at [11..13]: 1680 = 0x0690 LE
-        assert_eq!(data[11], 0x90);
-        assert_eq!(data[12], 0x06);
-        // deep_24g at [13..15]: 1680 = 0x0690 LE
-        assert_eq!(data[13], 0x90);
-        assert_eq!(data[14], 0x06);
+/// Result of [`AnimSave`] or [`AnimLoad`].
+#[derive(Debug, Clone)]
+pub struct AnimSceneOpResponse {
+    /// Sub-command echo (0x1E save, 0x1F load).
+    pub sub: u8,
+    /// Save: the flash sector was rewritten (false: it already held this
+    /// scene). Load: a scene was loaded (false: none stored for this patch
+    /// build).
+    pub done: bool,
+}
 
-        // Test response parsing (16 bytes minimum with values at indices 8-15)
-        let mut resp_data = [0u8; 16];
-        resp_data[0] = 0x91; // command echo
-                             // idle_bt = 120 at [8..10]
-        resp_data[8] = 0x78;
-        resp_data[9] = 0x00;
+impl HidResponse for AnimSceneOpResponse {
+    const CMD_ECHO: u8 = cmd::ANIM_CMD;
+    const MIN_LEN: usize = 3; // echo + sub + result
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        match data[1] {
+            sub @ (0x1E | 0x1F) => Ok(Self {
+                sub,
+                done: data[2] != 0,
+            }),
+            got => Err(ParseError::CommandMismatch {
+                expected: 0x1E,
+                got,
+            }),
+        }
+    }
+}
+
+/// Query the flash scene store (0xEA sub 0xFB).
+#[derive(Debug, Clone)]
+pub struct AnimQueryScene;
+
+impl HidCommand for AnimQueryScene {
+    const CMD: u8 = cmd::ANIM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0xFB]
+    }
+}
+
+/// Scene store query response.
+#[derive(Debug, Clone)]
+pub struct AnimQuerySceneResponse {
+    /// A scene saved by this patch build is stored.
+    pub stored: bool,
+    /// The stored scene is restored on wake and USB connect.
+    pub restore_on_wake: bool,
+    /// Defs in the stored scene.
+    pub defs: u8,
+    /// Keys assigned in the stored scene.
+    pub keys: u8,
+    /// Scenes restored on wake / connect since boot (saturates at 255).
+    pub restores: u8,
+}
+
+impl HidResponse for AnimQuerySceneResponse {
+    const CMD_ECHO: u8 = cmd::ANIM_CMD;
+    const MIN_LEN: usize = 7; // echo + sub + 5
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data[1] != 0xFB {
+            return Err(ParseError::CommandMismatch {
+                expected: 0xFB,
+                got: data[1],
+            });
+        }
+        Ok(Self {
+            stored: data[2] != 0,
+            restore_on_wake: data[3] & 0x01 != 0,
+            defs: data[4],
+            keys: data[5],
+            restores: data[6],
+        })
+    }
+}
+
+/// Read one hook's profile slot (0xEB sub 0x00).
+#[derive(Debug, Clone)]
+pub struct ProfRead {
+    pub hook: u8,
+}
+
+impl HidCommand for ProfRead {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x00, self.hook]
+    }
+}
+
+/// Zero all hook profile slots (0xEB sub 0x01).
+#[derive(Debug, Clone)]
+pub struct ProfReset;
+
+impl HidCommand for ProfReset {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x01]
+    }
+}
+
+/// Set the RTT profile dump period in LED frames, 0 = off (0xEB sub 0x02).
+#[derive(Debug, Clone)]
+pub struct ProfRtt {
+    pub period_frames: u16,
+}
+
+impl HidCommand for ProfRtt {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let p = self.period_frames.to_le_bytes();
+        vec![0x02, p[0], p[1]]
+    }
+}
+
+/// Configure the RTT stream channel (0xEB sub 0x03).
+///
+/// Records are emitted once per main-loop scan (every `decimation` scans)
+/// on RTT up-channel 1.
+#[derive(Debug, Clone)]
+pub struct ProfStream {
+    /// Bit 0: scan period records, bit 1: `adc_filtered_value` records. 0 = off.
+    pub flags: u8,
+    pub decimation: u8,
+    /// Magnetism key indices to sample; unused slots are sent as 0xFF.
+    pub keys: Vec<u8>,
+}
+
+impl HidCommand for ProfStream {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let mut data = vec![0x03, self.flags, self.decimation, 0xFF, 0xFF, 0xFF, 0xFF];
+        for (slot, &k) in data[3..].iter_mut().zip(self.keys.iter()) {
+            *slot = k;
+        }
+        data
+    }
+}
+
+/// Hook profile slot (response to [`ProfRead`]). All times in CPU cycles.
+#[derive(Debug, Clone)]
+pub struct ProfReadResponse {
+    pub hook: u8,
+    pub num_hooks: u8,
+    pub count: u32,
+    pub min_cycles: u32,
+    pub max_cycles: u32,
+    pub total_cycles: u64,
+    /// log2 histogram: bin 0 < 512 cycles, bin k < 512 << k, bin 7 everything above.
+    pub hist: [u16; 8],
+    /// DWT cycle counter at the time of the read.
+    pub cyccnt: u32,
+    /// RTT stream records dropped because the ring was full.
+    pub stream_drops: u16,
+}
+
+impl HidResponse for ProfReadResponse {
+    const CMD_ECHO: u8 = cmd::PROF_CMD;
+    const MIN_LEN: usize = 46; // echo + sub + hook + n + 3×4 + 8 + 16 + 4 + 2
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        // data[0] = cmd echo (0xEB), data[1] = sub echo (0x00)
+        if data.get(1) != Some(&0x00) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x00,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let le32 = |i: usize| u32::from_le_bytes([data[i], data[i + 1], data[i + 2], data[i + 3]]);
+        let mut hist = [0u16; 8];
+        for (i, h) in hist.iter_mut().enumerate() {
+            *h = u16::from_le_bytes([data[24 + i * 2], data[25 + i * 2]]);
+        }
+        Ok(Self {
+            hook: data[2],
+            num_hooks: data[3],
+            count: le32(4),
+            min_cycles: le32(8),
+            max_cycles: le32(12),
+            total_cycles: le32(16) as u64 | (le32(20) as u64) << 32,
+            hist,
+            cyccnt: le32(40),
+            stream_drops: u16::from_le_bytes([data[44], data[45]]),
+        })
+    }
+}
+
+/// Latency connection modes for [`LatencyRead`].
+pub const LATENCY_USB: u8 = 0;
+pub const LATENCY_24G: u8 = 1;
+pub const LATENCY_BT: u8 = 2;
+
+/// Read the scan-to-report latency of one connection mode (0xEB sub 0x04).
+#[derive(Debug, Clone)]
+pub struct LatencyRead {
+    /// `LATENCY_USB`, `LATENCY_24G` or `LATENCY_BT`.
+    pub mode: u8,
+}
+
+impl HidCommand for LatencyRead {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x04, self.mode]
+    }
+}
+
+/// Scan-to-report latency of one connection mode (response to
+/// [`LatencyRead`]). Times in CPU cycles (216 MHz), from key edge until
+/// the keyboard report leaves for the endpoint.
+#[derive(Debug, Clone)]
+pub struct LatencyReadResponse {
+    pub mode: u8,
+    pub num_modes: u8,
+    pub count: u32,
+    pub min_cycles: u32,
+    pub max_cycles: u32,
+    pub total_cycles: u64,
+    /// log2 histogram: bin 0 < 32768 cycles (152 µs), bin k < 32768 << k,
+    /// bin 7 everything above.
+    pub hist: [u16; 8],
+    /// DWT cycle counter at the time of the read.
+    pub cyccnt: u32,
+    /// Key edges that got no report within ~78 ms (all modes).
+    pub stale: u16,
+}
+
+impl HidResponse for LatencyReadResponse {
+    const CMD_ECHO: u8 = cmd::PROF_CMD;
+    const MIN_LEN: usize = 46; // same layout as ProfReadResponse
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        // data[0] = cmd echo (0xEB), data[1] = sub echo (0x04)
+        if data.get(1) != Some(&0x04) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x04,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let le32 = |i: usize| u32::from_le_bytes([data[i], data[i + 1], data[i + 2], data[i + 3]]);
+        let mut hist = [0u16; 8];
+        for (i, h) in hist.iter_mut().enumerate() {
+            *h = u16::from_le_bytes([data[24 + i * 2], data[25 + i * 2]]);
+        }
+        Ok(Self {
+            mode: data[2],
+            num_modes: data[3],
+            count: le32(4),
+            min_cycles: le32(8),
+            max_cycles: le32(12),
+            total_cycles: le32(16) as u64 | (le32(20) as u64) << 32,
+            hist,
+            cyccnt: le32(40),
+            stale: u16::from_le_bytes([data[44], data[45]]),
+        })
+    }
+}
+
+/// Configure the frame-budget governor (0xEB sub 0x05).
+///
+/// While the main-loop period (between LED blend calls) runs over
+/// `budget_cycles`, the firmware sheds LED work: first the animation tick
+/// evaluates one of `slices` key slices per frame, then frames that still
+/// breach the budget hold the previous LED frame. `budget_cycles = 0`
+/// turns it off. Any write resets the level and counters.
+#[derive(Debug, Clone)]
+pub struct FrameGovernor {
+    pub budget_cycles: u32,
+    /// Animation key slices when shedding; below 2 selects the default (4).
+    pub slices: u8,
+}
+
+impl HidCommand for FrameGovernor {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let b = self.budget_cycles.to_le_bytes();
+        vec![0x05, b[0], b[1], b[2], b[3], self.slices]
+    }
+}
+
+/// Frame-budget governor state (register [`patch_reg::GOV`]). Times in CPU
+/// cycles (216 MHz).
+#[derive(Debug, Clone, PartialEq)]
+pub struct FrameGovernorStatus {
+    pub budget_cycles: u32,
+    /// Last main-loop period
+    pub period_cycles: u32,
+    pub max_period_cycles: u32,
+    /// Loop periods over budget
+    pub over: u32,
+    /// Frames whose animation tick ran one slice only
+    pub shed_ticks: u32,
+    /// Frames that kept the previous LED frame
+    pub shed_blends: u32,
+    pub slices: u8,
+    /// 0 = not shedding, 1 = sliced animation tick, 2 = skipping frames too
+    pub level: u8,
+}
+
+impl FrameGovernorStatus {
+    /// Parse the register value; `None` if it is too short.
+    pub fn from_reg(v: &[u8]) -> Option<Self> {
+        if v.len() < 26 {
+            return None;
+        }
+        let le32 = |i: usize| u32::from_le_bytes([v[i], v[i + 1], v[i + 2], v[i + 3]]);
+        Some(Self {
+            budget_cycles: le32(0),
+            period_cycles: le32(4),
+            max_period_cycles: le32(8),
+            over: le32(12),
+            shed_ticks: le32(16),
+            shed_blends: le32(20),
+            slices: v[24],
+            level: v[25],
+        })
+    }
+}
+
+/// Kernel ids for [`KernelBench`], in the firmware's BENCH_* order.
+pub const BENCH_KERNELS: [&str; 6] = ["ease", "hsv", "ws2812", "anim_eval", "anim_tick", "blend"];
+
+/// Time one LED hot-path kernel on the keyboard (0xEB sub 0x06).
+///
+/// Only patches built with `make BENCH=1` answer; others leave the command
+/// to the stock handler. The anim kernels advance the live scene and the
+/// ws2812 / blend kernels rewrite the DMA frame, as extra LED frames would.
+#[derive(Debug, Clone)]
+pub struct KernelBench {
+    /// Index into [`BENCH_KERNELS`].
+    pub kernel: u8,
+    /// Repetitions, 0 = 1, capped at 1000 by the firmware.
+    pub reps: u16,
+}
+
+impl HidCommand for KernelBench {
+    const CMD: u8 = cmd::PROF_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let r = self.reps.to_le_bytes();
+        vec![0x06, self.kernel, r[0], r[1]]
+    }
+}
+
+/// Per-repetition cycles of one kernel (response to [`KernelBench`]).
+#[derive(Debug, Clone)]
+pub struct KernelBenchResponse {
+    pub kernel: u8,
+    pub num_kernels: u8,
+    pub count: u32,
+    pub min_cycles: u32,
+    pub max_cycles: u32,
+    pub total_cycles: u64,
+    /// log2 histogram: bin 0 < 512 cycles, bin k < 512 << k, bin 7 everything above.
+    pub hist: [u16; 8],
+    /// FNV-1a hash of the last repetition's output; matches the host
+    /// harness (`firmwares/2949-v408/patch/host`) for the same scene.
+    pub hash: u32,
+}
+
+impl HidResponse for KernelBenchResponse {
+    const CMD_ECHO: u8 = cmd::PROF_CMD;
+    const MIN_LEN: usize = 44; // echo + sub + kernel + n + 36B slot + hash
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        // data[0] = cmd echo (0xEB), data[1] = sub echo (0x06)
+        if data.get(1) != Some(&0x06) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x06,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let le32 = |i: usize| u32::from_le_bytes([data[i], data[i + 1], data[i + 2], data[i + 3]]);
+        let mut hist = [0u16; 8];
+        for (i, h) in hist.iter_mut().enumerate() {
+            *h = u16::from_le_bytes([data[24 + i * 2], data[25 + i * 2]]);
+        }
+        Ok(Self {
+            kernel: data[2],
+            num_kernels: data[3],
+            count: le32(4),
+            min_cycles: le32(8),
+            max_cycles: le32(12),
+            total_cycles: le32(16) as u64 | (le32(20) as u64) << 32,
+            hist,
+            hash: le32(40),
+        })
+    }
+}
+
+/// Packed depth frame mode: off = stock single-key 0x1B reports.
+pub const DEPTH_MODE_PACKED: u8 = 0x01;
+
+/// Select the depth report format (0xEC sub 0x01).
+///
+/// Any write restarts the frame sequence at 0 with every key's base at 0,
+/// matching a fresh [`DepthFrameDecoder`].
+///
+/// [`DepthFrameDecoder`]: crate::event_parser::DepthFrameDecoder
+#[derive(Debug, Clone)]
+pub struct DepthMode {
+    pub mode: u8,
+}
+
+impl HidCommand for DepthMode {
+    const CMD: u8 = cmd::DEPTH_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x01, self.mode]
+    }
+}
+
+/// Configure the firmware-side depth filter (0xEC sub 0x02).
+///
+/// `mask` bit k subscribes key k; unsubscribed keys are never reported.
+/// Changes within `deadband` of the last reported depth are dropped
+/// (a release to 0 always goes out). `max_rate_hz` caps how often depth
+/// reports leave the keyboard; 0 = uncapped. All-ones mask with zero
+/// deadband and rate turns the filter off.
+#[derive(Debug, Clone)]
+pub struct DepthFilter {
+    pub mask: [u8; 16],
+    pub deadband: u16,
+    pub max_rate_hz: u16,
+}
+
+impl DepthFilter {
+    /// Filter that forwards every key unchanged.
+    pub fn off() -> Self {
+        Self {
+            mask: [0xFF; 16],
+            deadband: 0,
+            max_rate_hz: 0,
+        }
+    }
+
+    /// Subscribe only `keys` (matrix indices; out-of-range ones are ignored).
+    pub fn keys(keys: &[u8]) -> Self {
+        let mut mask = [0u8; 16];
+        for &k in keys {
+            if (k as usize) < 128 {
+                mask[k as usize / 8] |= 1 << (k % 8);
+            }
+        }
+        Self {
+            mask,
+            deadband: 0,
+            max_rate_hz: 0,
+        }
+    }
+}
+
+impl HidCommand for DepthFilter {
+    const CMD: u8 = cmd::DEPTH_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let mut data = Vec::with_capacity(21);
+        data.push(0x02);
+        data.extend_from_slice(&self.mask);
+        data.extend_from_slice(&self.deadband.to_le_bytes());
+        data.extend_from_slice(&self.max_rate_hz.to_le_bytes());
+        data
+    }
+}
+
+/// Read packed depth frame status (0xEC sub 0x00).
+#[derive(Debug, Clone)]
+pub struct DepthStatus;
+
+impl HidCommand for DepthStatus {
+    const CMD: u8 = cmd::DEPTH_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x00]
+    }
+}
+
+/// Packed depth frame status (response to [`DepthStatus`]).
+#[derive(Debug, Clone)]
+pub struct DepthStatusResponse {
+    pub mode: u8,
+    /// Sequence number the next frame will carry.
+    pub next_seq: u8,
+    /// Keys waiting for the next frame.
+    pub pending: u8,
+    /// Reports handed back to the stock path because the pending list was full.
+    pub overflow: u16,
+    pub frames: u32,
+    /// Whether a [`DepthFilter`] other than "off" is installed.
+    pub filter_active: bool,
+    pub deadband: u16,
+    /// Minimum CPU cycles between depth reports (0 = uncapped).
+    pub min_cycles: u32,
+}
+
+impl HidResponse for DepthStatusResponse {
+    const CMD_ECHO: u8 = cmd::DEPTH_CMD;
+    const MIN_LEN: usize = 18; // ... + overflow 2 + frames 4 + active + 2 + 4
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0x00) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x00,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        Ok(Self {
+            mode: data[2],
+            next_seq: data[3],
+            pending: data[4],
+            overflow: u16::from_le_bytes([data[5], data[6]]),
+            frames: u32::from_le_bytes([data[7], data[8], data[9], data[10]]),
+            filter_active: data[11] != 0,
+            deadband: u16::from_le_bytes([data[12], data[13]]),
+            min_cycles: u32::from_le_bytes([data[14], data[15], data[16], data[17]]),
+        })
+    }
+}
+
+/// Number of native gamepad axes (X, Y, Z, Rx, Ry, Rz).
+pub const GAMEPAD_AXES: usize = 6;
+
+/// Marks a gamepad axis as unassigned.
+pub const GAMEPAD_AXIS_UNUSED: u8 = 0xFF;
+
+/// Assign keys to the firmware's native HID gamepad axes (0xED sub 0x01).
+///
+/// Each axis reports the key's filtered ADC value (0-4095) in HID report
+/// ID 9 on USB; `invert` bit a flips axis a. All axes unused stops reports.
+#[derive(Debug, Clone)]
+pub struct GamepadAxes {
+    pub keys: [u8; GAMEPAD_AXES],
+    pub invert: u8,
+}
+
+impl GamepadAxes {
+    /// No axes assigned: the gamepad stays silent.
+    pub fn off() -> Self {
+        Self {
+            keys: [GAMEPAD_AXIS_UNUSED; GAMEPAD_AXES],
+            invert: 0,
+        }
+    }
+}
+
+impl HidCommand for GamepadAxes {
+    const CMD: u8 = cmd::GAMEPAD_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let mut data = Vec::with_capacity(2 + GAMEPAD_AXES);
+        data.push(0x01);
+        data.extend_from_slice(&self.keys);
+        data.push(self.invert);
+        data
+    }
+}
+
+/// Read gamepad axis assignment (0xED sub 0x00).
+#[derive(Debug, Clone)]
+pub struct GamepadStatus;
+
+impl HidCommand for GamepadStatus {
+    const CMD: u8 = cmd::GAMEPAD_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x00]
+    }
+}
+
+/// Gamepad axis assignment (response to [`GamepadStatus`]).
+#[derive(Debug, Clone)]
+pub struct GamepadStatusResponse {
+    pub keys: [u8; GAMEPAD_AXES],
+    pub invert: u8,
+    /// Axis values in the last report sent.
+    pub values: [u16; GAMEPAD_AXES],
+}
+
+impl HidResponse for GamepadStatusResponse {
+    const CMD_ECHO: u8 = cmd::GAMEPAD_CMD;
+    const MIN_LEN: usize = 21; // echo + sub + 6 keys + invert + 6 × u16
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0x00) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x00,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let mut keys = [0u8; GAMEPAD_AXES];
+        keys.copy_from_slice(&data[2..2 + GAMEPAD_AXES]);
+        let mut values = [0u16; GAMEPAD_AXES];
+        for (a, v) in values.iter_mut().enumerate() {
+            *v = u16::from_le_bytes([data[9 + a * 2], data[10 + a * 2]]);
+        }
+        Ok(Self {
+            keys,
+            invert: data[8],
+            values,
+        })
+    }
+}
+
+/// Telemetry fields for [`TelemetrySubscribe`].
+pub const TELEM_BATTERY: u8 = 0x01;
+pub const TELEM_CHARGER: u8 = 0x02;
+pub const TELEM_ADC_AVG: u8 = 0x04;
+pub const TELEM_POWER: u8 = 0x08;
+pub const TELEM_ALL: u8 = 0x0F;
+
+/// Subscribe to push telemetry (0xEE sub 0x01).
+///
+/// The firmware sends a record (EP2 notif 0x1E) when a subscribed field
+/// moves past its threshold, on USB and through the dongle. Thresholds of 0
+/// report any change; `fields` = 0 unsubscribes.
+#[derive(Debug, Clone)]
+pub struct TelemetrySubscribe {
+    /// `TELEM_*` mask.
+    pub fields: u8,
+    /// Battery level delta (%) that triggers a record.
+    pub bat_thresh: u8,
+    /// Averaged battery ADC delta that triggers a record.
+    pub adc_thresh: u16,
+}
+
+impl HidCommand for TelemetrySubscribe {
+    const CMD: u8 = cmd::TELEM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let [lo, hi] = self.adc_thresh.to_le_bytes();
+        vec![0x01, self.fields, self.bat_thresh, lo, hi]
+    }
+}
+
+/// Read telemetry subscription (0xEE sub 0x00).
+#[derive(Debug, Clone)]
+pub struct TelemetryStatus;
+
+impl HidCommand for TelemetryStatus {
+    const CMD: u8 = cmd::TELEM_CMD;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x00]
+    }
+}
+
+/// Telemetry subscription and last reported values (response to
+/// [`TelemetryStatus`]).
+#[derive(Debug, Clone)]
+pub struct TelemetryStatusResponse {
+    pub fields: u8,
+    pub bat_thresh: u8,
+    pub adc_thresh: u16,
+    /// Sequence number of the last record sent.
+    pub seq: u8,
+    pub battery: u8,
+    pub charger: bool,
+    pub charge_status: u8,
+    pub adc_avg: u16,
+    /// Power state (0 = wake, 1 = idle, 2 = deep sleep).
+    pub power: u8,
+}
+
+impl HidResponse for TelemetryStatusResponse {
+    const CMD_ECHO: u8 = cmd::TELEM_CMD;
+    const MIN_LEN: usize = 13; // echo + sub + fields + 2 thresholds + seq + 6 values
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0x00) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x00,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        Ok(Self {
+            fields: data[2],
+            bat_thresh: data[3],
+            adc_thresh: u16::from_le_bytes([data[4], data[5]]),
+            seq: data[6],
+            battery: data[7],
+            charger: data[8] != 0,
+            charge_status: data[9],
+            adc_avg: u16::from_le_bytes([data[10], data[11]]),
+            power: data[12],
+        })
+    }
+}
+
+/// Register ids in the patch diagnostics map ([`PatchRegRead`]).
+pub mod patch_reg {
+    /// HID setup counters, RTT/latency drop counters, CYCCNT (26 B)
+    pub const DIAG: u8 = 0x01;
+    /// Raw battery fields, charge pins and ADC readings (16 B)
+    pub const BATTERY: u8 = 0x02;
+    /// Compact LED stream seq, sync flag and drop counters (6 B)
+    pub const LED_STREAM: u8 = 0x03;
+    /// Animation frame count, active defs, assigned keys, stage (11 B)
+    pub const ANIM: u8 = 0x04;
+    /// Packed depth mode, seq, pending, overflow, frames (10 B)
+    pub const DEPTH: u8 = 0x05;
+    /// Telemetry fields, seq, dirty mask (3 B)
+    pub const TELEM: u8 = 0x06;
+    /// Tagged completions queued, queue head, drops (4 B)
+    pub const TAGGED: u8 = 0x07;
+    /// Frame-budget governor, see [`super::FrameGovernorStatus`] (26 B)
+    pub const GOV: u8 = 0x08;
+    /// Hook profiler slot `PROF_BASE + hook` (36 B, same layout as 0xEB)
+    pub const PROF_BASE: u8 = 0x10;
+    /// Latency slot `LAT_BASE + LATENCY_*` (36 B)
+    pub const LAT_BASE: u8 = 0x20;
+}
+
+/// Read one page of the patch register directory (0xE7 sub 0x01).
+#[derive(Debug, Clone)]
+pub struct PatchRegDir {
+    /// Index of the first directory entry to return.
+    pub first: u8,
+}
+
+impl HidCommand for PatchRegDir {
+    const CMD: u8 = cmd::GET_PATCH_INFO;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        vec![0x01, self.first]
+    }
+}
+
+/// Register directory page (response to [`PatchRegDir`]).
+#[derive(Debug, Clone)]
+pub struct PatchRegDirResponse {
+    /// Register map layout version.
+    pub version: u8,
+    pub patch_version: u8,
+    pub capabilities: u16,
+    /// Registers in the whole directory.
+    pub total: u8,
+    pub first: u8,
+    /// `(id, len)` of each register on this page.
+    pub entries: Vec<(u8, u8)>,
+}
+
+impl HidResponse for PatchRegDirResponse {
+    const CMD_ECHO: u8 = cmd::GET_PATCH_INFO;
+    const MIN_LEN: usize = 9; // echo + sub + version + patch ver + caps + total + first + n
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0x01) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x01,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let n = data[8] as usize;
+        let entries = data[9..]
+            .chunks_exact(2)
+            .take(n)
+            .map(|e| (e[0], e[1]))
+            .collect();
+        Ok(Self {
+            version: data[2],
+            patch_version: data[3],
+            capabilities: u16::from_le_bytes([data[4], data[5]]),
+            total: data[6],
+            first: data[7],
+            entries,
+        })
+    }
+}
+
+/// Read patch registers by id (0xE7 sub 0x02), see [`patch_reg`].
+#[derive(Debug, Clone)]
+pub struct PatchRegRead {
+    pub ids: Vec<u8>,
+}
+
+impl PatchRegRead {
+    /// Most ids the firmware takes per request.
+    pub const MAX_IDS: usize = 16;
+}
+
+impl HidCommand for PatchRegRead {
+    const CMD: u8 = cmd::GET_PATCH_INFO;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let mut data = Vec::with_capacity(1 + self.ids.len());
+        data.push(0x02);
+        data.extend(self.ids.iter().take(Self::MAX_IDS));
+        data
+    }
+}
+
+/// Register values (response to [`PatchRegRead`]). Registers that did not
+/// fit are missing and must be read again.
+#[derive(Debug, Clone)]
+pub struct PatchRegReadResponse {
+    /// Register map layout version.
+    pub version: u8,
+    /// `(id, value)` in request order; unknown ids have an empty value.
+    pub regs: Vec<(u8, Vec<u8>)>,
+}
+
+impl HidResponse for PatchRegReadResponse {
+    const CMD_ECHO: u8 = cmd::GET_PATCH_INFO;
+    const MIN_LEN: usize = 3; // echo + sub + version
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        if data.get(1) != Some(&0x02) {
+            return Err(ParseError::CommandMismatch {
+                expected: 0x02,
+                got: data.get(1).copied().unwrap_or(0),
+            });
+        }
+        let mut regs = Vec::new();
+        let mut pos = 3;
+        while pos + 2 <= data.len() && data[pos] != 0 {
+            let (id, len) = (data[pos], data[pos + 1] as usize);
+            let Some(value) = data.get(pos + 2..pos + 2 + len) else {
+                break;
+            };
+            regs.push((id, value.to_vec()));
+            pos += 2 + len;
+        }
+        Ok(Self {
+            version: data[2],
+            regs,
+        })
+    }
+}
+
+/// Dirty-LED frame page (0xE8 page 0xF8), for streaming over 2.4 GHz.
+///
+/// Strip-indexed absolute RGB565 colours, gap-encoded: each entry's strip
+/// is the previous entry's plus its gap byte, the first gap being the strip
+/// itself. The dongle patch merges these pages into a per-LED shadow and
+/// forwards only the newest colour of each changed LED, so they are sent
+/// without reading a reply. `entries` must be in ascending strip order.
+#[derive(Debug, Clone, Default)]
+pub struct LedRfFrame {
+    /// `(strip index, RGB565 colour)`, at most [`Self::MAX_ENTRIES`]
+    pub entries: Vec<(u8, u16)>,
+}
+
+impl LedRfFrame {
+    pub const PAGE: u8 = 0xF8;
+    pub const MAX_ENTRIES: usize = 20;
+}
+
+impl HidCommand for LedRfFrame {
+    const CMD: u8 = cmd::LED_STREAM;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let n = self.entries.len().min(Self::MAX_ENTRIES);
+        let mut buf = Vec::with_capacity(2 + n * 3);
+        buf.push(Self::PAGE);
+        buf.push(n as u8);
+        let mut prev = 0u8; // so the first gap is the strip itself
+        for &(strip, color) in &self.entries[..n] {
+            buf.push(strip.wrapping_sub(prev));
+            buf.extend_from_slice(&color.to_le_bytes());
+            prev = strip;
+        }
+        buf
+    }
+}
+
+/// Several LED_STREAM (0xE8) / ANIM_CMD (0xEA) packets in one report
+/// (0xEF), run in order by the firmware within one command.
+///
+/// Each entry is `[len][cmd][data…]`. Trailing zero bytes are dropped on
+/// the wire, since the firmware zero-fills each packet before running it.
+#[derive(Debug, Clone, Default)]
+pub struct CommandBundle {
+    data: Vec<u8>,
+    count: usize,
+}
+
+impl CommandBundle {
+    /// Payload bytes available for entries (report bytes 1..=60).
+    pub const CAPACITY: usize = 60;
+
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Append a packet; returns `false` (bundle unchanged) if it doesn't fit.
+    pub fn push(&mut self, cmd: u8, data: &[u8]) -> bool {
+        let used = data.iter().rposition(|&b| b != 0).map_or(0, |i| i + 1);
+        let entry = 2 + used;
+        if self.data.len() + entry > Self::CAPACITY {
+            return false;
+        }
+        self.data.push((1 + used) as u8);
+        self.data.push(cmd);
+        self.data.extend_from_slice(&data[..used]);
+        self.count += 1;
+        true
+    }
+
+    /// Number of packets in the bundle.
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// Iterate `(cmd, data)` entries of an encoded bundle payload.
+    pub fn entries(payload: &[u8]) -> impl Iterator<Item = (u8, &[u8])> {
+        let mut rest = payload;
+        std::iter::from_fn(move || {
+            let (&len, tail) = rest.split_first()?;
+            let len = len as usize;
+            if len == 0 || tail.len() < len {
+                return None;
+            }
+            let (entry, next) = tail.split_at(len);
+            rest = next;
+            Some((entry[0], &entry[1..]))
+        })
+    }
+}
+
+impl HidCommand for CommandBundle {
+    const CMD: u8 = cmd::BUNDLE;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        self.data.clone()
+    }
+}
+
+/// Result of a [`CommandBundle`].
+#[derive(Debug, Clone)]
+pub struct BundleResponse {
+    /// Entries the firmware ran.
+    pub executed: u8,
+    /// Index of the entry that stopped the bundle, if any.
+    pub failed: Option<u8>,
+}
+
+impl HidResponse for BundleResponse {
+    const CMD_ECHO: u8 = cmd::BUNDLE;
+    const MIN_LEN: usize = 3; // echo + executed + failed
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        Ok(Self {
+            executed: data[1],
+            failed: (data[2] != 0xFF).then_some(data[2]),
+        })
+    }
+}
+
+/// One patch command run under a host tag (0xEF sub 0xFF).
+///
+/// The completion carries the tag, so several can be in flight at once. On
+/// USB it is pushed as a [`crate::VendorEvent::TaggedCompletion`] (notif
+/// 0x1F); it can always be read back as a [`TaggedResponse`], which is how
+/// it arrives through the dongle.
+#[derive(Debug, Clone)]
+pub struct TaggedCommand {
+    pub tag: u8,
+    /// Command byte of the wrapped patch command (0xE7..0xEF)
+    pub cmd: u8,
+    /// Its data, as it would follow the command byte (up to 60 bytes)
+    pub data: Vec<u8>,
+}
+
+impl TaggedCommand {
+    /// Sub-command marking a tagged response (0xFE = command refused).
+    pub const MARKER: u8 = 0xFF;
+    pub const REFUSED: u8 = 0xFE;
+    /// Data bytes the wrapped command may carry.
+    pub const MAX_DATA: usize = 60;
+}
+
+impl HidCommand for TaggedCommand {
+    const CMD: u8 = cmd::BUNDLE;
+    const CHECKSUM: ChecksumType = ChecksumType::None;
+
+    fn to_data(&self) -> Vec<u8> {
+        let n = self.data.len().min(Self::MAX_DATA);
+        let mut buf = vec![Self::MARKER, self.tag, self.cmd];
+        buf.extend_from_slice(&self.data[..n]);
+        buf
+    }
+}
+
+/// Tagged completion read back with GET_REPORT.
+#[derive(Debug, Clone)]
+pub struct TaggedResponse {
+    pub tag: u8,
+    /// The wrapped command's response without its command echo (so
+    /// `payload[0]` is its sub-command echo); `None` if it was refused.
+    pub payload: Option<Vec<u8>>,
+}
+
+impl TaggedResponse {
+    /// Rebuild the wrapped command's plain response (`[cmd, payload…]`), as
+    /// its own response type expects it.
+    pub fn response(&self, cmd: u8) -> Option<Vec<u8>> {
+        let payload = self.payload.as_ref()?;
+        let mut r = Vec::with_capacity(payload.len() + 1);
+        r.push(cmd);
+        r.extend_from_slice(payload);
+        Some(r)
+    }
+}
+
+impl HidResponse for TaggedResponse {
+    const CMD_ECHO: u8 = cmd::BUNDLE;
+    const MIN_LEN: usize = 3; // echo + marker + tag
+
+    fn from_data(data: &[u8]) -> Result<Self, ParseError> {
+        let payload = match data[1] {
+            TaggedCommand::MARKER => Some(data[3..].to_vec()),
+            TaggedCommand::REFUSED => None,
+            got => {
+                return Err(ParseError::CommandMismatch {
+                    expected: TaggedCommand::MARKER,
+                    got,
+                })
+            }
+        };
+        Ok(Self {
+            tag: data[2],
+            payload,
+        })
+    }
+}
+
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::protocol::REPORT_SIZE;
+
+    #[test]
+    fn test_set_led_params_builder() {
+        let cmd = SetLedParams::new()
+            .mode(LedMode::Wave)
+            .brightness(4)
+            .speed(3)
+            .color(255, 0, 128)
+            .dazzle(true);
+
+        let data = cmd.to_data();
+        assert_eq!(data[0], LedMode::Wave as u8); // mode
+        assert_eq!(data[1], 1); // speed inverted: 4 - 3 = 1
+        assert_eq!(data[2], 4); // brightness
+        assert_eq!(data[3], DAZZLE_ON); // dazzle
+        assert_eq!(data[4], 255); // R
+        assert_eq!(data[5], 0); // G
+        assert_eq!(data[6], 128); // B
+    }
+
+    #[test]
+    fn test_set_led_params_user_picture() {
+        let cmd = SetLedParams::new()
+            .mode(LedMode::UserPicture)
+            .layer(2)
+            .color(255, 0, 0); // Should be ignored
+
+        let data = cmd.to_data();
+        assert_eq!(data[0], LedMode::UserPicture as u8);
+        assert_eq!(data[3], 2 << 4); // layer in option
+        assert_eq!(data[4], 0); // Fixed R
+        assert_eq!(data[5], 200); // Fixed G
+        assert_eq!(data[6], 200); // Fixed B
+    }
+
+    #[test]
+    fn test_led_params_response_parse() {
+        // Simulated response: [cmd_echo, mode, speed_inv, brightness, option, r, g, b]
+        let data = [0x87, 4, 1, 3, DAZZLE_ON, 128, 64, 32];
+
+        let resp = LedParamsResponse::parse(&data).unwrap();
+        assert_eq!(resp.mode, LedMode::Wave);
+        assert_eq!(resp.speed, 3); // 4 - 1 = 3 (inverted back)
+        assert_eq!(resp.brightness, 3);
+        assert!(resp.dazzle);
+        assert_eq!(resp.color.r, 128);
+    }
+
+    #[test]
+    fn test_polling_rate() {
+        // Frame is [cmd, 0, code, ...] — the code sits two bytes after the command,
+        // not one. Writing it at offset 1 leaves offset 2 zero, which the firmware
+        // reads as code 0 (8 kHz), so every rate change silently became 8 kHz.
+        let cmd = SetPollingRate::from_hz(1000).unwrap();
+        assert_eq!(cmd.to_data(), vec![0, 3]); // 1000Hz = protocol value 3
+
+        let resp_data = [0x83, 0, 3];
+        let resp = PollingRateResponse::parse(&resp_data).unwrap();
+        assert_eq!(resp.rate.to_hz(), 1000);
+
+        // A frame truncated before the code must fail rather than decode as 8 kHz.
+        assert!(PollingRateResponse::parse(&[0x83, 0]).is_err());
+    }
+
+    #[test]
+    fn test_sleep_time() {
+        // Test command with 4 values: idle=120s, deep=1680s for both modes
+        let cmd = SetSleepTime::uniform(120, 1680);
+        let data = cmd.to_data();
+        // Data should be 15 bytes with values at indices 7-14
+        assert_eq!(data.len(), 15);
+        // idle_bt at [7..9]: 120 = 0x0078 LE
+        assert_eq!(data[7], 0x78);
+        assert_eq!(data[8], 0x00);
+        // idle_24g at [9..11]: 120 = 0x0078 LE
+        assert_eq!(data[9], 0x78);
+        assert_eq!(data[10], 0x00);
+        // deep_bt at [11..13]: 1680 = 0x0690 LE
+        assert_eq!(data[11], 0x90);
+        assert_eq!(data[12], 0x06);
+        // deep_24g at [13..15]: 1680 = 0x0690 LE
+        assert_eq!(data[13], 0x90);
+        assert_eq!(data[14], 0x06);
+
+        // Test response parsing (16 bytes minimum with values at indices 8-15)
+        let mut resp_data = [0u8; 16];
+        resp_data[0] = 0x91; // command echo
+                             // idle_bt = 120 at [8..10]
+        resp_data[8] = 0x78;
+        resp_data[9] = 0x00;
         // idle_24g = 120 at [10..12]
         resp_data[10] = 0x78;
         resp_data[11] = 0x00;
@@ -2916,4 +4363,248 @@ mod tests {
         assert_eq!(buf[4], 150); // deactuation
         assert_eq!(buf[5], 1); // mode
     }
+
+    #[test]
+    fn test_patch_reg_read_response_tlv() {
+        // echo, sub, version, [TELEM len 3 …], [0x77 len 0], end
+        let mut data = vec![0xE7, 0x02, 0x01, 0x06, 0x03, 0x0F, 0x2A, 0x00, 0x77, 0x00];
+        data.resize(62, 0);
+        let r = PatchRegReadResponse::parse(&data).unwrap();
+        assert_eq!(r.version, 1);
+        assert_eq!(
+            r.regs,
+            vec![(patch_reg::TELEM, vec![0x0F, 0x2A, 0x00]), (0x77, vec![])]
+        );
+
+        // Legacy blob (magic in place of the sub echo) is rejected
+        let legacy = [0xE7, 0xCA, 0xFE, 0x01, 0xCF, 0x0F];
+        assert!(PatchRegReadResponse::parse(&legacy).is_err());
+    }
+
+    #[test]
+    fn test_led_rf_frame_gaps() {
+        let f = LedRfFrame {
+            entries: vec![(3, 0xF800), (10, 0x07E0), (81, 0x001F)],
+        };
+        assert_eq!(
+            f.to_data(),
+            vec![0xF8, 3, 3, 0x00, 0xF8, 7, 0xE0, 0x07, 71, 0x1F, 0x00]
+        );
+
+        // Capped at one report's worth of entries
+        let full = LedRfFrame {
+            entries: (0..30).map(|i| (i, 0)).collect(),
+        };
+        let data = full.to_data();
+        assert_eq!(data[1] as usize, LedRfFrame::MAX_ENTRIES);
+        assert_eq!(data.len(), 2 + 3 * LedRfFrame::MAX_ENTRIES);
+    }
+
+    #[test]
+    fn test_command_bundle_packing() {
+        let mut b = CommandBundle::new();
+        // DEF with trailing zero bytes: only the used prefix goes on the wire
+        assert!(b.push(cmd::ANIM_CMD, &[0x0A, 2, 0, 5, 100, 0, 0, 0]));
+        assert!(b.push(cmd::ANIM_CMD, &[0xFF]));
+        assert_eq!(b.len(), 2);
+        assert_eq!(
+            b.to_data(),
+            vec![6, 0xEA, 0x0A, 2, 0, 5, 100, 2, 0xEA, 0xFF]
+        );
+        let cmds: Vec<_> = CommandBundle::entries(&b.to_data()).collect();
+        assert_eq!(cmds[0], (0xEA, &[0x0A, 2, 0, 5, 100][..]));
+        assert_eq!(cmds[1], (0xEA, &[0xFF][..]));
+
+        // A packet that would overflow the report is refused
+        assert!(!b.push(cmd::ANIM_CMD, &[1; 50]));
+        assert_eq!(b.len(), 2);
+    }
+
+    #[test]
+    fn test_frame_governor() {
+        let c = FrameGovernor {
+            budget_cycles: 27_000,
+            slices: 3,
+        };
+        assert_eq!(c.to_data(), vec![0x05, 0x78, 0x69, 0x00, 0x00, 3]);
+
+        let mut v = vec![0u8; 26];
+        v[0..4].copy_from_slice(&27_000u32.to_le_bytes());
+        v[4..8].copy_from_slice(&30_000u32.to_le_bytes());
+        v[20..24].copy_from_slice(&5u32.to_le_bytes());
+        v[24] = 3;
+        v[25] = 2;
+        let st = FrameGovernorStatus::from_reg(&v).unwrap();
+        assert_eq!(st.budget_cycles, 27_000);
+        assert_eq!(st.period_cycles, 30_000);
+        assert_eq!(st.shed_blends, 5);
+        assert_eq!((st.slices, st.level), (3, 2));
+        assert!(FrameGovernorStatus::from_reg(&v[..25]).is_none());
+    }
+
+    #[test]
+    fn test_kernel_bench() {
+        let c = KernelBench {
+            kernel: 5,
+            reps: 300,
+        };
+        assert_eq!(c.to_data(), vec![0x06, 5, 0x2C, 0x01]);
+
+        let mut d = vec![0u8; 44];
+        d[0] = 0xEB;
+        d[1] = 0x06;
+        d[2] = 5;
+        d[3] = BENCH_KERNELS.len() as u8;
+        d[4..8].copy_from_slice(&300u32.to_le_bytes());
+        d[16..20].copy_from_slice(&900_000u32.to_le_bytes());
+        d[26..28].copy_from_slice(&7u16.to_le_bytes());
+        d[40..44].copy_from_slice(&0x15e8_1475u32.to_le_bytes());
+        let r = KernelBenchResponse::from_data(&d).unwrap();
+        assert_eq!((r.kernel, r.num_kernels, r.count), (5, 6, 300));
+        assert_eq!(r.total_cycles, 900_000);
+        assert_eq!(r.hist[1], 7);
+        assert_eq!(r.hash, 0x15e8_1475);
+        d[1] = 0x00;
+        assert!(KernelBenchResponse::from_data(&d).is_err());
+    }
+
+    #[test]
+    fn test_patch_reg_dir_response() {
+        let data = [
+            0xE7, 0x01, 0x01, 0x01, 0xCF, 0x0F, 15, 14, 1, 0x22, 36, 0, 0,
+        ];
+        let r = PatchRegDirResponse::parse(&data).unwrap();
+        assert_eq!(r.capabilities, 0x0FCF);
+        assert_eq!((r.total, r.first), (15, 14));
+        assert_eq!(r.entries, vec![(patch_reg::LAT_BASE + 2, 36)]);
+    }
+
+    #[test]
+    fn test_tagged_command_roundtrip() {
+        let c = TaggedCommand {
+            tag: 0x42,
+            cmd: cmd::ANIM_CMD,
+            data: vec![0xF0],
+        };
+        assert_eq!(c.to_data(), vec![0xFF, 0x42, 0xEA, 0xF0]);
+        assert!(matches!(
+            try_parse_command(&[0xEF, 0xFF, 0x42, 0xEA, 0xF0]),
+            ParsedCommand::Tagged {
+                tag: 0x42,
+                cmd: 0xEA
+            }
+        ));
+
+        // [EF, FF, tag, sub echo, …] → plain ANIM_QUERY-style response
+        let r = TaggedResponse::parse(&[0xEF, 0xFF, 0x42, 0xF0, 0x01, 0x02]).unwrap();
+        assert_eq!(r.tag, 0x42);
+        assert_eq!(r.response(0xEA), Some(vec![0xEA, 0xF0, 0x01, 0x02]));
+
+        let refused = TaggedResponse::parse(&[0xEF, 0xFE, 0x43, 0, 0]).unwrap();
+        assert_eq!((refused.tag, refused.payload), (0x43, None));
+
+        // A plain bundle response is not a tagged one
+        assert!(TaggedResponse::parse(&[0xEF, 0x02, 0xFF]).is_err());
+    }
+
+    #[test]
+    fn test_anim_wide_forms() {
+        let kf = vec![(0, 0xF800, 1); 6];
+        let short = AnimDefine {
+            def_id: 3,
+            num_kf: 6,
+            flags: 0,
+            priority: 2,
+            duration_ticks: 100,
+            keyframes: kf.clone(),
+            reach: 0,
+            spread: 0,
+        };
+        let wide = AnimDefine {
+            def_id: 20,
+            ..short.clone()
+        };
+        let (s, w) = (short.to_data(), wide.to_data());
+        assert_eq!((s[0], w[0], w[1]), (0x0B, 0x1C, 20));
+        assert_eq!(&s[1..], &w[2..]);
+        assert!(matches!(
+            try_parse_command(&[&[cmd::ANIM_CMD][..], &w].concat()),
+            ParsedCommand::AnimDefine {
+                def_id: 20,
+                num_kf: 6,
+                duration_ticks: 100,
+                ..
+            }
+        ));
+
+        let ext = AnimDefineExt {
+            def_id: 20,
+            keyframes: kf[4..].to_vec(),
+        };
+        assert_eq!(&ext.to_data()[..2], &[0x1D, 20]);
+        let assign = AnimAssign {
+            def_id: 31,
+            keys: vec![(5, 1)],
+        };
+        assert_eq!(assign.to_data(), vec![0x1B, 31, 1, 5, 1]);
+        assert_eq!(AnimQueryKeys { def_id: 9 }.to_data(), vec![0xFA, 9]);
+        let all = AnimAssignAll {
+            def_id: 20,
+            phase_offset: 3,
+        };
+        assert_eq!(all.to_data(), vec![0x20, 20, 3]);
+        assert!(matches!(
+            try_parse_command(&[&[cmd::ANIM_CMD][..], &all.to_data()].concat()),
+            ParsedCommand::AnimAssignAll { def_id: 20 }
+        ));
+
+        let wave = AnimSpatial::Sweep(AnimSweep::BottomToTop);
+        let spatial = AnimDefine {
+            flags: wave.flags(),
+            reach: wave.reach(),
+            spread: 12,
+            ..short.clone()
+        }
+        .to_data();
+        assert_eq!((spatial[2], spatial[26], spatial[27]), (0x30, 3, 12));
+        assert_eq!(AnimSpatial::Linear { angle: 32 }.flags(), 0x10);
+        assert_eq!(AnimSpatial::Radial { origin: 0x23 }.reach(), 0x23);
+
+        // [EA, FA, def, count, pairs…]
+        let r = AnimQueryKeysResponse::parse(&[0xEA, 0xFA, 9, 1, 5, 2]).unwrap();
+        assert_eq!(r.keys, vec![(5, 2)]);
+
+        let mut page = vec![0u8; 55];
+        page[..3].copy_from_slice(&[0xEA, 0xF9, 8]);
+        page[3 + 6..3 + 12].copy_from_slice(&[4, 0x01, 3, 7, 200, 0]);
+        page[51..].copy_from_slice(&[32, 16, 96, 4]);
+        let r = AnimQueryDefsResponse::parse(&page).unwrap();
+        assert_eq!(r.defs.len(), 1);
+        assert_eq!((r.defs[0].id, r.defs[0].key_count), (9, 7));
+        assert_eq!((r.max_defs, r.pool_kf, r.pool_held), (32, 96, 4));
+    }
+
+    #[test]
+    fn test_anim_scene_store() {
+        let save = AnimSave {
+            restore_on_wake: true,
+        };
+        assert_eq!(save.to_data(), vec![0x1E, 0x01]);
+        assert!(matches!(
+            try_parse_command(&[&[cmd::ANIM_CMD][..], &save.to_data()].concat()),
+            ParsedCommand::AnimSave {
+                restore_on_wake: true
+            }
+        ));
+        assert_eq!(AnimLoad.to_data(), vec![0x1F]);
+
+        let r = AnimSceneOpResponse::parse(&[0xEA, 0x1E, 0x00]).unwrap();
+        assert_eq!((r.sub, r.done), (0x1E, false));
+        // A cleared sub echo means the firmware didn't handle the command
+        assert!(AnimSceneOpResponse::parse(&[0xEA, 0x00, 0x00]).is_err());
+
+        let r = AnimQuerySceneResponse::parse(&[0xEA, 0xFB, 1, 1, 3, 82, 2]).unwrap();
+        assert!(r.stored && r.restore_on_wake);
+        assert_eq!((r.defs, r.keys, r.restores), (3, 82, 2));
+    }
 }
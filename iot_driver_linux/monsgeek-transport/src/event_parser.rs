@@ -45,6 +45,12 @@ pub mod notif {
     pub const SETTINGS_ACK: u8 = 0x0F;
     /// Key depth report (magnetism)
     pub const KEY_DEPTH: u8 = 0x1B;
+    /// Packed multi-key depth frame (patched firmware, see [`super::DepthFrameDecoder`])
+    pub const DEPTH_FRAME: u8 = 0x1C;
+    /// Push telemetry record (patched firmware, 0xEE subscription)
+    pub const TELEMETRY: u8 = 0x1E;
+    /// Tagged command completion (patched firmware, 0xEF sub 0xFF)
+    pub const TAGGED_COMPLETION: u8 = 0x1F;
     /// Battery status notification
     pub const BATTERY_STATUS: u8 = 0x88;
 }
@@ -55,6 +61,9 @@ pub mod report_id {
     pub const MOUSE: u8 = 0x02;
     /// Vendor event report ID (USB wired/dongle)
     pub const USB_VENDOR_EVENT: u8 = 0x05;
+    /// Patch event report ID (patched firmware, USB wired): 63-byte payload
+    /// for notifications that do not fit the 31-byte stock vendor report
+    pub const PATCH_EVENT: u8 = 0x0A;
 }
 
 // BLE constants (VENDOR_REPORT_ID, CMDRESP_MARKER, EVENT_MARKER) live in
@@ -94,6 +103,7 @@ fn parse_kb_func(payload: &[u8]) -> VendorEvent {
 /// Report formats:
 /// - Report ID 0x02: Mouse report [02, buttons, 00, X_lo, X_hi, Y_lo, Y_hi, wheel_lo, wheel_hi]
 /// - Report ID 0x05: Vendor event [05, type, value, ...]
+/// - Report ID 0x0A: Patch event, same layout with up to 63 bytes after the ID
 ///
 /// Vendor notification types (Report ID 0x05):
 /// - 0x00: Wake (all zeros)
@@ -105,6 +115,8 @@ fn parse_kb_func(payload: &[u8]) -> VendorEvent {
 /// - 0x07: LED color (0-7)
 /// - 0x0F: Settings ACK (0=done, 1=start)
 /// - 0x1B: Key depth (magnetism report)
+/// - 0x1E: Telemetry record (patched firmware)
+/// - 0x1F: Tagged command completion (patched firmware)
 /// - 0x88: Battery status (from dongle)
 pub fn parse_usb_event(data: &[u8]) -> VendorEvent {
     if data.is_empty() {
@@ -130,8 +142,10 @@ pub fn parse_usb_event(data: &[u8]) -> VendorEvent {
         };
     }
 
-    // Skip report ID if present (0x05)
-    let payload = if data[0] == report_id::USB_VENDOR_EVENT && data.len() > 1 {
+    // Skip report ID if present (0x05, or 0x0A for patch events)
+    let payload = if (data[0] == report_id::USB_VENDOR_EVENT || data[0] == report_id::PATCH_EVENT)
+        && data.len() > 1
+    {
         &data[1..]
     } else {
         data
@@ -169,6 +183,116 @@ pub fn parse_ble_event(data: &[u8]) -> VendorEvent {
     parse_event_payload(payload, data)
 }
 
+/// Keys covered by a packed depth frame bitmap (magnetism key indices).
+const DEPTH_FRAME_KEYS: usize = 126;
+/// Payload header: [1C, seq, enc, bitmap × 16]
+const DEPTH_FRAME_HDR: usize = 19;
+const DEPTH_ENC_ABS16: u8 = 0;
+const DEPTH_ENC_DELTA8: u8 = 1;
+const DEPTH_ENC_DELTA4: u8 = 2;
+
+/// Stateful decoder for packed depth frames (notification 0x1C).
+///
+/// Frame: `[0A, 1C, seq, enc, bitmap × 16, values...]`, sent as the patch
+/// event report since it outgrows the stock vendor report. Bitmap bit k marks
+/// key k; values follow in key order as u16 LE (ABS16), i8 (DELTA8) or i4,
+/// low nibble first (DELTA4). Deltas are relative to the last value the
+/// firmware sent for that key, so the decoder keeps that base per key. After
+/// a sequence gap deltas are dropped until an ABS16 frame (periodic keyframe
+/// or idle refresh) re-anchors the key.
+pub struct DepthFrameDecoder {
+    base: [u16; DEPTH_FRAME_KEYS],
+    synced: [bool; DEPTH_FRAME_KEYS],
+    next_seq: Option<u8>,
+}
+
+impl Default for DepthFrameDecoder {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl DepthFrameDecoder {
+    /// Fresh decoder; matches the firmware state right after a DEPTH_CMD mode write.
+    pub fn new() -> Self {
+        Self {
+            base: [0; DEPTH_FRAME_KEYS],
+            synced: [true; DEPTH_FRAME_KEYS],
+            next_seq: None,
+        }
+    }
+
+    /// Decode a raw input report. Returns `None` if it is not a packed depth
+    /// frame, otherwise the `(key_index, depth_raw)` updates it carries.
+    pub fn decode(&mut self, data: &[u8]) -> Option<Vec<(u8, u16)>> {
+        if data.len() < 1 + DEPTH_FRAME_HDR
+            || data[0] != report_id::PATCH_EVENT
+            || data[1] != notif::DEPTH_FRAME
+        {
+            return None;
+        }
+        let (seq, enc) = (data[2], data[3]);
+        let bitmap = &data[4..4 + 16];
+        let values = &data[1 + DEPTH_FRAME_HDR..];
+        let count: usize = bitmap.iter().map(|b| b.count_ones() as usize).sum();
+        let needed = match enc {
+            DEPTH_ENC_ABS16 => count * 2,
+            DEPTH_ENC_DELTA8 => count,
+            DEPTH_ENC_DELTA4 => count.div_ceil(2),
+            _ => return None,
+        };
+        if values.len() < needed {
+            return None;
+        }
+
+        if self.next_seq.is_some_and(|expected| expected != seq) {
+            debug!(
+                "depth frame gap: expected seq {:?}, got {}",
+                self.next_seq, seq
+            );
+            self.synced = [false; DEPTH_FRAME_KEYS];
+        }
+        self.next_seq = Some(seq.wrapping_add(1));
+
+        let mut updates = Vec::new();
+        let mut i = 0usize;
+        for key in 0..DEPTH_FRAME_KEYS {
+            if bitmap[key >> 3] & (1 << (key & 7)) == 0 {
+                continue;
+            }
+            let delta = match enc {
+                DEPTH_ENC_ABS16 => {
+                    self.base[key] = u16::from_le_bytes([values[i * 2], values[i * 2 + 1]]);
+                    self.synced[key] = true;
+                    0
+                }
+                DEPTH_ENC_DELTA8 => values[i] as i8 as i16,
+                _ => {
+                    let b = values[i / 2];
+                    let nib = if i & 1 == 1 { b >> 4 } else { b & 0x0F };
+                    ((nib << 4) as i8 >> 4) as i16
+                }
+            };
+            i += 1;
+            if !self.synced[key] {
+                continue;
+            }
+            self.base[key] = self.base[key].wrapping_add(delta as u16);
+            updates.push((key as u8, self.base[key]));
+        }
+        Some(updates)
+    }
+
+    /// Track a stock 0x1B report; the firmware falls back to those when its
+    /// pending list is full and counts them as the key's new base.
+    pub fn observe(&mut self, key_index: u8, depth_raw: u16) {
+        if let Some(base) = self.base.get_mut(key_index as usize) {
+            *base = depth_raw;
+            self.synced[key_index as usize] = true;
+        }
+    }
+}
+
 /// Shared event subsystem for all transport backends.
 ///
 /// Manages the broadcast channel, event reader thread, and shutdown flag.
@@ -324,6 +448,7 @@ pub fn run_event_reader_loop<F>(
     debug!("{} event reader thread started", config.name);
     let mut buf = [0u8; 64];
     let start_time = Instant::now();
+    let mut depth_frames = DepthFrameDecoder::new();
 
     while !shutdown.load(Ordering::Relaxed) {
         // Read with short timeout - wakes immediately on data
@@ -339,7 +464,25 @@ pub fn run_event_reader_loop<F>(
                     timestamp,
                     &buf[..len.min(16)]
                 );
+                // Packed depth frames fan out into per-key KeyDepth events
+                if let Some(updates) = depth_frames.decode(&buf[..len]) {
+                    for (key_index, depth_raw) in updates {
+                        let event = VendorEvent::KeyDepth {
+                            key_index,
+                            depth_raw,
+                        };
+                        let _ = tx.send(TimestampedEvent::new(timestamp, event));
+                    }
+                    continue;
+                }
                 let event = parser(&buf[..len]);
+                if let VendorEvent::KeyDepth {
+                    key_index,
+                    depth_raw,
+                } = event
+                {
+                    depth_frames.observe(key_index, depth_raw);
+                }
                 let timestamped = TimestampedEvent::new(timestamp, event);
                 // Send to all subscribers (ignores if no receivers)
                 let _ = tx.send(timestamped);
@@ -408,6 +551,23 @@ fn parse_event_payload(payload: &[u8], original_data: &[u8]) -> VendorEvent {
             }
         }
 
+        // Push telemetry: [seq, changed, battery, charger, charge_status, adc_lo, adc_hi, power]
+        notif::TELEMETRY if payload.len() >= 9 => VendorEvent::Telemetry {
+            seq: payload[1],
+            changed: payload[2],
+            battery: payload[3],
+            charging: payload[4] != 0,
+            charge_status: payload[5],
+            adc_avg: u16::from_le_bytes([payload[6], payload[7]]),
+            power: payload[8],
+        },
+
+        // Tagged completion: [tag, response…], or just [tag] when refused
+        notif::TAGGED_COMPLETION if payload.len() >= 2 => VendorEvent::TaggedCompletion {
+            tag: payload[1],
+            payload: (payload.len() > 2).then(|| payload[2..].to_vec()),
+        },
+
         // Battery status (from dongle)
         notif::BATTERY_STATUS if payload.len() >= 5 => VendorEvent::BatteryStatus {
             level: payload[3],
@@ -476,6 +636,53 @@ mod tests {
         }
     }
 
+    #[test]
+    fn test_parse_telemetry() {
+        // Telemetry: [05, 1E, seq, changed, battery, charger, status, adc_lo, adc_hi, power]
+        let event = parse_usb_event(&[0x05, 0x1E, 0x07, 0x03, 0x4B, 0x01, 0x02, 0xD0, 0x07, 0x00]);
+        match event {
+            VendorEvent::Telemetry {
+                seq,
+                changed,
+                battery,
+                charging,
+                charge_status,
+                adc_avg,
+                power,
+            } => {
+                assert_eq!(seq, 7);
+                assert_eq!(changed, 0x03);
+                assert_eq!(battery, 75);
+                assert!(charging);
+                assert_eq!(charge_status, 2);
+                assert_eq!(adc_avg, 2000);
+                assert_eq!(power, 0);
+            }
+            _ => panic!("Expected Telemetry"),
+        }
+    }
+
+    #[test]
+    fn test_parse_tagged_completion() {
+        // [0A, 1F, tag, sub echo, …]; a refused command is just [0A, 1F, tag]
+        let event = parse_usb_event(&[0x0A, 0x1F, 0x42, 0xF0, 0x01]);
+        assert_eq!(
+            event,
+            VendorEvent::TaggedCompletion {
+                tag: 0x42,
+                payload: Some(vec![0xF0, 0x01]),
+            }
+        );
+        let event = parse_usb_event(&[0x0A, 0x1F, 0x43]);
+        assert_eq!(
+            event,
+            VendorEvent::TaggedCompletion {
+                tag: 0x43,
+                payload: None,
+            }
+        );
+    }
+
     #[test]
     fn test_parse_key_depth() {
         // Key depth: type 0x1B, [depth_lo, depth_hi, key_index, ...]
@@ -492,6 +699,59 @@ mod tests {
         }
     }
 
+    fn depth_frame(seq: u8, enc: u8, keys: &[usize], values: &[u8]) -> Vec<u8> {
+        let mut f = vec![0x0A, 0x1C, seq, enc];
+        let mut bitmap = [0u8; 16];
+        for &k in keys {
+            bitmap[k >> 3] |= 1 << (k & 7);
+        }
+        f.extend_from_slice(&bitmap);
+        f.extend_from_slice(values);
+        f
+    }
+
+    #[test]
+    fn test_decode_depth_frames() {
+        let mut dec = DepthFrameDecoder::new();
+        assert!(dec.decode(&[0x05, 0x1B, 0x64, 0x00, 0x0A, 0x00]).is_none());
+
+        // ABS16: key 3 = 300, key 41 = 15
+        let f = depth_frame(0, 0, &[3, 41], &[0x2C, 0x01, 0x0F, 0x00]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 300), (41, 15)]));
+
+        // DELTA8: key 3 -100, key 41 +61
+        let f = depth_frame(1, 1, &[3, 41], &[0x9C, 0x3D]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 200), (41, 76)]));
+
+        // DELTA4, low nibble first: key 3 +7, key 41 -8, key 100 +1
+        let f = depth_frame(2, 2, &[3, 41, 100], &[0x87, 0x01]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 207), (41, 68), (100, 1)]));
+
+        // Stock fallback report re-bases key 41
+        dec.observe(41, 50);
+        let f = depth_frame(3, 1, &[41], &[0x05]);
+        assert_eq!(dec.decode(&f), Some(vec![(41, 55)]));
+    }
+
+    #[test]
+    fn test_decode_depth_frame_gap() {
+        let mut dec = DepthFrameDecoder::new();
+        let f = depth_frame(0, 0, &[3], &[0x10, 0x00]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 16)]));
+
+        // Frame 1 lost: deltas are dropped until an ABS16 frame re-anchors
+        let f = depth_frame(2, 1, &[3], &[0x02]);
+        assert_eq!(dec.decode(&f), Some(vec![]));
+        let f = depth_frame(3, 0, &[3], &[0x20, 0x00]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 32)]));
+        let f = depth_frame(4, 1, &[3], &[0xFF]);
+        assert_eq!(dec.decode(&f), Some(vec![(3, 31)]));
+
+        // Truncated frame is not decoded
+        let f = depth_frame(5, 0, &[3, 4], &[0x20, 0x00]);
+        assert_eq!(dec.decode(&f), None);
+    }
+
     #[test]
     fn test_parse_mouse_report() {
         // Mouse report: [02, buttons, 00, X_lo, X_hi, Y_lo, Y_hi, wheel_lo, wheel_hi]
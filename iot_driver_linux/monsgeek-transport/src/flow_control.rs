@@ -519,6 +519,14 @@ fn is_dongle_local(cmd: u8) -> bool {
     )
 }
 
+/// Returns true for packets the patched dongle merges itself instead of
+/// forwarding one by one: dirty-LED frames (0xE8 page 0xF8, see
+/// `command::LedRfFrame`). Sent fire-and-forget with no flush — nothing
+/// comes back for them.
+fn is_dongle_coalesced(cmd: u8, data: &[u8]) -> bool {
+    cmd == cmd::LED_STREAM && data.first() == Some(&crate::command::LedRfFrame::PAGE)
+}
+
 fn dongle_command_worker(
     inner: Arc<dyn Transport>,
     state: Arc<DongleSharedState>,
@@ -528,7 +536,9 @@ fn dongle_command_worker(
     debug!("Dongle flow-control worker started");
 
     while let Ok(req) = rx.recv() {
-        let result = if req.fire_and_forget && is_dongle_local(req.cmd) {
+        let result = if req.fire_and_forget
+            && (is_dongle_local(req.cmd) || is_dongle_coalesced(req.cmd, &req.data))
+        {
             // Dongle-local fire-and-forget: no flush needed
             debug!(
                 "Dongle local SET command 0x{:02X} (fire-and-forget)",
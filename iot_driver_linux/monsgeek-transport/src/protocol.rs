@@ -67,14 +67,39 @@ pub mod cmd {
     pub const PAIRING_CMD: u8 = 0x7A;
     /// Patch info - custom firmware capabilities (battery HID, LED stream, etc.)
     /// Note: Was 0xFB, but that collides with dongle-local GET_RF_INFO.
+    /// Sub-commands in data byte 1: 0x00 = legacy fixed blob,
+    /// 0x01 = register map directory, 0x02 = register read (TLV).
     pub const GET_PATCH_INFO: u8 = 0xE7;
     /// LED streaming - write RGB data to WS2812 frame buffer via patch.
-    /// Sub-commands: page 0-6 = data, 0xFF = commit, 0xFE = release.
+    /// Sub-commands: page 0-6 = data, 0xF8 = RF dirty-LED frame,
+    /// 0xF9/0xFA = visualiser setup/levels, 0xFB = RGB565 span,
+    /// 0xFC = delta span, 0xFD = sparse overlay, 0xFF = commit, 0xFE = release.
     pub const LED_STREAM: u8 = 0xE8;
     /// Animation engine — on-device keyframe playback.
     /// Sub-commands: 0x00-0x07 = ASSIGN, 0x08-0x0F = DEF, 0x10-0x17 = DEF_EXT,
+    /// 0x18/0x19/0x1A = STAGE/COMMIT/ABORT, 0x1B-0x1D = ASSIGN/DEF/DEF_EXT
+    /// for defs 8-31, 0x1E/0x1F = flash SAVE/LOAD, 0x20 = ASSIGN_ALL,
+    /// 0xF0 = QUERY, 0xF1-0xF8 = QUERY_KEYS, 0xF9 = QUERY_DEFS,
+    /// 0xFA = QUERY_KEYS_W (any def id), 0xFB = QUERY_SCENE,
     /// 0xFE = CANCEL, 0xFF = CLEAR.
     pub const ANIM_CMD: u8 = 0xEA;
+    /// Hook profiler — DWT cycle counts for each patch entry point.
+    /// Sub-commands: 0x00 = READ, 0x01 = RESET, 0x02 = RTT period, 0x03 = RTT stream,
+    /// 0x04 = LATENCY, 0x05 = frame-budget GOVERNOR, 0x06 = kernel bench
+    /// (`make BENCH=1` builds only).
+    pub const PROF_CMD: u8 = 0xEB;
+    /// Packed depth frames — multi-key depth reports on EP2 (notif 0x1C).
+    /// Sub-commands: 0x00 = READ status, 0x01 = MODE, 0x02 = FILTER.
+    pub const DEPTH_CMD: u8 = 0xEC;
+    /// Patched firmware: native HID gamepad axis assignment
+    pub const GAMEPAD_CMD: u8 = 0xED;
+    /// Patched firmware: push telemetry subscription (notif 0x1E on change).
+    /// Sub-commands: 0x00 = READ, 0x01 = SUBSCRIBE.
+    pub const TELEM_CMD: u8 = 0xEE;
+    /// Patched firmware: several LED_STREAM / ANIM_CMD packets in one report,
+    /// run in order (see `command::CommandBundle`). Sub 0xFF instead runs
+    /// one tagged command (see `command::TaggedCommand`).
+    pub const BUNDLE: u8 = 0xEF;
     /// Get RF info: returns {rf_addr[4], fw_ver_minor, fw_ver_major, 0, 0}.
     /// Handled locally by dongle — NOT forwarded to keyboard.
     pub const GET_RF_INFO: u8 = 0xFB;
@@ -144,6 +169,11 @@ pub mod cmd {
             GET_PATCH_INFO => "GET_PATCH_INFO",
             LED_STREAM => "LED_STREAM",
             ANIM_CMD => "ANIM_CMD",
+            PROF_CMD => "PROF_CMD",
+            DEPTH_CMD => "DEPTH_CMD",
+            GAMEPAD_CMD => "GAMEPAD_CMD",
+            TELEM_CMD => "TELEM_CMD",
+            BUNDLE => "BUNDLE",
             GET_RF_INFO => "GET_RF_INFO",
             GET_CACHED_RESPONSE => "GET_CACHED_RESPONSE",
             GET_DONGLE_ID => "GET_DONGLE_ID",
@@ -172,6 +172,31 @@ pub enum VendorEvent {
         /// Device is online/connected
         online: bool,
     },
+    /// Push telemetry record (patched firmware, 0x1E)
+    Telemetry {
+        /// Record sequence number
+        seq: u8,
+        /// Fields that triggered this record (`TELEM_*` mask)
+        changed: u8,
+        /// Battery level 0-100
+        battery: u8,
+        /// Charger connected
+        charging: bool,
+        /// Raw charge status byte
+        charge_status: u8,
+        /// Averaged battery ADC reading
+        adc_avg: u16,
+        /// Power state (0 = wake, 1 = idle, 2 = deep sleep)
+        power: u8,
+    },
+    /// Completion of a tagged command (patched firmware, 0x1F)
+    TaggedCompletion {
+        /// Tag the host gave the command
+        tag: u8,
+        /// The command's response without its command echo; `None` if the
+        /// firmware refused the command
+        payload: Option<Vec<u8>>,
+    },
 
     // === HID Input Reports ===
     /// Mouse report (Report ID 0x02) - keyboard's built-in mouse function
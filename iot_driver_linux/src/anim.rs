@@ -68,6 +68,8 @@ pub type SharedSlotInfo = Arc<std::sync::Mutex<SlotInfo>>;
 #[derive(Clone)]
 pub struct AnimEngine {
     kb: Arc<KeyboardInterface>,
+    /// Firmware takes command bundles (0xEF); probed on first program.
+    bundles: std::sync::OnceLock<bool>,
 }
 
 /// Key assignment: strip index + phase offset.
@@ -153,7 +155,52 @@ pub struct ProgrammedAnim {
 
 impl AnimEngine {
     pub fn new(kb: Arc<KeyboardInterface>) -> Self {
-        Self { kb }
+        Self {
+            kb,
+            bundles: std::sync::OnceLock::new(),
+        }
+    }
+
+    /// Whether DEF + ASSIGN can go out as command bundles.
+    fn bundles(&self) -> bool {
+        *self.bundles.get_or_init(|| {
+            self.kb
+                .get_patch_info()
+                .ok()
+                .flatten()
+                .is_some_and(|p| p.has_bundle())
+        })
+    }
+
+    /// Define `compiled` in `def_id` and assign `keys`, bundled if possible.
+    fn upload(&self, def_id: u8, compiled: &CompiledAnim, keys: &[(u8, u8)]) -> Result<(), String> {
+        if self.bundles() {
+            return self
+                .kb
+                .anim_program(
+                    def_id,
+                    compiled.flags,
+                    compiled.priority,
+                    compiled.duration_ticks,
+                    &compiled.keyframes,
+                    keys,
+                )
+                .map_err(|e| format!("anim_program: {e}"));
+        }
+
+        self.kb
+            .anim_define(
+                def_id,
+                compiled.flags,
+                compiled.priority,
+                compiled.duration_ticks,
+                &compiled.keyframes,
+            )
+            .map_err(|e| format!("anim_define: {e}"))?;
+
+        self.kb
+            .anim_assign(def_id, keys)
+            .map_err(|e| format!("anim_assign: {e}"))
     }
 
     /// Access the underlying keyboard interface.
@@ -228,19 +275,7 @@ impl AnimEngine {
             .compile_for_firmware(priority, one_shot)
             .ok_or("effect has no keyframes")?;
 
-        self.kb
-            .anim_define(
-                def_id,
-                compiled.flags,
-                compiled.priority,
-                compiled.duration_ticks,
-                &compiled.keyframes,
-            )
-            .map_err(|e| format!("anim_define: {e}"))?;
-
-        self.kb
-            .anim_assign(def_id, keys)
-            .map_err(|e| format!("anim_assign: {e}"))?;
+        self.upload(def_id, &compiled, keys)?;
 
         Ok(ProgrammedAnim {
             def_id,
@@ -256,21 +291,7 @@ impl AnimEngine {
         compiled: &CompiledAnim,
         keys: &[(u8, u8)],
     ) -> Result<(), String> {
-        self.kb
-            .anim_define(
-                def_id,
-                compiled.flags,
-                compiled.priority,
-                compiled.duration_ticks,
-                &compiled.keyframes,
-            )
-            .map_err(|e| format!("anim_define: {e}"))?;
-
-        self.kb
-            .anim_assign(def_id, keys)
-            .map_err(|e| format!("anim_assign: {e}"))?;
-
-        Ok(())
+        self.upload(def_id, compiled, keys)
     }
 
     /// Cancel a specific animation slot.
@@ -11,7 +11,7 @@ use std::time::{Duration, Instant};
 
 use crate::protocol::{audio_viz, cmd};
 use crate::pulse;
-use monsgeek_keyboard::KeyboardInterface;
+use monsgeek_keyboard::{KeyboardInterface, VizSetup};
 use monsgeek_transport::{ChecksumType, Transport};
 
 /// Number of frequency bands to analyze. Matches the device's 16 audio-viz
@@ -277,6 +277,9 @@ pub struct AudioConfig {
     pub update_hz: u32,
     /// Capture device name (exact or case-insensitive substring); None = auto-detect monitor source
     pub device: Option<String>,
+    /// Let a patched firmware draw the bars over the current lighting from
+    /// 8-bit levels (0xE8 0xF9/0xFA); falls back to `led_mode` without it.
+    pub overlay: bool,
 }
 
 impl Default for AudioConfig {
@@ -287,6 +290,7 @@ impl Default for AudioConfig {
             sensitivity: 1.0,
             update_hz: 50,
             device: None,
+            overlay: false,
         }
     }
 }
@@ -304,6 +308,11 @@ fn bands_to_viz_levels(bands: &[f32; NUM_BANDS]) -> [u8; audio_viz::NUM_BANDS] {
     levels
 }
 
+/// Scale the analyzed bands to the patch visualiser's 0-255 levels.
+fn bands_to_overlay_levels(bands: &[f32; NUM_BANDS]) -> [u8; NUM_BANDS] {
+    bands.map(|b| (b.clamp(0.0, 1.0) * 255.0).round() as u8)
+}
+
 /// Analyze audio samples into [`NUM_BANDS`] average magnitudes (linear).
 ///
 /// Bass-focused like the official "music" viz: 16 linear bands across
@@ -378,6 +387,23 @@ pub fn run_audio_reactive(
     let audio_capture = AudioCapture::start(config.clone())?;
 
     println!("Audio input: {}", audio_capture.source_label);
+
+    if config.overlay {
+        match keyboard.stream_viz_setup(&VizSetup::default()) {
+            Ok(true) => {
+                println!("Audio capture started, firmware patch draws the bars...");
+                viz_loop(keyboard, &audio_capture.state, running, true);
+                audio_capture.stop();
+                let _ = keyboard.stream_viz_setup(&VizSetup {
+                    enabled: false,
+                    ..VizSetup::default()
+                });
+                println!("Audio reactive mode stopped");
+                return Ok(());
+            }
+            _ => println!("Firmware has no patch visualiser, using the stock one"),
+        }
+    }
     println!("Audio capture started, enabling music visualizer...");
 
     // Snapshot the current LED config to restore the previous mode + settings on
@@ -413,6 +439,17 @@ pub fn run_viz_loop(
     keyboard: &KeyboardInterface,
     audio_state: &Arc<AudioState>,
     running: Arc<AtomicBool>,
+) {
+    viz_loop(keyboard, audio_state, running, false);
+}
+
+/// Frame loop behind [`run_viz_loop`]; with `overlay`, levels go to the
+/// patch visualiser (0xE8 page 0xFA) instead of `SET_AUDIO_VIZ`.
+fn viz_loop(
+    keyboard: &KeyboardInterface,
+    audio_state: &Arc<AudioState>,
+    running: Arc<AtomicBool>,
+    overlay: bool,
 ) {
     let mut frame_count = 0u32;
     let mut rate_count = 0u32;
@@ -442,10 +479,17 @@ pub fn run_viz_loop(
         }
 
         let bands = audio_state.get_bands();
-        let levels = bands_to_viz_levels(&bands);
+        let levels = if overlay {
+            bands_to_overlay_levels(&bands)
+        } else {
+            bands_to_viz_levels(&bands)
+        };
         // No-delay send either way — the default 100ms flow-control delay would
         // cap streaming at ~10Hz; the frame loop does the pacing.
-        if packed {
+        if overlay {
+            // Patch visualiser: one small page, same on USB and the dongle.
+            let _ = keyboard.stream_viz_levels(&levels);
+        } else if packed {
             // Dongle/BT: nibble-packed payload, no checksum (it would clobber a band).
             let payload = audio_viz::pack_bands_nibbles(&levels);
             let _ = keyboard.transport().send_command_with_delay(
@@ -558,6 +602,15 @@ mod tests {
         }
     }
 
+    #[test]
+    fn overlay_levels_span_full_byte() {
+        let mut bands = [0.5f32; NUM_BANDS];
+        bands[0] = 1.5;
+        bands[1] = -0.1;
+        let levels = bands_to_overlay_levels(&bands);
+        assert_eq!((levels[0], levels[1], levels[2]), (255, 0, 128));
+    }
+
     #[test]
     fn silence_is_zero() {
         let s = vec![0.0f32; FFT_SIZE * 2];
@@ -651,6 +651,16 @@ pub enum Commands {
 
     /// Query animation engine status (running defs, frame count)
     AnimStatus,
+
+    /// Save the running animation scene to keyboard flash
+    AnimSave {
+        /// Keep it stored but don't restore it on wake / USB connect
+        #[arg(long)]
+        no_wake: bool,
+    },
+
+    /// Replace the running animation scene with the one in keyboard flash
+    AnimLoad,
 }
 
 /// Dongle commands
@@ -743,13 +753,18 @@ pub enum AudioMode {
     Bars,
     /// MusicPatterns (mode 20). Same on-device renderer as bars; --style 0-2
     Patterns,
+    /// Patched firmware: 8-bit bars with peak markers drawn over the current
+    /// lighting; falls back to bars on stock firmware
+    Overlay,
 }
 
 impl AudioMode {
     /// LED mode byte for this visualizer (MusicBars=22 / MusicPatterns=20).
     pub fn led_mode(&self) -> u8 {
         match self {
-            AudioMode::Bars => iot_driver::protocol::cmd::LedMode::MusicBars.as_u8(),
+            AudioMode::Bars | AudioMode::Overlay => {
+                iot_driver::protocol::cmd::LedMode::MusicBars.as_u8()
+            }
             AudioMode::Patterns => iot_driver::protocol::cmd::LedMode::MusicPatterns.as_u8(),
         }
     }
@@ -21,7 +21,7 @@ use std::sync::atomic::Ordering;
 
 // Re-export shared LED utilities so binary-crate callers (grpc.rs) can keep
 // importing from `commands::led_stream::*`.
-pub use iot_driver::led_stream::{apply_power_budget, send_full_frame};
+pub use iot_driver::led_stream::{apply_power_budget, FrameSender};
 pub use iot_driver::notify::keymap::MATRIX_LEN;
 
 /// Matrix dimensions (row-major: index = row * COLS + col)
@@ -111,6 +111,13 @@ pub fn open_with_patch_check(
     .into())
 }
 
+/// Pick the cheapest frame path the link offers (see [`FrameSender`]).
+fn open_frame_sender(kb: &KeyboardInterface) -> FrameSender {
+    let frames = FrameSender::open(kb);
+    println!("Streaming frames as {}", frames.path_name());
+    frames
+}
+
 /// Test LED streaming — lights one LED at a time, cycling through colors.
 ///
 /// Sweeps all 96 positions in row-major order (row 0 left→right, row 1, …).
@@ -118,6 +125,7 @@ pub fn open_with_patch_check(
 /// "disappears" momentarily, which is the expected spatial behaviour.
 pub fn stream_test(ctx: &CmdCtx, fps: f32, power_budget: u32) -> CommandResult {
     let kb = open_with_patch_check(ctx)?;
+    let mut frames = open_frame_sender(&kb);
 
     let frame_duration = std::time::Duration::from_secs_f32(1.0 / fps);
     let running = setup_interrupt_handler();
@@ -145,7 +153,7 @@ pub fn stream_test(ctx: &CmdCtx, fps: f32, power_budget: u32) -> CommandResult {
             leds[pos] = (cr, cg, cb);
             apply_power_budget(&mut leds, power_budget);
 
-            send_full_frame(&kb, &leds)?;
+            frames.send(&kb, &leds)?;
 
             let row = pos / COLS;
             let col = pos % COLS;
@@ -160,7 +168,7 @@ pub fn stream_test(ctx: &CmdCtx, fps: f32, power_budget: u32) -> CommandResult {
     }
 
     println!("\nReleasing LED stream...");
-    kb.stream_led_release().ok();
+    frames.release(&kb);
     println!("Done.");
     Ok(())
 }
@@ -246,6 +254,7 @@ pub fn stream_gif(
         }
     );
 
+    let mut frames = open_frame_sender(&kb);
     let running = setup_interrupt_handler();
     let budget_str = if power_budget > 0 {
         format!("budget={power_budget}mA")
@@ -262,7 +271,7 @@ pub fn stream_gif(
 
             let mut leds = frame.leds;
             let (est_ma, scaled) = apply_power_budget(&mut leds, power_budget);
-            send_full_frame(&kb, &leds)?;
+            frames.send(&kb, &leds)?;
 
             if scaled {
                 let pct = (power_budget as f32 / est_ma * 100.0) as u32;
@@ -293,7 +302,7 @@ pub fn stream_gif(
     }
 
     println!("\nReleasing LED stream...");
-    kb.stream_led_release().ok();
+    frames.release(&kb);
     println!("Done.");
     Ok(())
 }
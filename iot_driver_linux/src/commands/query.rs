@@ -145,6 +145,25 @@ pub fn info(ctx: &CmdCtx) -> CommandResult {
                         cap_names.join(", ")
                     );
                 }
+                let stats = monsgeek_keyboard::parse_dongle_sched_stats(&buf);
+                if !stats.is_empty() {
+                    println!("           EP2 queues (depth/peak, drops, late, worst wait):");
+                }
+                for (i, c) in stats.iter().enumerate() {
+                    let name = monsgeek_keyboard::DongleSchedClass::NAMES
+                        .get(i)
+                        .copied()
+                        .unwrap_or("?");
+                    println!(
+                        "             {:<9}{}/{}, {} dropped, {} late, {} µs",
+                        name,
+                        c.depth,
+                        c.peak,
+                        c.drops,
+                        c.late,
+                        c.worst_wait as u32 * 125
+                    );
+                }
             } else {
                 println!("Dongle:    Stock firmware (no patch support).");
             }
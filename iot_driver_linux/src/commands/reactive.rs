@@ -6,6 +6,7 @@ use super::{setup_interrupt_handler, CmdCtx, CommandResult};
 pub fn audio(
     ctx: &CmdCtx,
     led_mode: u8,
+    overlay: bool,
     style: u8,
     sensitivity: f32,
     rate: u32,
@@ -27,6 +28,7 @@ pub fn audio(
         sensitivity,
         update_hz: rate,
         device,
+        overlay,
     };
 
     if let Err(e) = iot_driver::audio_reactive::run_audio_reactive(&keyboard, config, running) {
@@ -607,6 +607,7 @@ pub mod fw_easing {
 pub mod fw_flags {
     pub const ONE_SHOT: u8 = 0x01;
     pub const RAINBOW: u8 = 0x04;
+    pub const TRIGGER: u8 = 0x08;
 }
 
 /// Pack RGB888 to RGB565.
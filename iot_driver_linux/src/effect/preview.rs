@@ -14,7 +14,7 @@ use crossterm::{
 };
 
 use super::{resolve, EffectDef, ResolvedEffect};
-use crate::led_stream::{apply_power_budget, send_full_frame, DEFAULT_POWER_BUDGET_MA};
+use crate::led_stream::{apply_power_budget, FrameSender, DEFAULT_POWER_BUDGET_MA};
 use crate::notify::keymap::{pos_to_matrix_index, COLS, MATRIX_LEN, ROWS};
 use crate::profile::M1_V5_HE_KEY_NAMES;
 
@@ -196,6 +196,7 @@ pub fn play_on_hardware(
 
     let start = Instant::now();
     let frame_dur = Duration::from_millis(33); // ~30 FPS
+    let mut frames = FrameSender::open(kb);
 
     while running.load(Ordering::SeqCst) {
         let elapsed_ms = start.elapsed().as_secs_f64() * 1000.0;
@@ -209,7 +210,7 @@ pub fn play_on_hardware(
         }
 
         apply_power_budget(&mut leds, DEFAULT_POWER_BUDGET_MA as u32);
-        send_full_frame(kb, &leds)?;
+        frames.send(kb, &leds)?;
 
         print!(
             "\rRGB({:3},{:3},{:3}) {:6.0}ms",
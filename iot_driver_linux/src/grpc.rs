@@ -16,7 +16,7 @@ use tokio_udev::{EventType, MonitorBuilder};
 use tonic::{Request, Response, Status};
 use tracing::{debug, error, info, warn};
 
-use crate::commands::led_stream::{apply_power_budget, send_full_frame, MATRIX_LEN};
+use crate::commands::led_stream::{apply_power_budget, FrameSender, MATRIX_LEN};
 use iot_driver::effect::{self, EffectLibrary};
 use iot_driver::hal::HidInterface;
 use monsgeek_keyboard::KeyboardInterface;
@@ -115,6 +115,33 @@ fn vendor_event_to_bytes(event: &VendorEvent) -> Vec<u8> {
             let flags = if *charging { 0x02 } else { 0 } | if *online { 0x01 } else { 0 };
             vec![REPORT_ID, 0x88, 0x00, 0x00, *level, flags]
         }
+        VendorEvent::Telemetry {
+            seq,
+            changed,
+            battery,
+            charging,
+            charge_status,
+            adc_avg,
+            power,
+        } => vec![
+            REPORT_ID,
+            0x1E,
+            *seq,
+            *changed,
+            *battery,
+            *charging as u8,
+            *charge_status,
+            (*adc_avg & 0xFF) as u8,
+            (*adc_avg >> 8) as u8,
+            *power,
+        ],
+        VendorEvent::TaggedCompletion { tag, payload } => {
+            let mut out = vec![REPORT_ID, 0x1F, *tag];
+            if let Some(p) = payload {
+                out.extend(p);
+            }
+            out
+        }
         VendorEvent::MouseReport {
             buttons,
             x,
@@ -192,13 +219,34 @@ pub struct DriverService {
     /// In-memory key-value store for webapp DB RPCs
     db: Arc<AsyncMutex<HashMap<DbKey, Vec<u8>>>>,
     /// Lazily-opened keyboard for LED streaming RPCs
-    led_kb: Arc<AsyncMutex<Option<KeyboardInterface>>>,
+    led_kb: Arc<AsyncMutex<Option<LedKb>>>,
     /// Running effect render tasks (effect_id -> JoinHandle)
     led_effects: Arc<AsyncMutex<HashMap<u64, tokio::task::JoinHandle<()>>>>,
     /// Next effect ID counter
     led_next_id: Arc<AsyncMutex<u64>>,
 }
 
+/// Keyboard opened for LED streaming RPCs, with the one frame sender that
+/// every RPC and effect task streams through (compact frames share a
+/// sequence, so they must not interleave from separate senders).
+struct LedKb {
+    kb: KeyboardInterface,
+    frames: FrameSender,
+}
+
+impl LedKb {
+    fn send(
+        &mut self,
+        leds: &[(u8, u8, u8); MATRIX_LEN],
+    ) -> Result<(), Box<dyn std::error::Error>> {
+        self.frames.send(&self.kb, leds)
+    }
+
+    fn release(&mut self) {
+        self.frames.release(&self.kb);
+    }
+}
+
 impl DriverService {
     pub fn with_printer_config(
         printer_config: Option<PrinterConfig>,
@@ -827,7 +875,9 @@ impl DriverService {
             }
         }
 
-        *guard = Some(kb);
+        let frames = FrameSender::open(&kb);
+        info!("LED frames go as {}", frames.path_name());
+        *guard = Some(LedKb { kb, frames });
         Ok(())
     }
 
@@ -1259,10 +1309,10 @@ impl DriverGrpc for DriverService {
             apply_power_budget(&mut leds, frame.power_budget);
         }
 
-        let guard = self.led_kb.lock().await;
-        let kb = guard.as_ref().unwrap();
+        let mut guard = self.led_kb.lock().await;
+        let led = guard.as_mut().unwrap();
 
-        if let Err(e) = send_full_frame(kb, &leds) {
+        if let Err(e) = led.send(&leds) {
             return Ok(Response::new(ResSend {
                 err: format!("LED send error: {e}"),
             }));
@@ -1356,9 +1406,9 @@ impl DriverGrpc for DriverService {
                 apply_power_budget(&mut leds, power_budget);
 
                 // Send frame
-                let guard = led_kb.blocking_lock();
-                if let Some(ref kb) = *guard {
-                    if send_full_frame(kb, &leds).is_err() {
+                let mut guard = led_kb.blocking_lock();
+                if let Some(ref mut led) = *guard {
+                    if led.send(&leds).is_err() {
                         break;
                     }
                 } else {
@@ -1371,9 +1421,9 @@ impl DriverGrpc for DriverService {
 
             // Release LEDs and remove from map
             {
-                let guard = led_kb.blocking_lock();
-                if let Some(ref kb) = *guard {
-                    kb.stream_led_release().ok();
+                let mut guard = led_kb.blocking_lock();
+                if let Some(ref mut led) = *guard {
+                    led.release();
                 }
             }
             {
@@ -1420,9 +1470,9 @@ impl DriverGrpc for DriverService {
         drop(effects);
 
         // Release LEDs
-        let guard = self.led_kb.lock().await;
-        if let Some(ref kb) = *guard {
-            kb.stream_led_release().ok();
+        let mut guard = self.led_kb.lock().await;
+        if let Some(ref mut led) = *guard {
+            led.release();
         }
 
         Ok(Response::new(ResSend { err: String::new() }))
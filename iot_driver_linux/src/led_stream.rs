@@ -1,9 +1,11 @@
 //! Shared LED frame-sending utilities for the 0xE8 patch protocol.
 //!
-//! Page packing, power budget scaling, and constants used by `commands::led_stream`,
-//! `notify::daemon`, `effect::preview`, and the gRPC server.
+//! Page packing, power budget scaling, the per-link [`FrameSender`], and
+//! constants used by `commands::led_stream`, `effect::preview`, and the gRPC
+//! server.
 
-use crate::notify::keymap::MATRIX_LEN;
+use crate::effect::rgb_to_565;
+use crate::notify::keymap::{MATRIX_LEN, STRIP_TO_MATRIX};
 
 const LEDS_PER_PAGE: usize = 18;
 
@@ -66,6 +68,179 @@ pub fn send_overlay_diff(
     Ok(true)
 }
 
+/// Send a full frame as strip-indexed RGB565 (3 packets instead of 6 pages).
+///
+/// Requires the `led_stream_compact` patch capability. `seq` should advance
+/// by one per frame so the firmware can drop stale pages.
+pub fn send_full_frame_compact(
+    kb: &monsgeek_keyboard::KeyboardInterface,
+    leds: &[(u8, u8, u8); MATRIX_LEN],
+    seq: u8,
+) -> Result<(), Box<dyn std::error::Error>> {
+    let colors: Vec<u16> = STRIP_TO_MATRIX
+        .iter()
+        .map(|&m| {
+            let (r, g, b) = leds[m as usize];
+            rgb_to_565(r, g, b)
+        })
+        .collect();
+    kb.stream_led_rgb565(seq, 0, &colors)?;
+    Ok(())
+}
+
+/// Frames between full resends on the RF LED channel (about 1 s at 30 fps).
+const RF_REFRESH_FRAMES: u32 = 30;
+
+/// Frame sender for the 2.4 GHz LED-frame channel (0xE8 page 0xF8).
+///
+/// Keeps the last frame sent and streams only the strip LEDs that changed;
+/// the dongle patch coalesces them and forwards newest-wins, so no packet
+/// waits for the keyboard's reply.  The channel has no ack, so a page lost
+/// over the air would leave an unchanging LED wrong indefinitely; every
+/// `RF_REFRESH_FRAMES` frames all LEDs are resent.
+pub struct RfFrameSender {
+    prev: Option<[u16; STRIP_TO_MATRIX.len()]>,
+    frames: u32,
+}
+
+impl RfFrameSender {
+    /// Returns a sender if `kb` is on a dongle whose patch has the channel
+    /// (`led_stream` bit) and the keyboard patch decodes its pages.
+    pub fn open(kb: &monsgeek_keyboard::KeyboardInterface) -> Option<Self> {
+        if !kb.is_dongle() {
+            return None;
+        }
+        let dongle = kb.get_dongle_patch_info().ok().flatten()?;
+        if !dongle.has_led_stream() || !kb.stream_led_rf_probe().unwrap_or(false) {
+            return None;
+        }
+        Some(Self {
+            prev: None,
+            frames: 0,
+        })
+    }
+
+    /// Send the LEDs of `leds` that differ from the previous frame (all of
+    /// them on the first call and on each periodic refresh).
+    pub fn send(
+        &mut self,
+        kb: &monsgeek_keyboard::KeyboardInterface,
+        leds: &[(u8, u8, u8); MATRIX_LEN],
+    ) -> Result<(), Box<dyn std::error::Error>> {
+        let mut colors = [0u16; STRIP_TO_MATRIX.len()];
+        for (strip, &m) in STRIP_TO_MATRIX.iter().enumerate() {
+            if let Some(&(r, g, b)) = leds.get(m as usize) {
+                colors[strip] = rgb_to_565(r, g, b);
+            }
+        }
+        if self.frames == 0 {
+            self.prev = None;
+        }
+        self.frames = (self.frames + 1) % RF_REFRESH_FRAMES;
+        let dirty: Vec<(u8, u16)> = colors
+            .iter()
+            .enumerate()
+            .filter(|&(i, c)| self.prev.is_none_or(|p| p[i] != *c))
+            .map(|(i, &c)| (i as u8, c))
+            .collect();
+        if !dirty.is_empty() {
+            kb.stream_led_rf(&dirty)?;
+        }
+        self.prev = Some(colors);
+        Ok(())
+    }
+}
+
+/// How a [`FrameSender`] reaches the keyboard's overlay.
+enum FramePath {
+    /// 2.4 GHz: changed LEDs through the dongle's frame channel.
+    Rf(RfFrameSender),
+    /// Strip-indexed RGB565 spans (3 packets per frame), `seq` per frame.
+    Compact { seq: u8 },
+    /// Matrix-indexed RGB pages plus commit (7 packets per frame).
+    Pages,
+}
+
+/// Full-frame sender that uses the cheapest path the patch offers: the RF
+/// frame channel on a dongle that has one, else RGB565 spans when the
+/// keyboard patch has `led_stream_compact`, else 18-key RGB pages.
+///
+/// Compact frames carry a sequence number, and the firmware drops pages
+/// older than the newest it has seen, so everything streaming to one
+/// keyboard must share one sender. The sequence restarts after
+/// [`KeyboardInterface::stream_led_release`](monsgeek_keyboard::KeyboardInterface::stream_led_release).
+pub struct FrameSender {
+    path: FramePath,
+}
+
+impl FrameSender {
+    /// Pick the path for `kb`. Costs a few queries, so open once per stream.
+    pub fn open(kb: &monsgeek_keyboard::KeyboardInterface) -> Self {
+        if let Some(rf) = RfFrameSender::open(kb) {
+            return Self {
+                path: FramePath::Rf(rf),
+            };
+        }
+        let compact = kb
+            .get_patch_info()
+            .ok()
+            .flatten()
+            .is_some_and(|p| p.has_led_stream_compact());
+        let path = if compact {
+            let seq = kb
+                .stream_led_seq()
+                .ok()
+                .flatten()
+                .map_or(0, |s| s.wrapping_add(1));
+            FramePath::Compact { seq }
+        } else {
+            FramePath::Pages
+        };
+        Self { path }
+    }
+
+    /// Short name of the chosen path, for status output.
+    pub fn path_name(&self) -> &'static str {
+        match self.path {
+            FramePath::Rf(_) => "2.4 GHz frame channel",
+            FramePath::Compact { .. } => "RGB565 spans",
+            FramePath::Pages => "RGB pages",
+        }
+    }
+
+    /// Send `leds` as the next frame.
+    pub fn send(
+        &mut self,
+        kb: &monsgeek_keyboard::KeyboardInterface,
+        leds: &[(u8, u8, u8); MATRIX_LEN],
+    ) -> Result<(), Box<dyn std::error::Error>> {
+        match &mut self.path {
+            FramePath::Rf(rf) => rf.send(kb, leds),
+            FramePath::Compact { seq } => {
+                send_full_frame_compact(kb, leds, *seq)?;
+                *seq = seq.wrapping_add(1);
+                Ok(())
+            }
+            FramePath::Pages => send_full_frame(kb, leds),
+        }
+    }
+
+    /// Release the overlay to the built-in effect. The firmware forgets
+    /// the stream's sequence and the dongle its dirty map, so the next
+    /// frame starts afresh and goes out whole.
+    pub fn release(&mut self, kb: &monsgeek_keyboard::KeyboardInterface) {
+        kb.stream_led_release().ok();
+        match &mut self.path {
+            FramePath::Rf(rf) => {
+                rf.prev = None;
+                rf.frames = 0;
+            }
+            FramePath::Compact { seq } => *seq = 0,
+            FramePath::Pages => {}
+        }
+    }
+}
+
 /// Send a full frame of RGB data to the keyboard.
 ///
 /// `leds` has `MATRIX_LEN` entries (row-major: index = row*16 + col).
@@ -279,7 +279,15 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
             rate,
             device,
         }) => {
-            commands::reactive::audio(&ctx, mode.led_mode(), style, sensitivity, rate, device)?;
+            commands::reactive::audio(
+                &ctx,
+                mode.led_mode(),
+                mode == cli::AudioMode::Overlay,
+                style,
+                sensitivity,
+                rate,
+                device,
+            )?;
         }
         Some(Commands::AudioTest) => {
             commands::reactive::audio_test()?;
@@ -419,6 +427,26 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
                 Ok(())
             })?;
         }
+        Some(Commands::AnimSave { no_wake }) => {
+            commands::with_keyboard(&ctx, |kb| {
+                match kb.anim_save(!no_wake)? {
+                    Some(true) => println!("Scene saved to flash"),
+                    Some(false) => println!("Flash already holds this scene"),
+                    None => eprintln!("Firmware has no scene store"),
+                }
+                Ok(())
+            })?;
+        }
+        Some(Commands::AnimLoad) => {
+            commands::with_keyboard(&ctx, |kb| {
+                match kb.anim_load()? {
+                    Some(true) => println!("Scene loaded from flash"),
+                    Some(false) => println!("No scene stored"),
+                    None => eprintln!("Firmware has no scene store"),
+                }
+                Ok(())
+            })?;
+        }
     }
 
     Ok(())
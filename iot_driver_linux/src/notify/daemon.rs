@@ -76,27 +76,49 @@ fn startup_animation(engine: &AnimEngine) {
         (40u16, 0u16, fw_easing::LINEAR),         // t=40: black (end)
     ];
 
-    // Total duration: animation (40 ticks) + max stagger (~20 ticks for diagonal)
-    if engine
+    let spatial = engine
         .kb()
-        .anim_define(7, fw_flags::ONE_SHOT, -128, 40, &keyframes)
-        .is_err()
-    {
-        return;
-    }
+        .get_patch_info()
+        .ok()
+        .flatten()
+        .is_some_and(|p| p.has_anim_spatial());
+    if spatial {
+        // Same diagonal wave, phased on-device: a 45° linear pattern advances
+        // (row + col) / √2 cells per step, so 11 ticks per cell ≈ 8 ticks
+        // per diagonal step. Two packets instead of a DEF + 4 ASSIGNs.
+        use monsgeek_transport::command::AnimSpatial;
+        let kb = engine.kb();
+        let diagonal = AnimSpatial::Linear { angle: 32 };
+        if kb
+            .anim_define_spatial(7, fw_flags::ONE_SHOT, -128, 40, &keyframes, diagonal, 11)
+            .is_err()
+        {
+            return;
+        }
+        let _ = kb.anim_assign_all(7, 0);
+    } else {
+        // Total duration: animation (40 ticks) + max stagger (~20 ticks for diagonal)
+        if engine
+            .kb()
+            .anim_define(7, fw_flags::ONE_SHOT, -128, 40, &keyframes)
+            .is_err()
+        {
+            return;
+        }
 
-    // Assign all keys with diagonal stagger: phase = (row + col) * 1
-    // At 100Hz, phase_offset=1 → 8 ticks = 80ms per diagonal step
-    let mut keys = Vec::new();
-    for row in 0..6u8 {
-        for col in 0..16u8 {
-            let matrix_idx = row * 16 + col;
-            let phase = row + col; // diagonal distance from Esc
-            keys.push((matrix_idx, phase));
+        // Assign all keys with diagonal stagger: phase = (row + col) * 1
+        // At 100Hz, phase_offset=1 → 8 ticks = 80ms per diagonal step
+        let mut keys = Vec::new();
+        for row in 0..6u8 {
+            for col in 0..16u8 {
+                let matrix_idx = row * 16 + col;
+                let phase = row + col; // diagonal distance from Esc
+                keys.push((matrix_idx, phase));
+            }
         }
-    }
 
-    let _ = engine.kb().anim_assign(7, &keys);
+        let _ = engine.kb().anim_assign(7, &keys);
+    }
 
     // Cancel after animation completes: max_phase(20)*8 + duration(40) = 200 ticks ≈ 2s
     let kb = engine.kb_arc();
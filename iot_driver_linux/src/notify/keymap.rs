@@ -129,7 +129,7 @@ pub fn pos_to_matrix_index(row: u8, col: u8) -> usize {
 /// Firmware's `static_led_pos_tbl` — strip_idx for each matrix position.
 /// `STRIP_TO_MATRIX[strip_idx]` gives the matrix_idx (0xFF = unmapped).
 #[rustfmt::skip]
-const STRIP_TO_MATRIX: [u8; 82] = [
+pub const STRIP_TO_MATRIX: [u8; 82] = [
     0x00, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x1F, 0x1E,
     0x1D, 0x1C, 0x1B, 0x1A, 0x19, 0x18, 0x17, 0x16, 0x15, 0x14, 0x13, 0x12, 0x10, 0x20, 0x22, 0x23,
     0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x3F, 0x3E, 0x3C, 0x3B,
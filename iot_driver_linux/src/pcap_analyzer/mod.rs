@@ -346,8 +346,11 @@ impl PcapAnalyzer {
                     return;
                 }
 
-                // Vendor events (report ID 0x05) and mouse reports (report ID 0x02)
-                if first_byte == report_id::USB_VENDOR_EVENT || first_byte == report_id::MOUSE {
+                // Vendor events (report IDs 0x05, 0x0A) and mouse reports (report ID 0x02)
+                if first_byte == report_id::USB_VENDOR_EVENT
+                    || first_byte == report_id::PATCH_EVENT
+                    || first_byte == report_id::MOUSE
+                {
                     stats.vendor_events += 1;
                     let event = parse_usb_event(data);
                     self.printer.on_event(&event, Some(timestamp), Some(data));
@@ -837,6 +837,24 @@ pub mod patch_info {
     pub const CAP_SPEED_GATE_NOP: u16 = 1 << 5;
     /// Capability: On-device animation engine (0xEA)
     pub const CAP_ANIM_ENGINE: u16 = 1 << 6;
+    /// Capability: Compact LED stream pages (0xE8 0xFB RGB565 / 0xFC delta)
+    pub const CAP_LED_STREAM_COMPACT: u16 = 1 << 7;
+    /// Capability: Packed multi-key depth frames (0xEC, EP2 notif 0x1C)
+    pub const CAP_DEPTH_PACKED: u16 = 1 << 8;
+    /// Capability: Native HID gamepad axes from key ADC values (0xED, report ID 9)
+    pub const CAP_GAMEPAD: u16 = 1 << 9;
+    /// Capability: Push telemetry on change (0xEE, EP2 notif 0x1E)
+    pub const CAP_TELEMETRY: u16 = 1 << 10;
+    /// Capability: Versioned register map for diagnostics (0xE7 sub 0x01/0x02)
+    pub const CAP_REGMAP: u16 = 1 << 11;
+    /// Capability: Command bundles, several 0xE8/0xEA packets per report (0xEF)
+    pub const CAP_BUNDLE: u16 = 1 << 12;
+    /// Capability: Tagged commands with EP2 completion (0xEF sub 0xFF)
+    pub const CAP_TAGGED: u16 = 1 << 13;
+    /// Capability: Flash scene store, restored on wake (0xEA sub 0x1E/0x1F/0xFB)
+    pub const CAP_SCENE_STORE: u16 = 1 << 14;
+    /// Capability: Spatial anim defs and ASSIGN_ALL (0xEA sub 0x20)
+    pub const CAP_ANIM_SPATIAL: u16 = 1 << 15;
 
     pub fn capability_names(caps: u16) -> Vec<&'static str> {
         let mut names = Vec::new();
@@ -861,6 +879,33 @@ pub mod patch_info {
         if caps & CAP_ANIM_ENGINE != 0 {
             names.push("anim_engine");
         }
+        if caps & CAP_LED_STREAM_COMPACT != 0 {
+            names.push("led_stream_compact");
+        }
+        if caps & CAP_DEPTH_PACKED != 0 {
+            names.push("depth_packed");
+        }
+        if caps & CAP_GAMEPAD != 0 {
+            names.push("gamepad");
+        }
+        if caps & CAP_TELEMETRY != 0 {
+            names.push("telemetry");
+        }
+        if caps & CAP_REGMAP != 0 {
+            names.push("regmap");
+        }
+        if caps & CAP_BUNDLE != 0 {
+            names.push("bundle");
+        }
+        if caps & CAP_TAGGED != 0 {
+            names.push("tagged");
+        }
+        if caps & CAP_SCENE_STORE != 0 {
+            names.push("scene_store");
+        }
+        if caps & CAP_ANIM_SPATIAL != 0 {
+            names.push("anim_spatial");
+        }
         names
     }
 }
@@ -250,6 +250,7 @@ fn start(app: &mut App, led_mode: u8) {
         sensitivity: 1.0,
         update_hz: app.audio.update_hz,
         device: Some(source.name.clone()),
+        overlay: false,
     };
 
     let capture = match AudioCapture::start(config.clone()) {
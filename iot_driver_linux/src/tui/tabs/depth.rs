@@ -466,6 +466,19 @@ impl App {
                     idle: false,
                 });
             }
+            VendorEvent::Telemetry {
+                battery,
+                charging,
+                power,
+                ..
+            } => {
+                self.battery = Some(crate::hid::BatteryInfo {
+                    level: battery,
+                    charging,
+                    online: true,
+                    idle: power != 0,
+                });
+            }
             VendorEvent::UnknownKbFunc { category, action } => {
                 self.status_msg = format!("KB func: cat={} action={}", category, action);
             }
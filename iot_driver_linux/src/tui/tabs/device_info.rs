@@ -242,6 +242,17 @@ impl App {
                                         .unwrap_or(name_bytes.len());
                                     let name = String::from_utf8_lossy(&name_bytes[..name_len])
                                         .to_string();
+                                    // Battery changes are pushed (notif 0x1E) instead of polled
+                                    if caps & patch_info::CAP_TELEMETRY != 0 {
+                                        use monsgeek_transport::command::{
+                                            TELEM_BATTERY, TELEM_CHARGER, TELEM_POWER,
+                                        };
+                                        let _ = kb.subscribe_telemetry(
+                                            TELEM_BATTERY | TELEM_CHARGER | TELEM_POWER,
+                                            1,
+                                            0,
+                                        );
+                                    }
                                     Ok(PatchInfoData {
                                         name,
                                         version,
@@ -305,6 +316,14 @@ impl App {
                 // Read from kernel power_supply sysfs (synchronous, fast)
                 self.battery = read_kernel_battery(path);
             }
+            Some(BatterySource::Vendor)
+                if self
+                    .patch_info
+                    .as_ref()
+                    .is_some_and(|pi| pi.capabilities.contains(&"telemetry")) =>
+            {
+                // Subscribed at patch info load: telemetry records update self.battery
+            }
             Some(BatterySource::Vendor) => {
                 // Query battery via keyboard API (async)
                 let Some(keyboard) = self.keyboard.clone() else {
@@ -91,9 +91,13 @@
 
 /* ── Local items ──────────────────────────────────────────────────── */
 
-#define RI_LOCAL_USAGE  0
+#define RI_LOCAL_USAGE      0
+#define RI_LOCAL_USAGE_MIN  1
+#define RI_LOCAL_USAGE_MAX  2
 
-#define HID_USAGE(x)              HID_REPORT_ITEM(x, RI_LOCAL_USAGE, RI_TYPE_LOCAL, 1)
+#define HID_USAGE(x)              HID_REPORT_ITEM(x, RI_LOCAL_USAGE,     RI_TYPE_LOCAL, 1)
+#define HID_USAGE_MIN(x)          HID_REPORT_ITEM(x, RI_LOCAL_USAGE_MIN, RI_TYPE_LOCAL, 1)
+#define HID_USAGE_MAX(x)          HID_REPORT_ITEM(x, RI_LOCAL_USAGE_MAX, RI_TYPE_LOCAL, 1)
 
 /* ── Usage page constants ─────────────────────────────────────────── */
 
@@ -103,8 +107,42 @@
 
 /* ── Usage constants ──────────────────────────────────────────────── */
 
+#define HID_USAGE_DESKTOP_GAMEPAD       0x05
 #define HID_USAGE_DESKTOP_KEYBOARD      0x06
+#define HID_USAGE_DESKTOP_X             0x30
+#define HID_USAGE_DESKTOP_RZ            0x35
 #define HID_USAGE_BATTERY_STRENGTH      0x20  /* Generic Device Controls (0x06) */
 #define HID_USAGE_BATTERY_CHARGING      0x44  /* Battery System (0x85) */
 
+/* ── Battery collection (keyboard and dongle IF1) ─────────────────────
+ * 46 bytes: Battery Strength (0-100 %) and Charging (0/1), each as both a
+ * Feature and an Input report under one Report ID.  The Input usages make
+ * Linux hid-input register a power supply and run the charge-status
+ * update on every Input report; Feature alone is polled, never evented.
+ * Report data (both types): [id] [battery_level] [charging]. */
+#define HID_BATTERY_RDESC(report_id)                              \
+    HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),                       \
+    HID_USAGE(HID_USAGE_DESKTOP_KEYBOARD),                        \
+    HID_COLLECTION(HID_COLLECTION_APPLICATION),                   \
+      HID_REPORT_ID(report_id)                                    \
+      HID_USAGE_PAGE(HID_USAGE_PAGE_GENERIC_DEVICE),              \
+      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),                      \
+      HID_LOGICAL_MIN(0),                                         \
+      HID_LOGICAL_MAX_N(100, 2),                                  \
+      HID_REPORT_SIZE(8),                                         \
+      HID_REPORT_COUNT(1),                                        \
+      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),        \
+      HID_USAGE(HID_USAGE_BATTERY_STRENGTH),                      \
+      HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),          \
+      HID_USAGE_PAGE(HID_USAGE_PAGE_BATTERY_SYSTEM),              \
+      HID_USAGE(HID_USAGE_BATTERY_CHARGING),                      \
+      HID_LOGICAL_MIN(0),                                         \
+      HID_LOGICAL_MAX(1),                                         \
+      HID_REPORT_SIZE(8),                                         \
+      HID_REPORT_COUNT(1),                                        \
+      HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),        \
+      HID_USAGE(HID_USAGE_BATTERY_CHARGING),                      \
+      HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),          \
+    HID_COLLECTION_END
+
 #endif /* HID_DESC_H */
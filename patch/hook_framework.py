@@ -546,6 +546,11 @@ class BinaryPatch(NamedTuple):
     bl_symbol: str | None = None
 
 
+# Code linked to run from PATCH_SRAM.  Its load image follows .rodata in the
+# PATCH flash zone and is copied to SRAM at boot, so it occupies both.
+RAMFUNC_SECTION = ".ramfunc"
+
+
 class MemoryRegion(NamedTuple):
     """A memory region for the memory map visualization."""
     name: str       # "Bootloader", "Firmware code", etc.
@@ -897,6 +902,8 @@ class PatchProject:
                 continue
             if addr_s >= 0x20000000:
                 sram_sections[name] = size_s
+                if name == RAMFUNC_SECTION:
+                    flash_sections[name] = size_s   # load image
             elif addr_s >= engine.patch_zone_start:
                 flash_sections[name] = size_s
 
@@ -1112,13 +1119,17 @@ class PatchProject:
         elf_sections = self._elf_section_sizes()
         patch_flash_used = 0
         patch_sram_used = 0
-        for _name, (size, addr) in elf_sections.items():
+        ramfunc_size = 0
+        for name, (size, addr) in elf_sections.items():
             if size == 0:
                 continue
             if addr >= patch_flash_origin and addr < patch_flash_origin + patch_flash_len:
                 patch_flash_used += size
             elif addr >= patch_sram_origin and addr < patch_sram_origin + patch_sram_len:
                 patch_sram_used += size
+                if name == RAMFUNC_SECTION:
+                    patch_flash_used += size   # load image
+                    ramfunc_size = size
 
         # ── Build flash column ──
         flash_col: list[MemoryRegion] = []
@@ -1265,8 +1276,14 @@ class PatchProject:
 
         if patch_sram_used > 0:
             used_end = patch_sram_origin + patch_sram_used - 1
-            sram_col.append(MemoryRegion(
-                "Patch (used)", patch_sram_origin, used_end, "patch_used"))
+            data_end = used_end - ramfunc_size
+            if data_end >= patch_sram_origin:
+                sram_col.append(MemoryRegion(
+                    "Patch (used)", patch_sram_origin, data_end, "patch_used"))
+            if ramfunc_size > 0:
+                # .ramfunc is linked last in PATCH_SRAM, after .bss
+                sram_col.append(MemoryRegion(
+                    "Patch code", data_end + 1, used_end, "patch"))
             if patch_sram_used < patch_sram_len:
                 sram_col.append(MemoryRegion(
                     "Patch (free)", used_end + 1, patch_sram_end, "patch_free"))
@@ -1312,6 +1329,8 @@ class PatchProject:
               f"({patch_flash_used * 100 // patch_flash_len}%)")
         print(f"SRAM patch:  {patch_sram_used} / {patch_sram_len} bytes "
               f"({patch_sram_used * 100 // patch_sram_len if patch_sram_len else 0}%)")
+        if ramfunc_size:
+            print(f"  {RAMFUNC_SECTION}:  {ramfunc_size} bytes (also in flash patch)")
         if sp:
             print(f"Stack top:   {_fmt_addr(sp)}")
 
@@ -0,0 +1,107 @@
+/*
+ * Patch core shared by the keyboard (v407, v408) and dongle handlers.
+ *
+ * Self-contained helpers only: each target's patch_target.h includes its
+ * firmware header and sets the PATCH_FEAT_* switches first, and every
+ * definition here compiles into the one handlers.c translation unit, so
+ * -Os drops whatever a target does not call.
+ *
+ * Target-specific addresses stay in the target: the including file
+ * provides WDESCLEN_FS/HS/OS/STANDALONE (the SRAM copies of IF1's
+ * wDescriptorLength, from fw_symbols.ld) before it uses PATCH_WDESCLEN.
+ */
+
+#ifndef PATCH_CORE_H
+#define PATCH_CORE_H
+
+#include <stdint.h>
+
+/* ── Target access ───────────────────────────────────────────────────────
+ * Registers, barriers and SRAM placement go through these so the host
+ * harness (2949-v408/patch/host/host_hw.h) can redirect them and compile
+ * handlers.c unchanged. */
+#ifndef PATCH_HOST
+#define MMIO32(addr)   (*(volatile uint32_t *)(addr))
+#define SYNC_DSB()     __asm__ volatile ("dsb" ::: "memory")
+#define SYNC_DSB_ISB() __asm__ volatile ("dsb\n isb" ::: "memory")
+
+/* Mask interrupts around a short main-loop critical section; nests */
+static inline uint32_t irq_save(void) {
+    uint32_t primask;
+    __asm__ volatile ("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void irq_restore(uint32_t primask) {
+    __asm__ volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#endif
+
+/* ── Linker-provided BSS boundaries (from patch.ld) ──────────────────── */
+
+extern uint8_t __patch_bss_start[];
+extern uint8_t __patch_bss_end[];
+
+/* Stock crt0 only clears the firmware's own .bss, and SRAM survives a soft
+ * reboot, so each target calls this from its first hook. */
+static void zero_patch_bss(void) {
+    for (uint8_t *p = __patch_bss_start; p < __patch_bss_end; p++)
+        *p = 0;
+}
+
+/* ── DWT cycle counter (216 MHz on both AT32F405 targets) ────────────── */
+
+#define DEMCR        MMIO32(0xE000EDFC)
+#define DEMCR_TRCENA (1u << 24)
+#define DWT_CTRL     MMIO32(0xE0001000)
+#define DWT_CYCCNT   MMIO32(0xE0001004)
+
+static inline uint32_t dwt_now(void) {
+    if (!(DWT_CTRL & 1)) {          /* first use, or a debugger reset DWT */
+        DEMCR |= DEMCR_TRCENA;
+        DWT_CTRL |= 1;
+    }
+    return DWT_CYCCNT;
+}
+
+/* ── USB HID request constants ───────────────────────────────────────── */
+
+#define USB_BMREQ_CLASS_IN         0xA1   /* bmRequestType: class, device-to-host, interface */
+#define HID_GET_REPORT             0x01   /* bRequest: GET_REPORT */
+#define WVALUE_FEATURE_REPORT(id)  ((3 << 8) | (id))  /* wValue for Feature report by ID */
+
+/* ── Little-endian field writers (response buffers are volatile) ────── */
+
+static inline void put_le16(volatile uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(volatile uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* ── IF1 descriptor extension ────────────────────────────────────────────
+ * Both firmwares serve IF1's report descriptor from a pointer the patch
+ * redirects to extended_rdesc; the length is advertised separately in
+ * every SRAM copy of the HID descriptor, and all four must agree before
+ * the host enumerates.  Idempotent. */
+#define PATCH_WDESCLEN(len) do {                  \
+        put_le16(WDESCLEN_STANDALONE, (len));     \
+        put_le16(WDESCLEN_FS, (len));             \
+        put_le16(WDESCLEN_HS, (len));             \
+        put_le16(WDESCLEN_OS, (len));             \
+    } while (0)
+
+/* Append one descriptor table at offset `at`; returns the new end */
+static inline uint32_t rdesc_append(uint8_t *dst, uint32_t at,
+                                    const uint8_t *src, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++)
+        dst[at + i] = src[i];
+    return at + len;
+}
+
+#endif /* PATCH_CORE_H */
@@ -0,0 +1,98 @@
+/*
+ * Debug log ring in PATCH_SRAM, read back over the vendor channel.
+ *
+ * Entries are [type] [len] [t:u16 LE] [payload × len] with t = CYCCNT >> 16
+ * (~303 µs at 216 MHz, wraps every ~19.9 s).  `seq` counts every byte
+ * ever written; a write retires the whole entries it overwrites, so `tail`
+ * always points at an intact header and a reader can resume from a
+ * cursor (a seq value) without ever seeing half an entry.
+ *
+ * The including file defines PATCH_FEAT_LOG (0 compiles log_entry() as a
+ * no-op and allocates nothing) and may override LOG_BUF_SIZE.
+ */
+
+#ifndef PATCH_LOG_H
+#define PATCH_LOG_H
+
+#include "patch_core.h"
+
+#define LOG_HDR_SIZE     4
+#define LOG_F_OVERFLOW   0x01   /* entries before the cursor were overwritten */
+#define LOG_F_MORE       0x02   /* more entries pending — read again */
+
+#if PATCH_FEAT_LOG
+
+#ifndef LOG_BUF_SIZE
+#define LOG_BUF_SIZE 256
+#endif
+#define LOG_BUF_MASK (LOG_BUF_SIZE - 1)
+_Static_assert((LOG_BUF_SIZE & LOG_BUF_MASK) == 0, "LOG_BUF_SIZE must be a power of two");
+
+static struct {
+    uint32_t seq;           /* total bytes ever written; write pos = seq & LOG_BUF_MASK */
+    uint32_t tail;          /* seq of the oldest entry still intact */
+    uint8_t  data[LOG_BUF_SIZE];
+} log_buf;                  /* LOG_BUF_SIZE + 8 bytes in .bss → PATCH_SRAM */
+
+static void log_entry(uint8_t type, const uint8_t *payload, uint8_t len) {
+    uint32_t total = LOG_HDR_SIZE + len;
+
+    /* Retire the whole entries this write is about to overwrite, so the
+     * tail always points at an intact header for cursor reads. */
+    while (log_buf.seq + total - log_buf.tail > LOG_BUF_SIZE)
+        log_buf.tail += LOG_HDR_SIZE + log_buf.data[(log_buf.tail + 1) & LOG_BUF_MASK];
+
+    uint32_t t = dwt_now() >> 16;
+    uint8_t hdr[LOG_HDR_SIZE] = { type, len, (uint8_t)t, (uint8_t)(t >> 8) };
+    uint32_t wr = log_buf.seq;
+
+    for (uint8_t i = 0; i < LOG_HDR_SIZE; i++)
+        log_buf.data[wr++ & LOG_BUF_MASK] = hdr[i];
+    for (uint8_t i = 0; i < len; i++)
+        log_buf.data[wr++ & LOG_BUF_MASK] = payload[i];
+
+    log_buf.seq = wr;
+}
+
+/* Copy the whole entries written since *cur into dst, up to max bytes.
+ * Advances *cur past them and returns the byte count; *flags gets
+ * LOG_F_OVERFLOW if the cursor had to restart at the tail, LOG_F_MORE if
+ * entries are left over. */
+static uint8_t log_read_since(uint32_t *cur, volatile uint8_t *dst, uint8_t max,
+                              uint8_t *flags) {
+    uint32_t c = *cur;
+    uint8_t n = 0;
+
+    *flags = 0;
+    /* Cursor behind the tail (lost entries) or ahead of seq (stale host
+     * state from before a reset): restart at the oldest entry. */
+    if ((int32_t)(c - log_buf.tail) < 0 || (int32_t)(log_buf.seq - c) < 0) {
+        c = log_buf.tail;
+        *flags |= LOG_F_OVERFLOW;
+    }
+
+    while (c != log_buf.seq) {
+        uint8_t elen = LOG_HDR_SIZE + log_buf.data[(c + 1) & LOG_BUF_MASK];
+        if (n + elen > max)
+            break;
+        for (uint8_t i = 0; i < elen; i++)
+            dst[n + i] = log_buf.data[(c + i) & LOG_BUF_MASK];
+        n += elen;
+        c += elen;
+    }
+    if (c != log_buf.seq)
+        *flags |= LOG_F_MORE;
+
+    *cur = c;
+    return n;
+}
+
+#else /* !PATCH_FEAT_LOG */
+
+static inline void log_entry(uint8_t type, const uint8_t *payload, uint8_t len) {
+    (void)type; (void)payload; (void)len;
+}
+
+#endif /* PATCH_FEAT_LOG */
+
+#endif /* PATCH_LOG_H */
@@ -0,0 +1,124 @@
+/*
+ * SEGGER RTT up-channels in PATCH_SRAM, read by a debug probe over SWD.
+ *
+ * The control block and rings go in the .rtt section, which patch.ld
+ * places first in PATCH_SRAM so the probe finds the block at the origin
+ * without scanning.  Records are written whole or dropped, so the host
+ * can parse any chunk it reads.  Up-channels only; writes never block.
+ *
+ * The including file defines, before including:
+ *   PATCH_FEAT_RTT               0 compiles the no-op stubs only
+ *   RTT_NUM_UP                   up-channels, 1 or 2
+ *   RTT_UP0_NAME, RTT_UP0_SIZE   channel 0 name and ring size
+ *   RTT_UP1_NAME, RTT_UP1_SIZE   channel 1, when RTT_NUM_UP is 2
+ * Ring sizes are powers of two: offsets are masked, not taken modulo.
+ */
+
+#ifndef PATCH_RTT_H
+#define PATCH_RTT_H
+
+#include "patch_core.h"
+
+#if PATCH_FEAT_RTT
+
+_Static_assert(RTT_NUM_UP == 1 || RTT_NUM_UP == 2, "RTT_NUM_UP must be 1 or 2");
+_Static_assert((RTT_UP0_SIZE & (RTT_UP0_SIZE - 1)) == 0, "RTT_UP0_SIZE must be a power of two");
+
+/* RTT Up-Buffer descriptor */
+typedef struct {
+    const char *name;
+    uint8_t    *buf;
+    uint32_t    size;
+    volatile uint32_t wr_off;   /* firmware advances */
+    volatile uint32_t rd_off;   /* probe advances via SWD */
+    uint32_t    flags;          /* 0 = skip if full (non-blocking) */
+} rtt_up_buf_t;
+
+/* RTT Control Block */
+typedef struct {
+    char         id[16];        /* "SEGGER RTT\0\0\0\0\0\0" */
+    int32_t      max_up;        /* RTT_NUM_UP once initialised */
+    int32_t      max_down;      /* 0 */
+    rtt_up_buf_t up[RTT_NUM_UP];
+} rtt_cb_t;
+
+static rtt_cb_t  __attribute__((section(".rtt"),used)) rtt_cb;
+static uint8_t   __attribute__((section(".rtt"),used)) rtt_up0_buf[RTT_UP0_SIZE];
+#if RTT_NUM_UP > 1
+_Static_assert((RTT_UP1_SIZE & (RTT_UP1_SIZE - 1)) == 0, "RTT_UP1_SIZE must be a power of two");
+static uint8_t   __attribute__((section(".rtt"),used)) rtt_up1_buf[RTT_UP1_SIZE];
+#endif
+
+static void rtt_init_up(rtt_up_buf_t *up, const char *name, uint8_t *buf, uint32_t size) {
+    up->name   = name;
+    up->buf    = buf;
+    up->size   = size;
+    up->wr_off = 0;
+    up->rd_off = 0;
+    up->flags  = 0;  /* SEGGER_RTT_MODE_NO_BLOCK_SKIP */
+}
+
+static void rtt_init(void) {
+    /* Already initialized?  max_up is set to RTT_NUM_UP as the last step below.
+     * After zero_patch_bss(), max_up == 0 so this runs once. */
+    if (rtt_cb.max_up == RTT_NUM_UP)
+        return;
+
+    rtt_init_up(&rtt_cb.up[0], RTT_UP0_NAME, rtt_up0_buf, RTT_UP0_SIZE);
+#if RTT_NUM_UP > 1
+    rtt_init_up(&rtt_cb.up[1], RTT_UP1_NAME, rtt_up1_buf, RTT_UP1_SIZE);
+#endif
+    rtt_cb.max_down = 0;
+
+    /* Write magic + max_up LAST — prevents the probe finding a
+     * half-initialized CB and serves as the guard for rtt_write(). */
+    SYNC_DSB();
+    const char magic[] = "SEGGER RTT\0\0\0\0\0";
+    for (int i = 0; i < 16; i++)
+        ((volatile char *)rtt_cb.id)[i] = magic[i];
+    rtt_cb.max_up = RTT_NUM_UP;
+}
+
+/* Write a whole record to an up channel, or drop it if it doesn't fit.
+ * Returns 1 if written. */
+static int rtt_write(uint8_t ch, const uint8_t *src, uint32_t len) {
+    /* Guard: until rtt_init() runs, wr_off/rd_off may be garbage from
+     * before a soft reboot, and using them would corrupt random SRAM.
+     * max_up is set only by rtt_init(). */
+    if (rtt_cb.max_up != RTT_NUM_UP)
+        return 0;
+
+    rtt_up_buf_t *up = &rtt_cb.up[ch];
+    uint32_t mask = up->size - 1;
+    uint32_t wr = up->wr_off & mask;
+    uint32_t rd = up->rd_off & mask;
+
+    /* One slot stays empty so wr == rd means "empty" */
+    if (((rd - wr - 1) & mask) < len)
+        return 0;
+
+    uint32_t first = up->size - wr;
+    if (first >= len) {
+        memcpy(&up->buf[wr], (void *)src, len);
+    } else {
+        memcpy(&up->buf[wr], (void *)src, first);
+        memcpy(up->buf, (void *)(src + first), len - first);
+    }
+
+    /* Atomic u32 store — ISR-safe on Cortex-M4 */
+    up->wr_off = (wr + len) & mask;
+    return 1;
+}
+
+#else /* !PATCH_FEAT_RTT */
+
+static inline void rtt_init(void) {}
+
+static inline int rtt_write(uint8_t ch, const uint8_t *src, uint32_t len) {
+    (void)ch; (void)src; (void)len;
+    return 0;
+}
+
+#endif /* PATCH_FEAT_RTT */
+
+#endif /* PATCH_RTT_H */
@@ -254,6 +254,56 @@ def hid_op_with_timeout(func, timeout_sec=3):
     return result[0], error[0]
 
 
+LOG_READ_SINCE = 0x80
+LOG_F_OVERFLOW = 0x01
+LOG_F_MORE = 0x02
+LOG_TYPES = {
+    0x01: "HID_SETUP_ENTRY",
+    0x02: "HID_SETUP_RESULT",
+    0x03: "VENDOR_CMD_ENTRY",
+    0x04: "USB_CONNECT",
+    0x05: "EP0_XFER_START",
+    0x06: "SCENE",
+}
+CPU_MHZ = 216.0
+
+
+def read_log_entries(dev, cursor=0):
+    """Read log entries newer than `cursor` via 0xE9 cursor mode.
+
+    Entries are [type][len][t:u16 LE][payload], t = CYCCNT >> 16. Returns
+    (entries, cycnt_now, overflow) with entries as (type, name, t, payload),
+    or (None, 0, False) on a transfer error.
+    """
+    entries = []
+    now = 0
+    overflow = False
+    while True:
+        buf = bytearray(65)
+        buf[0] = 0x00; buf[1] = 0xE9; buf[2] = LOG_READ_SINCE
+        struct.pack_into("<I", buf, 3, cursor)
+        dev.send_feature_report(bytes(buf))
+        time.sleep(0.03)
+        resp, err = hid_op_with_timeout(lambda: dev.get_feature_report(0, 65))
+        if err or resp[1] != 0xE9 or resp[2] != LOG_READ_SINCE:
+            return None, 0, False
+        # resp[N] = buf[N+1] with the report ID byte in front
+        cursor = struct.unpack_from("<I", resp, 3)[0]
+        flags, n = resp[7], resp[8]
+        now = struct.unpack_from("<I", resp, 9)[0]
+        overflow |= bool(flags & LOG_F_OVERFLOW)
+        data = bytes(resp[13:13 + n])
+        pos = 0
+        while pos + 4 <= len(data):
+            typ, plen = data[pos], data[pos + 1]
+            ts = data[pos + 2] | (data[pos + 3] << 8)
+            payload = bytearray(data[pos + 4:pos + 4 + plen])
+            entries.append((typ, LOG_TYPES.get(typ, f"TYPE_{typ:02X}"), ts, payload))
+            pos += 4 + plen
+        if not flags & LOG_F_MORE:
+            return entries, now, overflow
+
+
 def check_vendor_commands(interfaces):
     section("5. Vendor Commands (IF2 Feature Reports)")
 
@@ -293,63 +343,16 @@ def check_vendor_commands(interfaces):
     # Test A2: 0xE9 DEBUG_LOG (early, before other commands that might break EP0)
     print(f"\n  [A2] 0xE9 DEBUG_LOG (early read)...")
     try:
-        ring_data = bytearray()
-        log_count = 0
-        log_head = 0
-        log_buf_size = 0
-
-        for page in range(10):
-            buf = bytearray(65)
-            buf[0] = 0x00; buf[1] = 0xE9; buf[3] = page
-            buf[8] = (0xFF - (0xE9 & 0xFF)) & 0xFF
-            dev.send_feature_report(bytes(buf))
-            time.sleep(0.03)
-            resp_log, err_log = hid_op_with_timeout(lambda: dev.get_feature_report(0, 65))
-            if err_log:
-                print(f"  [{FAIL}] Page {page}: {err_log}")
-                break
-
-            if page == 0:
-                log_count = struct.unpack_from("<H", resp_log, 2)[0]
-                log_head = struct.unpack_from("<H", resp_log, 4)[0]
-                log_buf_size = resp_log[6] << 8
-                print(f"  [{OK}] count={log_count} head={log_head} buf_size={log_buf_size}")
-                if log_count == 0:
-                    print(f"  [{INFO}] Log buffer empty")
-                    break
-
-            ring_data.extend(resp_log[7:63])
-
-        # Parse log entries (same as section D)
-        ring_data = ring_data[:log_buf_size] if log_buf_size else ring_data[:512]
-        if log_count > 0 and len(ring_data) > 0:
-            start = log_head if log_count >= log_buf_size else 0
-            LOG_TYPES = {
-                0x01: ("HID_SETUP", 8), 0x02: ("RESULT", 2),
-                0x03: ("VENDOR_CMD", 2), 0x04: ("USB_CONNECT", 0),
-                0x05: ("EP0_XFER", 6),
-            }
-            pos = start
-            bytes_read = 0
-            entries = []
-            max_bytes = min(log_count, log_buf_size)
-            while bytes_read < max_bytes:
-                type_byte = ring_data[pos % log_buf_size]
-                if type_byte == 0:
-                    break
-                info = LOG_TYPES.get(type_byte)
-                if info is None:
-                    break
-                name, payload_len = info
-                payload = bytearray()
-                for j in range(payload_len):
-                    payload.append(ring_data[(pos + 1 + j) % log_buf_size])
-                entries.append((type_byte, name, payload))
-                pos = (pos + 1 + payload_len) % log_buf_size
-                bytes_read += 1 + payload_len
-
-            print(f"  Entries ({len(entries)} parsed, {bytes_read}/{max_bytes} bytes):")
-            for i, (typ, name, payload) in enumerate(entries):
+        entries, now, overflow = read_log_entries(dev)
+        if entries is None:
+            print(f"  [{FAIL}] Log read failed")
+        elif not entries:
+            print(f"  [{INFO}] Log buffer empty")
+        else:
+            if overflow:
+                print(f"  [{INFO}] Ring wrapped — oldest entries overwritten")
+            print(f"  Entries ({len(entries)} parsed):")
+            for i, (typ, name, ts, payload) in enumerate(entries):
                 if typ == 0x01:
                     bmReq = payload[0]; bReq = payload[1]
                     wVal = payload[2] | (payload[3] << 8)
@@ -371,7 +374,7 @@ def check_vendor_commands(interfaces):
                     print(f"    [{i:3d}] {name}: {payload.hex()}")
 
             type_counts = {}
-            for _, name, _ in entries:
+            for _, name, _, _ in entries:
                 type_counts[name] = type_counts.get(name, 0) + 1
             print(f"  Summary: {', '.join(f'{n}={c}' for n, c in sorted(type_counts.items()))}")
     except Exception as e:
@@ -455,108 +458,49 @@ def check_vendor_commands(interfaces):
     # Test D: 0xE9 DEBUG_LOG
     print(f"\n  [D] 0xE9 DEBUG_LOG...")
     try:
-        # Read all 10 pages (covers 560 bytes, more than 512 ring)
-        ring_data = bytearray()
-        log_count = 0
-        log_head = 0
-        log_buf_size = 0
-
-        for page in range(10):
-            buf = bytearray(65)
-            buf[0] = 0x00; buf[1] = 0xE9; buf[3] = page
-            buf[8] = (0xFF - (0xE9 & 0xFF)) & 0xFF
-            dev.send_feature_report(bytes(buf))
-            time.sleep(0.03)
-            resp, err = hid_op_with_timeout(lambda: dev.get_feature_report(0, 65))
-            if err:
-                print(f"  [{FAIL}] Page {page}: {err}")
-                break
-
-            if page == 0:
-                log_count = struct.unpack_from("<H", resp, 2)[0]
-                log_head = struct.unpack_from("<H", resp, 4)[0]
-                log_buf_size = resp[6] << 8
-                print(f"  [{OK}] count={log_count} head={log_head} buf_size={log_buf_size}")
-
-            ring_data.extend(resp[7:63])  # 56 bytes per page
-
-        # Truncate to actual buffer size
-        ring_data = ring_data[:log_buf_size] if log_buf_size else ring_data[:512]
-
-        # Parse log entries from the ring buffer
-        if log_count > 0:
-            # Determine read start: if buffer wrapped, start from head; otherwise from 0
-            if log_count >= log_buf_size:
-                start = log_head  # buffer full, oldest data is at head
-            else:
-                start = 0
-
-            LOG_TYPES = {
-                0x01: ("HID_SETUP_ENTRY", 8),
-                0x02: ("HID_SETUP_RESULT", 2),
-                0x03: ("VENDOR_CMD_ENTRY", 2),
-                0x04: ("USB_CONNECT", 0),
-                0x05: ("EP0_XFER_START", 6),
-            }
-
-            pos = start
-            bytes_read = 0
-            entries = []
-            max_bytes = min(log_count, log_buf_size)
-
-            while bytes_read < max_bytes:
-                type_byte = ring_data[pos % log_buf_size]
-                if type_byte == 0:
-                    break  # uninitialized region
-                info = LOG_TYPES.get(type_byte)
-                if info is None:
-                    print(f"    Unknown type 0x{type_byte:02X} at offset {pos}")
-                    break
-                name, payload_len = info
-                payload = bytearray()
-                for j in range(payload_len):
-                    payload.append(ring_data[(pos + 1 + j) % log_buf_size])
-                entries.append((type_byte, name, payload))
-                entry_size = 1 + payload_len
-                pos = (pos + entry_size) % log_buf_size
-                bytes_read += entry_size
-
-            print(f"\n  Log entries ({len(entries)} parsed, {bytes_read}/{max_bytes} bytes):")
-            for i, (typ, name, payload) in enumerate(entries):
+        entries, now, overflow = read_log_entries(dev)
+        if entries is None:
+            print(f"  [{FAIL}] Log read failed")
+        elif entries:
+            if overflow:
+                print(f"  [{INFO}] Ring wrapped — oldest entries overwritten")
+            print(f"\n  Log entries ({len(entries)} parsed, newest last):")
+            for i, (typ, name, ts, payload) in enumerate(entries):
+                age_ms = ((((now >> 16) - ts) & 0xFFFF) << 16) / (CPU_MHZ * 1000)
                 if typ == 0x01:  # HID_SETUP_ENTRY
                     bmReq = payload[0]
                     bReq = payload[1]
                     wVal = payload[2] | (payload[3] << 8)
                     wIdx = payload[4] | (payload[5] << 8)
                     wLen = payload[6] | (payload[7] << 8)
-                    print(f"    [{i:3d}] {name}: bmReq=0x{bmReq:02X} bReq=0x{bReq:02X} "
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}: bmReq=0x{bmReq:02X} bReq=0x{bReq:02X} "
                           f"wVal=0x{wVal:04X} wIdx=0x{wIdx:04X} wLen=0x{wLen:04X}")
                 elif typ == 0x02:  # HID_SETUP_RESULT
                     result = payload[0]
                     bat = payload[1]
                     tag = "intercept" if result else "passthrough"
                     bat_str = f" bat={bat}" if result or bat else ""
-                    print(f"    [{i:3d}] {name}: {tag}{bat_str}")
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}: {tag}{bat_str}")
                 elif typ == 0x03:  # VENDOR_CMD_ENTRY
-                    print(f"    [{i:3d}] {name}: buf[0]=0x{payload[0]:02X} cmd=0x{payload[1]:02X}")
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}: buf[0]=0x{payload[0]:02X} cmd=0x{payload[1]:02X}")
                 elif typ == 0x04:  # USB_CONNECT
-                    print(f"    [{i:3d}] {name}")
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}")
                 elif typ == 0x05:  # EP0_XFER_START
                     buf_addr = payload[0] | (payload[1] << 8)
                     xfer_len = payload[2]
                     udev_addr = payload[3] | (payload[4] << 8)
-                    print(f"    [{i:3d}] {name}: buf=0x{buf_addr:04X} len={xfer_len} "
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}: buf=0x{buf_addr:04X} len={xfer_len} "
                           f"udev=0x{udev_addr:04X}")
                 else:
-                    print(f"    [{i:3d}] {name}: {payload.hex()}")
+                    print(f"    [{i:3d}] -{age_ms:7.1f}ms {name}: {payload.hex()}")
 
             # Summary counts
             type_counts = {}
-            for typ, name, _ in entries:
+            for typ, name, _, _ in entries:
                 type_counts[name] = type_counts.get(name, 0) + 1
             print(f"\n  Summary: {', '.join(f'{n}={c}' for n, c in sorted(type_counts.items()))}")
         else:
-            print(f"  [{INFO}] Log buffer empty (count=0)")
+            print(f"  [{INFO}] Log buffer empty")
 
     except Exception as e:
         print(f"  [{FAIL}] {e}")
@@ -992,8 +992,10 @@ def generate_linker_script(db: SymbolDB) -> str | None:
     emit(f" * Aligned to {SECTOR_SIZE}-byte sector boundary (AT32F405 erase granularity). */")
     # PATCH_SRAM: scratch SRAM above all known firmware globals.
     # Firmware SRAM usage ends around 0x20009046; we start at 0x20009800 for safety.
+    # Everything from there up to the initial SP (0x2000D510) is the stock
+    # stack reservation; 5KB still leaves ~10.5KB of stack above us.
     sram_origin = 0x20009800
-    sram_length = 4096
+    sram_length = 5120
 
     emit("MEMORY {")
     emit(f"    PATCH (rx)      : ORIGIN = {patch_origin:#010x}, LENGTH = {patch_length}")
@@ -1010,6 +1012,15 @@ def generate_linker_script(db: SymbolDB) -> str | None:
     emit("        *(.bss*)")
     emit("        *(COMMON)")
     emit("    } > PATCH_SRAM")
+    emit("    /* Hot code: runs from PATCH_SRAM, load image in PATCH, copied at boot */")
+    emit("    .ramfunc : {")
+    emit("        . = ALIGN(4);")
+    emit("        __ramfunc_start = .;")
+    emit("        *(.ramfunc*)")
+    emit("        . = ALIGN(4);")
+    emit("        __ramfunc_end = .;")
+    emit("    } > PATCH_SRAM AT > PATCH")
+    emit("    __ramfunc_load = LOADADDR(.ramfunc);")
     emit("    /DISCARD/ : {")
     emit("        *(.ARM.*)")
     emit("        *(.comment)")
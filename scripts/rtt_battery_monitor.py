@@ -4,6 +4,12 @@ RTT Battery Monitor — reads 5-byte binary records from BMP serial port.
 
 Each record: [tag:u8] [value:u32 LE]
 
+Up-channel 1 ("monsmod-stream") carries 8-byte timestamped records,
+[tag:u8] [t:u24 LE] [value:u32 LE] with t = DWT CYCCNT >> 8. Stream tags
+are >= 0x80, so both channels can share one serial port. Enable them on
+the keyboard with `0xEB` sub 0x03 (see docs/PROTOCOL.md) and on the BMP
+with `monitor rtt channel 0 1`; print them with --stream.
+
 Usage:
     # Enable RTT on BMP first:
     gdb-multiarch -q \
@@ -42,6 +48,16 @@ TAGS = {
     0x10: ("adc_counter",  "u32", lambda v: f"{v:8d}"),
 }
 
+STREAM_REC_LEN = 8
+CPU_MHZ = 216.0
+TS_SHIFT = 8  # record timestamp = CYCCNT >> 8
+
+# Stream channel tags (8-byte records) — must match RTT_SREC_* in handlers.c
+STREAM_TAGS = {
+    0x80: ("scan_period", lambda v: f"{v:8d} cyc ({v / CPU_MHZ:7.1f} us)"),
+    0x81: ("adc_filtered", lambda v: f"key {v >> 16:3d} = {v & 0xFFFF:5d}"),
+}
+
 # Ordered column names for CSV output
 CSV_COLUMNS = ["adc_avg", "batt_raw", "batt_level", "charger", "debounce_ctr", "adc_counter"]
 TAG_BY_NAME = {name: tag for tag, (name, _, _) in TAGS.items()}
@@ -79,6 +95,8 @@ def main():
                         help="Log time-series data to CSV file")
     parser.add_argument("--quiet", "-q", action="store_true",
                         help="Suppress terminal output (only write CSV)")
+    parser.add_argument("--stream", action="store_true",
+                        help="Print channel-1 stream records (scan timing, ADC samples)")
     args = parser.parse_args()
 
     try:
@@ -113,9 +131,22 @@ def main():
 
             buf.extend(data)
 
-            # Process complete 5-byte records
+            # Process complete records (5 bytes, or 8 for stream tags)
             while len(buf) >= 5:
                 tag = buf[0]
+
+                if tag in STREAM_TAGS:
+                    if len(buf) < STREAM_REC_LEN:
+                        break
+                    ts = buf[1] | buf[2] << 8 | buf[3] << 16
+                    val = struct.unpack_from('<I', buf, 4)[0]
+                    buf = buf[STREAM_REC_LEN:]
+                    if args.stream and not args.quiet:
+                        name, fmt = STREAM_TAGS[tag]
+                        t_us = (ts << TS_SHIFT) / CPU_MHZ
+                        print(f"  [{t_us:12.1f} us] {name:14s} {fmt(val)}")
+                    continue
+
                 val = struct.unpack_from('<I', buf, 1)[0]
 
                 # Validate tag — if unknown, try to resync by skipping a byte